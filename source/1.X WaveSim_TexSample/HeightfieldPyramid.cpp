@@ -0,0 +1,351 @@
+#include "pch.h"
+#include "HeightfieldPyramid.h"
+#include "Ray.h"
+
+using namespace std;
+using namespace DirectX;
+using namespace Library;
+
+namespace Rendering
+{
+	namespace
+	{
+		struct TraversalEntry
+		{
+			int level;
+			int row;
+			int column;
+			float tEnter;
+		};
+
+		//Narrows [tMin, tMax] to one axis' slab. A ray parallel to the slab has an infinite inverse direction and would compute
+		//0 * inf = NaN for an origin on the slab's edge, so it's either inside the slab for every t or misses outright
+		bool ClipSlab(float origin, float inverseDirection, float slabMin, float slabMax, float& tMin, float& tMax)
+		{
+			if (isinf(inverseDirection))
+			{
+				return origin >= slabMin && origin <= slabMax;
+			}
+
+			const float t0 = (slabMin - origin) * inverseDirection;
+			const float t1 = (slabMax - origin) * inverseDirection;
+			tMin = max(tMin, min(t0, t1));
+			tMax = min(tMax, max(t0, t1));
+
+			return true;
+		}
+
+		//Slab test against an axis-aligned box, clipped to [0, maxT]
+		bool IntersectBox(const XMFLOAT3& origin, const XMFLOAT3& inverseDirection, const XMFLOAT3& boxMin, const XMFLOAT3& boxMax, float maxT, float& tEnter)
+		{
+			float tMin = 0.f;
+			float tMax = maxT;
+			if (!ClipSlab(origin.x, inverseDirection.x, boxMin.x, boxMax.x, tMin, tMax) ||
+				!ClipSlab(origin.y, inverseDirection.y, boxMin.y, boxMax.y, tMin, tMax) ||
+				!ClipSlab(origin.z, inverseDirection.z, boxMin.z, boxMax.z, tMin, tMax))
+			{
+				return false;
+			}
+
+			tEnter = tMin;
+
+			return tMin <= tMax;
+		}
+
+		//Moller-Trumbore
+		bool IntersectTriangle(const XMFLOAT3& origin, const XMFLOAT3& direction, const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c, float& t, XMFLOAT3& normal)
+		{
+			const XMFLOAT3 e1{ b.x - a.x, b.y - a.y, b.z - a.z };
+			const XMFLOAT3 e2{ c.x - a.x, c.y - a.y, c.z - a.z };
+			const XMFLOAT3 p{ direction.y * e2.z - direction.z * e2.y, direction.z * e2.x - direction.x * e2.z, direction.x * e2.y - direction.y * e2.x };
+
+			float determinant = e1.x * p.x + e1.y * p.y + e1.z * p.z;
+			if (fabs(determinant) < 1e-12f)
+			{
+				return false;
+			}
+
+			float inverseDeterminant = 1.f / determinant;
+			const XMFLOAT3 s{ origin.x - a.x, origin.y - a.y, origin.z - a.z };
+			float u = (s.x * p.x + s.y * p.y + s.z * p.z) * inverseDeterminant;
+			if (u < 0.f || u > 1.f)
+			{
+				return false;
+			}
+
+			const XMFLOAT3 q{ s.y * e1.z - s.z * e1.y, s.z * e1.x - s.x * e1.z, s.x * e1.y - s.y * e1.x };
+			float v = (direction.x * q.x + direction.y * q.y + direction.z * q.z) * inverseDeterminant;
+			if (v < 0.f || u + v > 1.f)
+			{
+				return false;
+			}
+
+			t = (e2.x * q.x + e2.y * q.y + e2.z * q.z) * inverseDeterminant;
+			if (t < 0.f)
+			{
+				return false;
+			}
+
+			normal = XMFLOAT3{ e1.y * e2.z - e1.z * e2.y, e1.z * e2.x - e1.x * e2.z, e1.x * e2.y - e1.y * e2.x };
+			return true;
+		}
+	}
+
+	void HeightfieldPyramid::Initialize(int rows, int columns, float spacing)
+	{
+		_rows = rows;
+		_columns = columns;
+		_spacing = spacing;
+		_levels.clear();
+		_heights.assign(static_cast<size_t>(max(rows, 0)) * max(columns, 0), 0.f);
+
+		int levelRows = rows - 1;
+		int levelColumns = columns - 1;
+		if (levelRows <= 0 || levelColumns <= 0)
+		{
+			return;
+		}
+
+		for (;;)
+		{
+			Level level;
+			level.rows = levelRows;
+			level.columns = levelColumns;
+			size_t count = static_cast<size_t>(levelRows) * levelColumns;
+			level.minHeight.assign(count, 0.f);
+			level.maxHeight.assign(count, 0.f);
+			level.dirty.assign(count, 1);
+			_levels.push_back(move(level));
+
+			if (levelRows == 1 && levelColumns == 1)
+			{
+				break;
+			}
+
+			levelRows = (levelRows + 1) / 2;
+			levelColumns = (levelColumns + 1) / 2;
+		}
+	}
+
+	void HeightfieldPyramid::MarkParentDirty(size_t level, int row, int column)
+	{
+		if (level + 1 < _levels.size())
+		{
+			Level& parent = _levels[level + 1];
+			parent.dirty[static_cast<size_t>(row / 2) * parent.columns + (column / 2)] = 1;
+		}
+	}
+
+	void HeightfieldPyramid::Update(const vector<Node>& nodes)
+	{
+		if (_levels.empty())
+		{
+			return;
+		}
+
+		assert(nodes.size() == _heights.size());
+		for (size_t index = 0; index < nodes.size(); ++index)
+		{
+			_heights[index] = nodes[index]._displacement;
+		}
+
+		Rebuild();
+	}
+
+	void HeightfieldPyramid::Update(const vector<float>& heights)
+	{
+		if (_levels.empty())
+		{
+			return;
+		}
+
+		assert(heights.size() == _heights.size());
+		_heights = heights;
+		Rebuild();
+	}
+
+	void HeightfieldPyramid::Rebuild()
+	{
+		//Level 0: bounds of the four corner nodes of every cell
+		Level& cells = _levels.front();
+		for (int i = 0; i < cells.rows; ++i)
+		{
+			const float* top = &_heights[static_cast<size_t>(i) * _columns];
+			const float* bottom = top + _columns;
+			for (int j = 0; j < cells.columns; ++j)
+			{
+				float minHeight = min(min(top[j], top[j + 1]), min(bottom[j], bottom[j + 1]));
+				float maxHeight = max(max(top[j], top[j + 1]), max(bottom[j], bottom[j + 1]));
+
+				size_t index = static_cast<size_t>(i) * cells.columns + j;
+				if (cells.dirty[index] || minHeight != cells.minHeight[index] || maxHeight != cells.maxHeight[index])
+				{
+					cells.minHeight[index] = minHeight;
+					cells.maxHeight[index] = maxHeight;
+					cells.dirty[index] = 0;
+					MarkParentDirty(0, i, j);
+				}
+			}
+		}
+
+		//Upper levels: only merge children whose bounds moved, and stop propagating once a parent is unchanged
+		for (size_t l = 1; l < _levels.size(); ++l)
+		{
+			const Level& child = _levels[l - 1];
+			Level& level = _levels[l];
+			for (int i = 0; i < level.rows; ++i)
+			{
+				for (int j = 0; j < level.columns; ++j)
+				{
+					size_t index = static_cast<size_t>(i) * level.columns + j;
+					if (!level.dirty[index])
+					{
+						continue;
+					}
+
+					level.dirty[index] = 0;
+					float minHeight = numeric_limits<float>::max();
+					float maxHeight = numeric_limits<float>::lowest();
+					int rowEnd = min(2 * i + 2, child.rows);
+					int columnEnd = min(2 * j + 2, child.columns);
+					for (int ci = 2 * i; ci < rowEnd; ++ci)
+					{
+						for (int cj = 2 * j; cj < columnEnd; ++cj)
+						{
+							size_t childIndex = static_cast<size_t>(ci) * child.columns + cj;
+							minHeight = min(minHeight, child.minHeight[childIndex]);
+							maxHeight = max(maxHeight, child.maxHeight[childIndex]);
+						}
+					}
+
+					if (minHeight != level.minHeight[index] || maxHeight != level.maxHeight[index])
+					{
+						level.minHeight[index] = minHeight;
+						level.maxHeight[index] = maxHeight;
+						MarkParentDirty(l, i, j);
+					}
+				}
+			}
+		}
+	}
+
+	bool HeightfieldPyramid::IntersectCell(int row, int column, const XMFLOAT3& origin, const XMFLOAT3& direction, float maxT, float& t, XMFLOAT3& normal) const
+	{
+		auto corner = [this](int r, int c)
+		{
+			return XMFLOAT3{ r * _spacing, _heights[static_cast<size_t>(r) * _columns + c], c * _spacing };
+		};
+
+		//Same split as WaveSim's index buffer: (r + 1, c) - (r, c) - (r, c + 1) and (r + 1, c) - (r, c + 1) - (r + 1, c + 1)
+		const XMFLOAT3 p00 = corner(row, column);
+		const XMFLOAT3 p01 = corner(row, column + 1);
+		const XMFLOAT3 p10 = corner(row + 1, column);
+		const XMFLOAT3 p11 = corner(row + 1, column + 1);
+
+		float bestT = maxT;
+		bool found = false;
+		float triangleT;
+		XMFLOAT3 triangleNormal;
+		if (IntersectTriangle(origin, direction, p10, p00, p01, triangleT, triangleNormal) && triangleT <= bestT)
+		{
+			bestT = triangleT;
+			normal = triangleNormal;
+			found = true;
+		}
+		if (IntersectTriangle(origin, direction, p10, p01, p11, triangleT, triangleNormal) && triangleT <= bestT)
+		{
+			bestT = triangleT;
+			normal = triangleNormal;
+			found = true;
+		}
+
+		t = bestT;
+		return found;
+	}
+
+	bool HeightfieldPyramid::Raycast(const Ray& ray, HeightfieldHit& hit, float maxDistance) const
+	{
+		if (_levels.empty())
+		{
+			return false;
+		}
+
+		const XMFLOAT3& origin = ray.Position();
+		const XMFLOAT3& direction = ray.Direction();
+		const XMFLOAT3 inverseDirection{ 1.f / direction.x, 1.f / direction.y, 1.f / direction.z };
+
+		//Children are pushed far-to-near, so the first leaf hit popped is the nearest: cells are disjoint in xz and the ray crosses them in order
+		TraversalEntry stack[64];
+		int stackSize = 0;
+
+		const size_t topLevel = _levels.size() - 1;
+		auto bounds = [this](size_t level, int row, int column, XMFLOAT3& boxMin, XMFLOAT3& boxMax)
+		{
+			const Level& l = _levels[level];
+			const int extent = 1 << level;
+			size_t index = static_cast<size_t>(row) * l.columns + column;
+			boxMin = XMFLOAT3{ row * extent * _spacing, l.minHeight[index], column * extent * _spacing };
+			boxMax = XMFLOAT3{ min((row + 1) * extent, _rows - 1) * _spacing, l.maxHeight[index], min((column + 1) * extent, _columns - 1) * _spacing };
+		};
+
+		XMFLOAT3 boxMin;
+		XMFLOAT3 boxMax;
+		float tEnter;
+		bounds(topLevel, 0, 0, boxMin, boxMax);
+		if (!IntersectBox(origin, inverseDirection, boxMin, boxMax, maxDistance, tEnter))
+		{
+			return false;
+		}
+		stack[stackSize++] = TraversalEntry{ static_cast<int>(topLevel), 0, 0, tEnter };
+
+		while (stackSize > 0)
+		{
+			const TraversalEntry entry = stack[--stackSize];
+			if (entry.level == 0)
+			{
+				float t;
+				XMFLOAT3 normal;
+				if (IntersectCell(entry.row, entry.column, origin, direction, maxDistance, t, normal))
+				{
+					if (normal.y < 0.f)
+					{
+						normal = XMFLOAT3{ -normal.x, -normal.y, -normal.z };
+					}
+
+					XMStoreFloat3(&hit.normal, XMVector3Normalize(XMLoadFloat3(&normal)));
+					hit.position = XMFLOAT3{ origin.x + t * direction.x, origin.y + t * direction.y, origin.z + t * direction.z };
+					hit.distance = t;
+					return true;
+				}
+
+				continue;
+			}
+
+			const size_t childLevel = static_cast<size_t>(entry.level) - 1;
+			const Level& child = _levels[childLevel];
+			TraversalEntry children[4];
+			int childCount = 0;
+			int rowEnd = min(2 * entry.row + 2, child.rows);
+			int columnEnd = min(2 * entry.column + 2, child.columns);
+			for (int ci = 2 * entry.row; ci < rowEnd; ++ci)
+			{
+				for (int cj = 2 * entry.column; cj < columnEnd; ++cj)
+				{
+					bounds(childLevel, ci, cj, boxMin, boxMax);
+					if (IntersectBox(origin, inverseDirection, boxMin, boxMax, maxDistance, tEnter))
+					{
+						children[childCount++] = TraversalEntry{ entry.level - 1, ci, cj, tEnter };
+					}
+				}
+			}
+
+			sort(children, children + childCount, [](const TraversalEntry& a, const TraversalEntry& b) { return a.tEnter > b.tEnter; });
+			for (int c = 0; c < childCount; ++c)
+			{
+				stack[stackSize++] = children[c];
+			}
+		}
+
+		return false;
+	}
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <limits>
+#include "DirectXMath.h"
+#include "NodeArray.h"
+
+namespace Library
+{
+	class Ray;
+}
+
+namespace Rendering
+{
+	struct HeightfieldHit
+	{
+		DirectX::XMFLOAT3 position{ 0.f, 0.f, 0.f };
+		DirectX::XMFLOAT3 normal{ 0.f, 1.f, 0.f };
+		float distance{ 0.f };
+	};
+
+	//Min/max mip pyramid over the NodeArray displacement plane, in grid-local space (x = row * spacing, z = column * spacing, y = displacement).
+	//Level 0 holds one entry per grid cell; each level above merges 2x2 cells. Update() only walks up from cells whose bounds changed.
+	class HeightfieldPyramid final
+	{
+		struct Level
+		{
+			int rows{ 0 };
+			int columns{ 0 };
+			std::vector<float> minHeight;
+			std::vector<float> maxHeight;
+			std::vector<uint8_t> dirty;
+		};
+
+		std::vector<Level> _levels;
+		std::vector<float> _heights;
+		int _rows{ 0 };
+		int _columns{ 0 };
+		float _spacing{ 1.f };
+
+		void MarkParentDirty(size_t level, int row, int column);
+		void Rebuild();
+		bool IntersectCell(int row, int column, const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& direction, float maxT, float& t, DirectX::XMFLOAT3& normal) const;
+
+	public:
+		void Initialize(int rows, int columns, float spacing);
+		void Update(const std::vector<Rendering::Node>& nodes);
+		void Update(const std::vector<float>& heights);
+
+		//Ray in grid-local space. Returns the nearest hit within maxDistance (in units of the ray's direction length).
+		bool Raycast(const Library::Ray& ray, HeightfieldHit& hit, float maxDistance = std::numeric_limits<float>::max()) const;
+
+		float GetMinHeight() const { return _levels.empty() ? 0.f : _levels.back().minHeight[0]; };
+		float GetMaxHeight() const { return _levels.empty() ? 0.f : _levels.back().maxHeight[0]; };
+	};
+}
@@ -0,0 +1,131 @@
+#include "pch.h"
+#include "HeightfieldSampler.h"
+#include "NodeArray.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Rendering
+{
+	void HeightfieldSampler::Capture(NodeArray& nodeArray, HeightfieldSnapshot& snapshot)
+	{
+		const auto& nodes = nodeArray.GetArray();
+		snapshot.rows = nodeArray.GetRows();
+		snapshot.columns = nodeArray.GetColumns();
+		snapshot.spacing = nodeArray.GetNodeSpacing();
+		snapshot.heights.resize(nodes.size());
+		snapshot.velocities.resize(nodes.size());
+
+		for (size_t index = 0; index < nodes.size(); ++index)
+		{
+			snapshot.heights[index] = nodes[index]._displacement;
+			snapshot.velocities[index] = nodes[index]._velocity;
+		}
+
+		++snapshot.step;
+	}
+
+	void HeightfieldSampler::Sample(const HeightfieldSnapshot& snapshot, span<const XMFLOAT2> positions, span<HeightfieldSample> samples, const XMFLOAT2& origin)
+	{
+		const size_t count = static_cast<size_t>(positions.size());
+		assert(static_cast<size_t>(samples.size()) >= count);
+		if (count == 0 || snapshot.heights.empty())
+		{
+			return;
+		}
+
+		const XMFLOAT2* in = positions.data();
+		HeightfieldSample* out = samples.data();
+		const float* heights = snapshot.heights.data();
+		const float* velocities = snapshot.velocities.data();
+		const int columns = snapshot.columns;
+
+		const XMVECTOR inverseSpacing = XMVectorReplicate(1.f / snapshot.spacing);
+		const XMVECTOR maxRow = XMVectorReplicate(static_cast<float>(snapshot.rows - 1));
+		const XMVECTOR maxColumn = XMVectorReplicate(static_cast<float>(snapshot.columns - 1));
+		//Lower cell corner stays one node inside the far edge so the upper corner is always valid
+		const XMVECTOR maxCellRow = XMVectorReplicate(static_cast<float>(max(snapshot.rows - 2, 0)));
+		const XMVECTOR maxCellColumn = XMVectorReplicate(static_cast<float>(max(snapshot.columns - 2, 0)));
+		const XMVECTOR originX = XMVectorReplicate(origin.x);
+		const XMVECTOR originZ = XMVectorReplicate(origin.y);
+		const int rowStep = (snapshot.rows > 1 ? columns : 0);
+		const int columnStep = (snapshot.columns > 1 ? 1 : 0);
+
+		for (size_t first = 0; first < count; first += 4)
+		{
+			const size_t lanes = min<size_t>(4, count - first);
+
+			//Pad the tail block by repeating the last probe
+			XMFLOAT4A x;
+			XMFLOAT4A z;
+			float* xLanes = &x.x;
+			float* zLanes = &z.x;
+			for (size_t lane = 0; lane < 4; ++lane)
+			{
+				const XMFLOAT2& position = in[first + min(lane, lanes - 1)];
+				xLanes[lane] = position.x;
+				zLanes[lane] = position.y;
+			}
+
+			XMVECTOR row = XMVectorClamp(XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&x), originX), inverseSpacing), g_XMZero, maxRow);
+			XMVECTOR column = XMVectorClamp(XMVectorMultiply(XMVectorSubtract(XMLoadFloat4A(&z), originZ), inverseSpacing), g_XMZero, maxColumn);
+			XMVECTOR cellRow = XMVectorMin(XMVectorFloor(row), maxCellRow);
+			XMVECTOR cellColumn = XMVectorMin(XMVectorFloor(column), maxCellColumn);
+			XMVECTOR u = XMVectorSubtract(row, cellRow);
+			XMVECTOR v = XMVectorSubtract(column, cellColumn);
+
+			XMFLOAT4A cellRows;
+			XMFLOAT4A cellColumns;
+			XMStoreFloat4A(&cellRows, cellRow);
+			XMStoreFloat4A(&cellColumns, cellColumn);
+			const float* cellRowLanes = &cellRows.x;
+			const float* cellColumnLanes = &cellColumns.x;
+
+			//Gather the four cell corners per lane
+			XMFLOAT4A h00, h01, h10, h11;
+			XMFLOAT4A v00, v01, v10, v11;
+			for (size_t lane = 0; lane < 4; ++lane)
+			{
+				size_t index = static_cast<size_t>(cellRowLanes[lane]) * columns + static_cast<size_t>(cellColumnLanes[lane]);
+				(&h00.x)[lane] = heights[index];
+				(&h01.x)[lane] = heights[index + columnStep];
+				(&h10.x)[lane] = heights[index + rowStep];
+				(&h11.x)[lane] = heights[index + rowStep + columnStep];
+				(&v00.x)[lane] = velocities[index];
+				(&v01.x)[lane] = velocities[index + columnStep];
+				(&v10.x)[lane] = velocities[index + rowStep];
+				(&v11.x)[lane] = velocities[index + rowStep + columnStep];
+			}
+
+			const XMVECTOR height00 = XMLoadFloat4A(&h00);
+			const XMVECTOR height01 = XMLoadFloat4A(&h01);
+			const XMVECTOR height10 = XMLoadFloat4A(&h10);
+			const XMVECTOR height11 = XMLoadFloat4A(&h11);
+
+			const XMVECTOR nearRow = XMVectorLerpV(height00, height01, v);
+			const XMVECTOR farRow = XMVectorLerpV(height10, height11, v);
+			const XMVECTOR nearColumn = XMVectorLerpV(height00, height10, u);
+			const XMVECTOR farColumn = XMVectorLerpV(height01, height11, u);
+
+			const XMVECTOR height = XMVectorLerpV(nearRow, farRow, u);
+			const XMVECTOR gradientX = XMVectorMultiply(XMVectorSubtract(farRow, nearRow), inverseSpacing);
+			const XMVECTOR gradientZ = XMVectorMultiply(XMVectorSubtract(farColumn, nearColumn), inverseSpacing);
+			const XMVECTOR velocity = XMVectorLerpV(XMVectorLerpV(XMLoadFloat4A(&v00), XMLoadFloat4A(&v01), v), XMVectorLerpV(XMLoadFloat4A(&v10), XMLoadFloat4A(&v11), v), u);
+
+			XMFLOAT4A heightLanes, velocityLanes, gradientXLanes, gradientZLanes;
+			XMStoreFloat4A(&heightLanes, height);
+			XMStoreFloat4A(&velocityLanes, velocity);
+			XMStoreFloat4A(&gradientXLanes, gradientX);
+			XMStoreFloat4A(&gradientZLanes, gradientZ);
+
+			for (size_t lane = 0; lane < lanes; ++lane)
+			{
+				HeightfieldSample& sample = out[first + lane];
+				sample.height = (&heightLanes.x)[lane];
+				sample.velocity = (&velocityLanes.x)[lane];
+				sample.gradient = XMFLOAT2((&gradientXLanes.x)[lane], (&gradientZLanes.x)[lane]);
+			}
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <gsl\gsl>
+#include "DirectXMath.h"
+
+namespace Rendering
+{
+	class NodeArray;
+
+	//Immutable copy of the simulation state, safe to read from any thread once published
+	struct HeightfieldSnapshot
+	{
+		int rows{ 0 };
+		int columns{ 0 };
+		float spacing{ 1.f };
+		std::uint64_t step{ 0 };
+		std::vector<float> heights;
+		std::vector<float> velocities;
+	};
+
+	struct HeightfieldSample
+	{
+		float height{ 0.f };
+		float velocity{ 0.f };
+		DirectX::XMFLOAT2 gradient{ 0.f, 0.f };	//dHeight/dx, dHeight/dz
+	};
+
+	class HeightfieldSampler final
+	{
+	public:
+		HeightfieldSampler() = delete;
+
+		static void Capture(NodeArray& nodeArray, HeightfieldSnapshot& snapshot);
+
+		//Bilinear height, velocity and gradient at XZ positions (grid-local position = xz - origin), four probes per SIMD iteration.
+		//Positions outside the grid are clamped to the edge, matching NodeArray's boundary handling.
+		static void Sample(const HeightfieldSnapshot& snapshot, gsl::span<const DirectX::XMFLOAT2> positions, gsl::span<HeightfieldSample> samples, const DirectX::XMFLOAT2& origin = DirectX::XMFLOAT2(0.f, 0.f));
+	};
+}
@@ -0,0 +1,474 @@
+#include "pch.h"
+#include "ImplicitSolver.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+namespace Rendering
+{
+	//Levels smaller than this are cheaper to process on the calling thread than to hand out
+	static const int ParallelNodeThreshold = 16384;
+	static const int MinCoarseDimension = 4;
+	static const float JacobiWeight = 0.8f;
+
+#pragma region WorkerPool
+
+	class ImplicitSolver::WorkerPool final
+	{
+	public:
+		explicit WorkerPool(unsigned int threadCount)
+		{
+			for (unsigned int worker = 1; worker < threadCount; ++worker)
+			{
+				_threads.emplace_back(&WorkerPool::WorkerLoop, this, worker);
+			}
+		}
+
+		WorkerPool(const WorkerPool&) = delete;
+		WorkerPool& operator=(const WorkerPool&) = delete;
+
+		~WorkerPool()
+		{
+			{
+				lock_guard<mutex> guard(_lock);
+				_exit = true;
+			}
+
+			_wake.notify_all();
+			for (auto& t : _threads)
+			{
+				t.join();
+			}
+		}
+
+		unsigned int ThreadCount() const { return static_cast<unsigned int>(_threads.size()) + 1; };
+
+		//Splits [0, count) into one contiguous chunk per thread; chunk 0 runs on the caller
+		void Run(int count, const function<void(int, int, unsigned int)>& job)
+		{
+			{
+				lock_guard<mutex> guard(_lock);
+				_job = &job;
+				_count = count;
+				_pending = static_cast<unsigned int>(_threads.size());
+				++_generation;
+			}
+
+			_wake.notify_all();
+			RunChunk(job, count, 0);
+
+			unique_lock<mutex> guard(_lock);
+			_done.wait(guard, [this] { return _pending == 0; });
+			_job = nullptr;
+		}
+
+	private:
+		void RunChunk(const function<void(int, int, unsigned int)>& job, int count, unsigned int chunk)
+		{
+			const unsigned int chunks = ThreadCount();
+			int begin = static_cast<int>(static_cast<int64_t>(count) * chunk / chunks);
+			int end = static_cast<int>(static_cast<int64_t>(count) * (chunk + 1) / chunks);
+			if (begin < end)
+			{
+				job(begin, end, chunk);
+			}
+		}
+
+		void WorkerLoop(unsigned int worker)
+		{
+			uint64_t seenGeneration = 0;
+			for (;;)
+			{
+				const function<void(int, int, unsigned int)>* job;
+				int count;
+				{
+					unique_lock<mutex> guard(_lock);
+					_wake.wait(guard, [this, seenGeneration] { return _exit || _generation != seenGeneration; });
+					if (_exit)
+					{
+						return;
+					}
+
+					seenGeneration = _generation;
+					job = _job;
+					count = _count;
+				}
+
+				RunChunk(*job, count, worker);
+
+				{
+					lock_guard<mutex> guard(_lock);
+					--_pending;
+				}
+
+				_done.notify_one();
+			}
+		}
+
+		vector<thread> _threads;
+		mutex _lock;
+		condition_variable _wake;
+		condition_variable _done;
+		const function<void(int, int, unsigned int)>* _job{ nullptr };
+		int _count{ 0 };
+		unsigned int _pending{ 0 };
+		uint64_t _generation{ 0 };
+		bool _exit{ false };
+	};
+
+#pragma endregion
+
+	ImplicitSolver::ImplicitSolver() = default;
+	ImplicitSolver::ImplicitSolver(ImplicitSolver&&) noexcept = default;
+	ImplicitSolver& ImplicitSolver::operator=(ImplicitSolver&&) noexcept = default;
+	ImplicitSolver::~ImplicitSolver() = default;
+
+	void ImplicitSolver::Resize(int rows, int columns)
+	{
+		_levels.clear();
+
+		Level fine;
+		fine.rows = rows;
+		fine.columns = columns;
+		size_t nodeCount = static_cast<size_t>(rows) * columns;
+		fine.mass.assign(nodeCount, 1.f);
+		fine.rowWeight.assign(nodeCount, 0.f);
+		fine.columnWeight.assign(nodeCount, 0.f);
+		for (int i = 0; i < rows; ++i)
+		{
+			for (int j = 0; j < columns; ++j)
+			{
+				size_t index = static_cast<size_t>(i) * columns + j;
+				fine.rowWeight[index] = (i + 1 < rows ? 1.f : 0.f);
+				fine.columnWeight[index] = (j + 1 < columns ? 1.f : 0.f);
+			}
+		}
+
+		_levels.push_back(move(fine));
+		while (_levels.back().rows > MinCoarseDimension && _levels.back().columns > MinCoarseDimension)
+		{
+			Level coarse;
+			BuildCoarseLevel(_levels.back(), coarse);
+			_levels.push_back(move(coarse));
+		}
+
+		for (Level& level : _levels)
+		{
+			size_t count = level.mass.size();
+			level.degree.assign(count, 0.f);
+			for (int i = 0; i < level.rows; ++i)
+			{
+				for (int j = 0; j < level.columns; ++j)
+				{
+					size_t index = static_cast<size_t>(i) * level.columns + j;
+					level.degree[index] += level.rowWeight[index] + level.columnWeight[index];
+					if (i + 1 < level.rows)
+					{
+						level.degree[index + level.columns] += level.rowWeight[index];
+					}
+					if (j + 1 < level.columns)
+					{
+						level.degree[index + 1] += level.columnWeight[index];
+					}
+				}
+			}
+
+			level.x.assign(count, 0.f);
+			level.b.assign(count, 0.f);
+			level.r.assign(count, 0.f);
+		}
+
+		_residual.assign(nodeCount, 0.f);
+		_preconditioned.assign(nodeCount, 0.f);
+		_direction.assign(nodeCount, 0.f);
+		_product.assign(nodeCount, 0.f);
+	}
+
+	void ImplicitSolver::BuildCoarseLevel(const Level& fine, Level& coarse)
+	{
+		coarse.rows = (fine.rows + 1) / 2;
+		coarse.columns = (fine.columns + 1) / 2;
+		size_t count = static_cast<size_t>(coarse.rows) * coarse.columns;
+		coarse.mass.assign(count, 0.f);
+		coarse.rowWeight.assign(count, 0.f);
+		coarse.columnWeight.assign(count, 0.f);
+
+		//Galerkin product P^T A P for piecewise-constant P: masses add up, and fine edges crossing two aggregates add to the coarse edge between them
+		for (int i = 0; i < fine.rows; ++i)
+		{
+			for (int j = 0; j < fine.columns; ++j)
+			{
+				size_t index = static_cast<size_t>(i) * fine.columns + j;
+				size_t coarseIndex = static_cast<size_t>(i / 2) * coarse.columns + (j / 2);
+
+				coarse.mass[coarseIndex] += fine.mass[index];
+				if ((i & 1) == 1)
+				{
+					coarse.rowWeight[coarseIndex] += fine.rowWeight[index];
+				}
+				if ((j & 1) == 1)
+				{
+					coarse.columnWeight[coarseIndex] += fine.columnWeight[index];
+				}
+			}
+		}
+	}
+
+	void ImplicitSolver::SetThreadCount(unsigned int threadCount)
+	{
+		_threadCount = threadCount;
+		_pool.reset();
+	}
+
+	void ImplicitSolver::SetTolerance(float tolerance)
+	{
+		_tolerance = tolerance;
+	}
+
+	void ImplicitSolver::SetMaxIterations(int maxIterations)
+	{
+		_maxIterations = maxIterations;
+	}
+
+	void ImplicitSolver::ParallelFor(int rows, int columns, const function<void(int, int, unsigned int)>& job)
+	{
+		if (_pool == nullptr || static_cast<int64_t>(rows) * columns < ParallelNodeThreshold)
+		{
+			job(0, rows, 0);
+			return;
+		}
+
+		_pool->Run(rows, job);
+	}
+
+	void ImplicitSolver::Apply(const Level& level, const vector<float>& in, vector<float>& out)
+	{
+		const int rows = level.rows;
+		const int columns = level.columns;
+		const float diagonal = _diagonal;
+		const float coupling = _coupling;
+
+		ParallelFor(rows, columns, [&](int beginRow, int endRow, unsigned int)
+		{
+			for (int i = beginRow; i < endRow; ++i)
+			{
+				for (int j = 0; j < columns; ++j)
+				{
+					size_t index = static_cast<size_t>(i) * columns + j;
+					float neighbours = 0.f;
+					if (i + 1 < rows)
+					{
+						neighbours += level.rowWeight[index] * in[index + columns];
+					}
+					if (i > 0)
+					{
+						neighbours += level.rowWeight[index - columns] * in[index - columns];
+					}
+					if (j + 1 < columns)
+					{
+						neighbours += level.columnWeight[index] * in[index + 1];
+					}
+					if (j > 0)
+					{
+						neighbours += level.columnWeight[index - 1] * in[index - 1];
+					}
+
+					out[index] = (diagonal * level.mass[index] + coupling * level.degree[index]) * in[index] - coupling * neighbours;
+				}
+			}
+		});
+	}
+
+	void ImplicitSolver::Smooth(Level& level, int sweeps)
+	{
+		const int columns = level.columns;
+		const float diagonal = _diagonal;
+		const float coupling = _coupling;
+
+		for (int sweep = 0; sweep < sweeps; ++sweep)
+		{
+			Apply(level, level.x, level.r);
+			ParallelFor(level.rows, columns, [&](int beginRow, int endRow, unsigned int)
+			{
+				size_t begin = static_cast<size_t>(beginRow) * columns;
+				size_t end = static_cast<size_t>(endRow) * columns;
+				for (size_t index = begin; index < end; ++index)
+				{
+					float d = diagonal * level.mass[index] + coupling * level.degree[index];
+					level.x[index] += JacobiWeight * (level.b[index] - level.r[index]) / d;
+				}
+			});
+		}
+	}
+
+	void ImplicitSolver::VCycle(size_t levelIndex)
+	{
+		Level& level = _levels[levelIndex];
+		std::fill(level.x.begin(), level.x.end(), 0.f);
+
+		if (levelIndex + 1 == _levels.size())
+		{
+			Smooth(level, _coarseSweeps);
+			return;
+		}
+
+		Smooth(level, _smoothingSweeps);
+
+		//Restrict the residual onto the coarse aggregates
+		Apply(level, level.x, level.r);
+		Level& coarse = _levels[levelIndex + 1];
+		std::fill(coarse.b.begin(), coarse.b.end(), 0.f);
+		for (int i = 0; i < level.rows; ++i)
+		{
+			for (int j = 0; j < level.columns; ++j)
+			{
+				size_t index = static_cast<size_t>(i) * level.columns + j;
+				coarse.b[static_cast<size_t>(i / 2) * coarse.columns + (j / 2)] += level.b[index] - level.r[index];
+			}
+		}
+
+		VCycle(levelIndex + 1);
+
+		//Prolongate the correction back
+		const int columns = level.columns;
+		ParallelFor(level.rows, columns, [&](int beginRow, int endRow, unsigned int)
+		{
+			for (int i = beginRow; i < endRow; ++i)
+			{
+				const float* coarseRow = &coarse.x[static_cast<size_t>(i / 2) * coarse.columns];
+				float* fineRow = &level.x[static_cast<size_t>(i) * columns];
+				for (int j = 0; j < columns; ++j)
+				{
+					fineRow[j] += coarseRow[j / 2];
+				}
+			}
+		});
+
+		Smooth(level, _smoothingSweeps);
+	}
+
+	void ImplicitSolver::Precondition(const vector<float>& in, vector<float>& out)
+	{
+		Level& fine = _levels.front();
+		fine.b = in;
+		VCycle(0);
+		out = fine.x;
+	}
+
+	double ImplicitSolver::Dot(const vector<float>& a, const vector<float>& b)
+	{
+		const Level& fine = _levels.front();
+		const int columns = fine.columns;
+		std::fill(_partialSums.begin(), _partialSums.end(), 0.0);
+
+		ParallelFor(fine.rows, columns, [&](int beginRow, int endRow, unsigned int chunk)
+		{
+			size_t begin = static_cast<size_t>(beginRow) * columns;
+			size_t end = static_cast<size_t>(endRow) * columns;
+			double sum = 0.0;
+			for (size_t index = begin; index < end; ++index)
+			{
+				sum += static_cast<double>(a[index]) * b[index];
+			}
+			_partialSums[chunk] = sum;
+		});
+
+		double total = 0.0;
+		for (double sum : _partialSums)
+		{
+			total += sum;
+		}
+
+		return total;
+	}
+
+	int ImplicitSolver::Solve(float diagonal, float coupling, const vector<float>& rhs, vector<float>& x)
+	{
+		assert(!_levels.empty());
+		assert(rhs.size() == _levels.front().mass.size() && x.size() == rhs.size());
+
+		if (_pool == nullptr && _threadCount != 1)
+		{
+			unsigned int threadCount = (_threadCount > 0 ? _threadCount : std::max(1u, thread::hardware_concurrency()));
+			if (threadCount > 1)
+			{
+				_pool = make_unique<WorkerPool>(threadCount);
+			}
+		}
+		_partialSums.assign(_pool != nullptr ? _pool->ThreadCount() : 1, 0.0);
+
+		_diagonal = diagonal;
+		_coupling = coupling;
+
+		const Level& fine = _levels.front();
+		const int columns = fine.columns;
+		const size_t count = rhs.size();
+
+		Apply(fine, x, _product);
+		for (size_t index = 0; index < count; ++index)
+		{
+			_residual[index] = rhs[index] - _product[index];
+		}
+
+		const double rhsNorm2 = Dot(rhs, rhs);
+		const double threshold2 = static_cast<double>(_tolerance) * _tolerance * (rhsNorm2 > 0.0 ? rhsNorm2 : 1.0);
+
+		_lastIterations = 0;
+		if (Dot(_residual, _residual) <= threshold2)
+		{
+			return _lastIterations;
+		}
+
+		Precondition(_residual, _preconditioned);
+		_direction = _preconditioned;
+		double rz = Dot(_residual, _preconditioned);
+
+		while (_lastIterations < _maxIterations)
+		{
+			++_lastIterations;
+
+			Apply(fine, _direction, _product);
+			const double pAp = Dot(_direction, _product);
+			if (pAp <= 0.0)
+			{
+				break;
+			}
+
+			const float alpha = static_cast<float>(rz / pAp);
+			ParallelFor(fine.rows, columns, [&](int beginRow, int endRow, unsigned int)
+			{
+				size_t begin = static_cast<size_t>(beginRow) * columns;
+				size_t end = static_cast<size_t>(endRow) * columns;
+				for (size_t index = begin; index < end; ++index)
+				{
+					x[index] += alpha * _direction[index];
+					_residual[index] -= alpha * _product[index];
+				}
+			});
+
+			if (Dot(_residual, _residual) <= threshold2)
+			{
+				break;
+			}
+
+			Precondition(_residual, _preconditioned);
+			const double rzNext = Dot(_residual, _preconditioned);
+			const float beta = static_cast<float>(rzNext / rz);
+			rz = rzNext;
+
+			ParallelFor(fine.rows, columns, [&](int beginRow, int endRow, unsigned int)
+			{
+				size_t begin = static_cast<size_t>(beginRow) * columns;
+				size_t end = static_cast<size_t>(endRow) * columns;
+				for (size_t index = begin; index < end; ++index)
+				{
+					_direction[index] = _preconditioned[index] + beta * _direction[index];
+				}
+			});
+		}
+
+		return _lastIterations;
+	}
+}
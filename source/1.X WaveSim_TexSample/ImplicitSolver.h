@@ -0,0 +1,76 @@
+#pragma once
+#include <vector>
+#include <memory>
+#include <functional>
+
+namespace Rendering
+{
+	//Matrix-free preconditioned conjugate gradient solver for the grid operator
+	//	(A x)_i = diagonal * x_i + coupling * sum over neighbours n of (x_i - x_n)
+	//on a rows x columns node grid with reflecting (zero-flux) edges, matching NodeArray::GetNode's clamping.
+	//A is symmetric positive definite for diagonal > 0 and coupling >= 0.
+	//The preconditioner is one symmetric V-cycle of aggregation multigrid (2x2 aggregates, Galerkin coarse operators, damped Jacobi smoothing).
+	class ImplicitSolver final
+	{
+		class WorkerPool;
+
+		struct Level
+		{
+			int rows{ 0 };
+			int columns{ 0 };
+			std::vector<float> mass;			//Number of fine nodes per aggregate
+			std::vector<float> rowWeight;		//Coupling to (row + 1, column)
+			std::vector<float> columnWeight;	//Coupling to (row, column + 1)
+			std::vector<float> degree;			//Sum of incident coupling weights
+			std::vector<float> x;
+			std::vector<float> b;
+			std::vector<float> r;
+		};
+
+		std::vector<Level> _levels;
+		std::vector<float> _residual;
+		std::vector<float> _preconditioned;
+		std::vector<float> _direction;
+		std::vector<float> _product;
+		std::vector<double> _partialSums;
+		std::unique_ptr<WorkerPool> _pool;
+
+		unsigned int _threadCount{ 0 };
+		float _tolerance{ 1e-5f };
+		int _maxIterations{ 50 };
+		int _smoothingSweeps{ 2 };
+		int _coarseSweeps{ 16 };
+		int _lastIterations{ 0 };
+
+		//Per-solve operator scalars
+		float _diagonal{ 1.f };
+		float _coupling{ 0.f };
+
+		void BuildCoarseLevel(const Level& fine, Level& coarse);
+		void ParallelFor(int rows, int columns, const std::function<void(int, int, unsigned int)>& job);
+		void Apply(const Level& level, const std::vector<float>& in, std::vector<float>& out);
+		void Smooth(Level& level, int sweeps);
+		void VCycle(size_t levelIndex);
+		void Precondition(const std::vector<float>& in, std::vector<float>& out);
+		double Dot(const std::vector<float>& a, const std::vector<float>& b);
+
+	public:
+		ImplicitSolver();
+		ImplicitSolver(const ImplicitSolver&) = delete;
+		ImplicitSolver& operator=(const ImplicitSolver&) = delete;
+		ImplicitSolver(ImplicitSolver&&) noexcept;
+		ImplicitSolver& operator=(ImplicitSolver&&) noexcept;
+		~ImplicitSolver();
+
+		void Resize(int rows, int columns);
+
+		//0 uses one thread per hardware thread
+		void SetThreadCount(unsigned int threadCount);
+		void SetTolerance(float tolerance);
+		void SetMaxIterations(int maxIterations);
+
+		//x holds the initial guess on entry and the solution on return. Returns the number of CG iterations taken.
+		int Solve(float diagonal, float coupling, const std::vector<float>& rhs, std::vector<float>& x);
+		int GetLastIterations() const { return _lastIterations; };
+	};
+}
@@ -43,11 +43,15 @@ namespace Rendering
 		return GetNode(row, column)._velocity;
 	}
 
+	float NodeArray::GetLaplacian(int i, int j)
+	{
+		return GetNodeDisplacement(i + 1, j) + GetNodeDisplacement(i - 1, j) + GetNodeDisplacement(i, j + 1) + GetNodeDisplacement(i, j - 1) - 4 * GetNodeDisplacement(i, j);
+	}
+
 	float NodeArray::GetAcceleration(int i, int j)
 	{
 		const Node& node = GetNode(i, j);
-		float curvature =
-			(GetNodeDisplacement(i + 1, j) + GetNodeDisplacement(i - 1, j) + GetNodeDisplacement(i, j + 1) + GetNodeDisplacement(i, j - 1) - 4 * node._displacement) / H2;
+		float curvature = GetLaplacian(i, j) / H2;
 
 		return ((C2 * curvature) - (_dampingFactor * node._velocity) - (_k * node._displacement));
 		//return (-(C2 * curvature)/100);
@@ -78,12 +82,40 @@ namespace Rendering
 
 		size_t midNode = static_cast<size_t>((_rows / 2) * _columns + (_columns / 2));
 		_nodeArray[midNode]._velocity = _node0InitialV;
+
+		if (_method != IntegrationMethod::Explicit)
+		{
+			AllocateImplicitBuffers();
+		}
+	}
+
+	void NodeArray::AllocateImplicitBuffers()
+	{
+		_solver.Resize(_rows, _columns);
+		_velocityRHS.assign(_nodeCount, 0.f);
+		_nextVelocity.assign(_nodeCount, 0.f);
 	}
 
 	void NodeArray::Update(const Library::GameTime& gameTime)
 	{
 		float dT = gameTime.ElapsedGameTimeSeconds().count();
 		dT *= 12;
+		Step();
+	}
+
+	void NodeArray::Step()
+	{
+		if (_method == IntegrationMethod::BackwardEuler)
+		{
+			StepImplicit(1.f);
+			return;
+		}
+		if (_method == IntegrationMethod::CrankNicolson)
+		{
+			StepImplicit(0.5f);
+			return;
+		}
+
 		for (int i = 0; i < _rows; ++i)
 		{
 			for (int j = 0; j < _columns; ++j)
@@ -96,6 +128,74 @@ namespace Rendering
 		}
 	}
 
+	void NodeArray::StepImplicit(float theta)
+	{
+		//Theta-method on u' = v, v' = C2 L u - d v - k u. Eliminating u(n+1) = u + dT (theta v(n+1) + (1 - theta) v) leaves an SPD system for v(n+1):
+		//	[(1 + dT theta d + (dT theta)^2 k) I - (dT theta)^2 C2 L] v(n+1) = v + dT theta K (u + dT (1 - theta) v) + dT (1 - theta) a
+		//with K u = C2 L u - k u and a the explicit acceleration. Theta = 1 is backward Euler, theta = 0.5 is Crank-Nicolson.
+		const float dT = _deltaT;
+		const float dTTheta = dT * theta;
+		const float explicitWeight = dT * (1.f - theta);
+
+		for (int i = 0; i < _rows; ++i)
+		{
+			for (int j = 0; j < _columns; ++j)
+			{
+				const Node& node = GetNode(i, j);
+				float velocityLaplacian = GetNodeVelocity(i + 1, j) + GetNodeVelocity(i - 1, j) + GetNodeVelocity(i, j + 1) + GetNodeVelocity(i, j - 1) - 4 * node._velocity;
+				float stiffnessU = (C2 * GetLaplacian(i, j) / H2) - (_k * node._displacement);
+				float stiffnessV = (C2 * velocityLaplacian / H2) - (_k * node._velocity);
+
+				int index = GetIndex(i, j);
+				_velocityRHS[index] = node._velocity + dTTheta * (stiffnessU + explicitWeight * stiffnessV) + explicitWeight * GetAcceleration(i, j);
+				_nextVelocity[index] = node._velocity;
+			}
+		}
+
+		const float diagonal = 1.f + dTTheta * _dampingFactor + dTTheta * dTTheta * _k;
+		const float coupling = dTTheta * dTTheta * C2 / H2;
+		_solver.Solve(diagonal, coupling, _velocityRHS, _nextVelocity);
+
+		for (int index = 0; index < _nodeCount; ++index)
+		{
+			Node& node = _nodeArray[index];
+			node._displacement += dT * (theta * _nextVelocity[index] + (1.f - theta) * node._velocity);
+			node._velocity = _nextVelocity[index];
+		}
+	}
+
+	float NodeArray::GetEnergy()
+	{
+		//Kinetic + spring + strain energy per unit mass, integrated over the node cell area
+		float energy = 0.f;
+		for (int i = 0; i < _rows; ++i)
+		{
+			for (int j = 0; j < _columns; ++j)
+			{
+				const Node& node = GetNode(i, j);
+				float dX = GetNodeDisplacement(i + 1, j) - node._displacement;
+				float dY = GetNodeDisplacement(i, j + 1) - node._displacement;
+
+				energy += 0.5f * node._velocity * node._velocity;
+				energy += 0.5f * _k * node._displacement * node._displacement;
+				energy += 0.5f * C2 * (dX * dX + dY * dY) / H2;
+			}
+		}
+
+		return energy * H2;
+	}
+
+	float NodeArray::GetMaxAmplitude()
+	{
+		float maxAmplitude = 0.f;
+		for (const Node& node : _nodeArray)
+		{
+			maxAmplitude = std::max(maxAmplitude, std::abs(node._displacement));
+		}
+
+		return maxAmplitude;
+	}
+
 	void NodeArray::SetDampingFactor(float dmpFactor)
 	{
 		_dampingFactor = dmpFactor;
@@ -106,6 +206,22 @@ namespace Rendering
 		_k = springK;
 	}
 
+	void NodeArray::SetIntegrationMethod(IntegrationMethod method)
+	{
+		_method = method;
+
+		//Initialize() only sizes the solver for an implicit method, so an initialized array switching to one needs it now
+		if (_method != IntegrationMethod::Explicit && _nodeCount > 0 && _velocityRHS.size() != static_cast<size_t>(_nodeCount))
+		{
+			AllocateImplicitBuffers();
+		}
+	}
+
+	void NodeArray::SetSolverThreadCount(unsigned int threadCount)
+	{
+		_solver.SetThreadCount(threadCount);
+	}
+
 	void NodeArray::SetNode0InitialVel(float initVel)
 	{
 		_node0InitialV = initVel;
@@ -153,6 +269,7 @@ namespace Rendering
 		SetNode0InitialVel(params.initVel);
 		SetDampingFactor(params.dmpFactor);
 		SetSpringConstant(params.k);
+		SetIntegrationMethod(params.method);
 	}
 
 	SimParams::SimParams(int r, int c, float s, float k, float dT, float iV, float dmpF, float springK) :
@@ -3,9 +3,17 @@
 #include "DirectXMath.h"
 #include "VectorHelper.h"
 #include "GameClock.h"
+#include "ImplicitSolver.h"
 
 namespace Rendering
 {
+	enum class IntegrationMethod
+	{
+		Explicit,		//Semi-implicit Euler, CFL-limited
+		BackwardEuler,	//Unconditionally stable, dissipative
+		CrankNicolson	//Unconditionally stable, second order
+	};
+
 	struct SimParams
 	{
 		int rows{0};
@@ -16,6 +24,7 @@ namespace Rendering
 		float initVel{0};
 		float dmpFactor{0};
 		float k{ 0 };
+		IntegrationMethod method{ IntegrationMethod::Explicit };
 
 		SimParams() = default;
 		SimParams(int r, int c, float s, float k, float dT, float iV, float dmpF, float springK);
@@ -61,6 +70,7 @@ namespace Rendering
 		float _node0InitialV{ 1.f };
 		float _deltaT = 1.f;
 		float _k{ 0 };
+		IntegrationMethod _method{ IntegrationMethod::Explicit };
 
 		//Derived
 		float C2{ 0.f };
@@ -68,6 +78,11 @@ namespace Rendering
 		int _nodeCount{ 0 };
 		float _avgDisplacement{ 0.f };
 
+		//Implicit integration scratch
+		ImplicitSolver _solver;
+		std::vector<float> _velocityRHS;
+		std::vector<float> _nextVelocity;
+
 		void SetRowColumn(int rows, int columns);
 		void SetNodeSpacing(float spacing);
 
@@ -78,6 +93,8 @@ namespace Rendering
 		void SetNode0InitialVel(float initVel);
 		void SetDampingFactor(float dmpFactor);
 		void SetSpringConstant(float springK);
+		void SetIntegrationMethod(IntegrationMethod method);
+		void SetSolverThreadCount(unsigned int threadCount);
 		void SetBulkVariables(
 			int rows, int columns,
 			float spacing,
@@ -94,14 +111,25 @@ namespace Rendering
 		Rendering::Node& GetNode(int row, int column);
 		float GetNodeDisplacement(int row, int column);
 		float GetNodeVelocity(int row, int column);
+		float GetLaplacian(int i, int j);
 		float GetAcceleration(int i, int j);
+		void StepImplicit(float theta);
+		void AllocateImplicitBuffers();
 
 	public:
 		void Initialize();
 		void Update(const Library::GameTime& gameTime);
+		void Step();
 		int GetNodeCount() { return _nodeCount; };
 		int GetRows() { return _rows; };
 		int GetColumns() { return _columns; };
+		float GetNodeSpacing() { return _nodeSpacing; };
+		float GetTimeStep() { return _deltaT; };
+		int GetSolverIterations() { return _solver.GetLastIterations(); };
+
+		//Diagnostics
+		float GetEnergy();
+		float GetMaxAmplitude();
 
 		std::vector<Rendering::Node>& GetArray() { return _nodeArray; };
 
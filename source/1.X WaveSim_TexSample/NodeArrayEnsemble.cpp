@@ -0,0 +1,192 @@
+#include "pch.h"
+#include "NodeArrayEnsemble.h"
+#include "GameException.h"
+#include <thread>
+
+using namespace std;
+using namespace Library;
+
+namespace Rendering
+{
+	size_t NodeArrayEnsemble::AddInstance(const SimParams& params)
+	{
+		if (params.rows <= 0 || params.columns <= 0)
+		{
+			throw GameException("Ensemble instance must have at least one row and column.");
+		}
+
+		auto instance = make_unique<Instance>();
+		instance->params = params;
+		instance->nodeArray.SetBulkVariables(instance->params);
+		//Instances already run one per core, so implicit solves stay on their worker thread
+		instance->nodeArray.SetSolverThreadCount(1);
+		instance->nodeArray.Initialize();
+
+		_instances.push_back(move(instance));
+		return _instances.size() - 1;
+	}
+
+	void NodeArrayEnsemble::Clear()
+	{
+		_instances.clear();
+	}
+
+	void NodeArrayEnsemble::SetWorkerCount(unsigned int workerCount)
+	{
+		_workerCount = workerCount;
+	}
+
+	void NodeArrayEnsemble::SetBatchNodeCount(int nodeCount)
+	{
+		_batchNodeCount = nodeCount;
+	}
+
+	void NodeArrayEnsemble::SetSettleThreshold(float threshold)
+	{
+		_settleThreshold = threshold;
+	}
+
+	void NodeArrayEnsemble::Run(int steps)
+	{
+		vector<vector<size_t>> batches = BuildBatches();
+		if (batches.empty() || steps <= 0)
+		{
+			return;
+		}
+
+		size_t workerCount = (_workerCount > 0 ? _workerCount : max(1u, thread::hardware_concurrency()));
+		workerCount = min(workerCount, batches.size());
+
+		//Largest batches come first, so dealing them round-robin keeps the initial split balanced
+		auto queues = make_unique<WorkQueue[]>(workerCount);
+		for (size_t b = 0; b < batches.size(); ++b)
+		{
+			queues[b % workerCount].batches.push_back(move(batches[b]));
+		}
+
+		auto work = [this, &queues, workerCount, steps](size_t worker)
+		{
+			vector<size_t> batch;
+			while (PopBatch(queues.get(), workerCount, worker, batch))
+			{
+				for (size_t index : batch)
+				{
+					RunInstance(*_instances[index], steps);
+				}
+			}
+		};
+
+		vector<thread> threads;
+		threads.reserve(workerCount - 1);
+		for (size_t worker = 1; worker < workerCount; ++worker)
+		{
+			threads.emplace_back(work, worker);
+		}
+
+		work(0);
+
+		for (auto& t : threads)
+		{
+			t.join();
+		}
+	}
+
+	vector<vector<size_t>> NodeArrayEnsemble::BuildBatches() const
+	{
+		vector<size_t> order(_instances.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+
+		sort(order.begin(), order.end(), [this](size_t a, size_t b)
+		{
+			return _instances[a]->nodeArray.GetNodeCount() > _instances[b]->nodeArray.GetNodeCount();
+		});
+
+		vector<vector<size_t>> batches;
+		vector<size_t> pending;
+		int pendingNodes = 0;
+		for (size_t index : order)
+		{
+			int nodeCount = _instances[index]->nodeArray.GetNodeCount();
+			if (nodeCount >= _batchNodeCount)
+			{
+				batches.push_back({ index });
+				continue;
+			}
+
+			pending.push_back(index);
+			pendingNodes += nodeCount;
+			if (pendingNodes >= _batchNodeCount)
+			{
+				batches.push_back(move(pending));
+				pending.clear();
+				pendingNodes = 0;
+			}
+		}
+
+		if (!pending.empty())
+		{
+			batches.push_back(move(pending));
+		}
+
+		return batches;
+	}
+
+	bool NodeArrayEnsemble::PopBatch(WorkQueue* queues, size_t queueCount, size_t worker, vector<size_t>& batch)
+	{
+		//Own queue from the back, then steal from the front of the others
+		{
+			WorkQueue& own = queues[worker];
+			lock_guard<mutex> guard(own.lock);
+			if (!own.batches.empty())
+			{
+				batch = move(own.batches.back());
+				own.batches.pop_back();
+				return true;
+			}
+		}
+
+		for (size_t offset = 1; offset < queueCount; ++offset)
+		{
+			WorkQueue& victim = queues[(worker + offset) % queueCount];
+			lock_guard<mutex> guard(victim.lock);
+			if (!victim.batches.empty())
+			{
+				batch = move(victim.batches.front());
+				victim.batches.pop_front();
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	void NodeArrayEnsemble::RunInstance(Instance& instance, int steps)
+	{
+		NodeArray& nodeArray = instance.nodeArray;
+		EnsembleMetrics& metrics = instance.metrics;
+		const float dT = nodeArray.GetTimeStep();
+
+		for (int s = 0; s < steps; ++s)
+		{
+			nodeArray.Step();
+			++metrics.steps;
+
+			float amplitude = nodeArray.GetMaxAmplitude();
+			metrics.maxAmplitude = max(metrics.maxAmplitude, amplitude);
+
+			if (amplitude >= _settleThreshold)
+			{
+				metrics.settleTime = -1.f;
+			}
+			else if (metrics.settleTime < 0.f)
+			{
+				metrics.settleTime = static_cast<float>(metrics.steps) * dT;
+			}
+		}
+
+		metrics.energy = nodeArray.GetEnergy();
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include "NodeArray.h"
+
+namespace Rendering
+{
+	struct EnsembleMetrics
+	{
+		float energy{ 0.f };		//Total energy after the last step
+		float maxAmplitude{ 0.f };	//Peak absolute displacement seen over all steps
+		float settleTime{ -1.f };	//Simulated time after which amplitude stayed below the settle threshold, -1 if never settled
+		int steps{ 0 };
+	};
+
+	//Runs many independent NodeArray instances (e.g. parameter sweeps over c, dmpFactor and k) across all cores.
+	//Small grids are batched together so every task carries a similar amount of work, and idle workers steal batches from busy ones.
+	class NodeArrayEnsemble final
+	{
+		struct Instance
+		{
+			SimParams params;
+			NodeArray nodeArray;
+			EnsembleMetrics metrics;
+		};
+
+		struct WorkQueue
+		{
+			std::mutex lock;
+			std::deque<std::vector<size_t>> batches;
+		};
+
+		std::vector<std::unique_ptr<Instance>> _instances;
+		unsigned int _workerCount{ 0 };
+		int _batchNodeCount{ 16384 };
+		float _settleThreshold{ 0.01f };
+
+		std::vector<std::vector<size_t>> BuildBatches() const;
+		bool PopBatch(WorkQueue* queues, size_t queueCount, size_t worker, std::vector<size_t>& batch);
+		void RunInstance(Instance& instance, int steps);
+
+	public:
+		size_t AddInstance(const SimParams& params);
+		void Clear();
+
+		//0 uses one worker per hardware thread
+		void SetWorkerCount(unsigned int workerCount);
+		//Grids smaller than this are grouped until a batch holds at least this many nodes
+		void SetBatchNodeCount(int nodeCount);
+		void SetSettleThreshold(float threshold);
+
+		void Run(int steps);
+
+		size_t GetInstanceCount() const { return _instances.size(); };
+		NodeArray& GetInstance(size_t index) { return _instances.at(index)->nodeArray; };
+		const SimParams& GetParameters(size_t index) const { return _instances.at(index)->params; };
+		const EnsembleMetrics& GetMetrics(size_t index) const { return _instances.at(index)->metrics; };
+	};
+}
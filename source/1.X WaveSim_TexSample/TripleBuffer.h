@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace Rendering
+{
+	//Single-producer, single-consumer hand-off of the latest frame. The writer and reader each own one slot and swap it with the
+	//shared middle slot, so neither side ever blocks; frames the reader doesn't get to in time are overwritten.
+	template <typename T>
+	class TripleBuffer final
+	{
+		static constexpr std::uint8_t IndexMask = 0x3;
+		static constexpr std::uint8_t FreshBit = 0x4;
+
+		std::array<T, 3> _slots;
+		std::atomic<std::uint8_t> _shared{ 1 };	//Middle slot index | FreshBit when it holds a frame the reader hasn't taken
+		std::uint8_t _write{ 0 };
+		std::uint8_t _read{ 2 };
+
+	public:
+		TripleBuffer() = default;
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		//Writer side
+		T& WriteBuffer() { return _slots[_write]; };
+		void Publish()
+		{
+			const std::uint8_t previous = _shared.exchange(static_cast<std::uint8_t>(_write | FreshBit), std::memory_order_acq_rel);
+			_write = previous & IndexMask;
+		}
+
+		//Reader side: returns false (keeping the current ReadBuffer) when nothing new was published
+		bool Consume()
+		{
+			if ((_shared.load(std::memory_order_relaxed) & FreshBit) == 0)
+			{
+				return false;
+			}
+
+			const std::uint8_t previous = _shared.exchange(_read, std::memory_order_acq_rel);
+			_read = previous & IndexMask;
+			return true;
+		}
+		const T& ReadBuffer() const { return _slots[_read]; };
+	};
+}
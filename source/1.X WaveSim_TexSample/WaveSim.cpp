@@ -6,7 +6,9 @@
 #include "Utility.h"
 #include "VertexDeclarations.h"
 #include "Texture1D.h"
+#include "Ray.h"
 #include <winrt\Windows.Foundation.h>
+#include <chrono>
 
 using namespace std;
 using namespace gsl;
@@ -23,12 +25,21 @@ namespace Rendering
 
 	}
 
+	WaveSim::~WaveSim()
+	{
+		StopSimulation();
+	}
+
 	void WaveSim::Initialize()
 	{
 		direct3DDevice = GetGame()->Direct3DDevice();
 
 		_nodeArray.SetBulkVariables(_parameters);
 		_nodeArray.Initialize();
+		_heightfield.Initialize(_parameters.rows, _parameters.columns, _parameters.spacing);
+		_heightfield.Update(_nodeArray.GetArray());
+		PublishSnapshot();
+		_heightfieldStep = _snapshot->step;
 		length = _nodeArray.GetNodeCount();
 		sizeZArray = sizeof(float) * length;
 
@@ -69,6 +80,68 @@ namespace Rendering
 
 		InitializeIndexBuffer();
 		InitializeGridTex();
+
+		_simulationRunning = true;
+		_simulationThread = thread(&WaveSim::SimulationLoop, this);
+	}
+
+	void WaveSim::Shutdown()
+	{
+		StopSimulation();
+		DrawableGameComponent::Shutdown();
+	}
+
+	void WaveSim::StopSimulation()
+	{
+		_simulationRunning = false;
+		if (_simulationThread.joinable())
+		{
+			_simulationThread.join();
+		}
+	}
+
+	void WaveSim::SetSimulationRate(float stepsPerSecond)
+	{
+		assert(!_simulationRunning);
+		_stepsPerSecond = stepsPerSecond;
+	}
+
+	void WaveSim::SimulationLoop()
+	{
+		const auto stepInterval = chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<float>(1.f / _stepsPerSecond));
+		auto nextStep = chrono::steady_clock::now();
+
+		while (_simulationRunning)
+		{
+			_nodeArray.Step();
+			PublishDisplacementFrame();
+			PublishSnapshot();
+
+			//Running behind: drop the missed steps instead of bursting to catch up
+			nextStep += stepInterval;
+			const auto now = chrono::steady_clock::now();
+			if (nextStep < now)
+			{
+				nextStep = now;
+			}
+			else
+			{
+				this_thread::sleep_until(nextStep);
+			}
+		}
+	}
+
+	void WaveSim::PublishDisplacementFrame()
+	{
+		const auto& nodes = _nodeArray.GetArray();
+		vector<float>& frame = _displacementFrames.WriteBuffer();
+		frame.resize(nodes.size());
+		for (size_t i = 0; i < nodes.size(); ++i)
+		{
+			frame[i] = nodes[i]._displacement;
+		}
+
+		_displacementFrames.Publish();
 	}
 
 	void WaveSim::SetParameters(SimParams& params)
@@ -76,10 +149,15 @@ namespace Rendering
 		_parameters = params;
 	}
 
-	void WaveSim::Update(const Library::GameTime& gameTime)
+	void WaveSim::Update(const Library::GameTime&)
 	{
-		_nodeArray.Update(gameTime);
-		UpdateZValueTexture();
+		//Stepping runs on the simulation thread; just bring the raycast pyramid up to the latest published state
+		shared_ptr<const HeightfieldSnapshot> snapshot = GetSnapshot();
+		if (snapshot->step != _heightfieldStep)
+		{
+			_heightfield.Update(snapshot->heights);
+			_heightfieldStep = snapshot->step;
+		}
 		//UpdateVertexBuffer();
 	}
 
@@ -131,16 +209,9 @@ namespace Rendering
 		ThrowIfFailed(mGame->Direct3DDevice()->CreateBuffer(&indexBufferDesc, &indexSubResourceData, mIndexBuffer.put()), "ID3D11Device::CreateBuffer() failed.");
 	}
 
-	void WaveSim::UpdateZValueTexture()
+	void WaveSim::UpdateZValueTexture(const vector<float>& displacements)
 	{
-		float* zVals = zValueData.get();
-		size_t i = 0;
-		auto& nodeArray = _nodeArray.GetArray();
-		for (auto& node : nodeArray)
-		{
-			zVals[i] = node._displacement;
-			++i;
-		}
+		assert(displacements.size() == static_cast<size_t>(length));
 
 		D3D11_MAPPED_SUBRESOURCE mappedResource;
 		ZeroMemory(&mappedResource, sizeof(D3D11_MAPPED_SUBRESOURCE));
@@ -150,7 +221,7 @@ namespace Rendering
 		HRESULT hr = m_d3dContext->Map(texResource, 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedResource);
 		if (SUCCEEDED(hr))
 		{
-			memcpy(mappedResource.pData, zVals, sizeZArray);
+			memcpy(mappedResource.pData, displacements.data(), sizeZArray);
 			m_d3dContext->Unmap(texResource, 0);
 		}
 	}
@@ -199,6 +270,12 @@ namespace Rendering
 
 	void WaveSim::Draw(const Library::GameTime&)
 	{
+		//Never waits on the simulation; redraws the last uploaded frame if no new one is ready
+		if (_displacementFrames.Consume())
+		{
+			UpdateZValueTexture(_displacementFrames.ReadBuffer());
+		}
+
 		const XMMATRIX worldMatrix = XMLoadFloat4x4(&mWorldMatrix);
 		const XMMATRIX wvp = XMMatrixTranspose(worldMatrix * mCamera->ViewProjectionMatrix());
 		mMaterial->UpdateTransforms(wvp);
@@ -231,6 +308,53 @@ namespace Rendering
 		mMaterial->SetSurfaceColor(color);
 	}
 
+	bool WaveSim::Raycast(const Ray& ray, HeightfieldHit& hit, float maxDistance) const
+	{
+		//The world matrix is a pure translation, so grid space is world space shifted by mPosition
+		const XMVECTOR position = XMLoadFloat3(&mPosition);
+		const Ray localRay(ray.PositionVector() - position, ray.DirectionVector());
+		if (!_heightfield.Raycast(localRay, hit, maxDistance))
+		{
+			return false;
+		}
+
+		XMStoreFloat3(&hit.position, XMLoadFloat3(&hit.position) + position);
+		return true;
+	}
+
+	void WaveSim::PublishSnapshot()
+	{
+		if (_spareSnapshot == nullptr)
+		{
+			_spareSnapshot = make_shared<HeightfieldSnapshot>();
+		}
+
+		_spareSnapshot->step = (_snapshot != nullptr ? _snapshot->step : 0);
+		HeightfieldSampler::Capture(_nodeArray, *_spareSnapshot);
+		shared_ptr<const HeightfieldSnapshot> previous = atomic_exchange(&_snapshot, shared_ptr<const HeightfieldSnapshot>(move(_spareSnapshot)));
+
+		//Reuse the old buffers once no reader still holds them, otherwise let the readers keep it and allocate fresh next frame
+		if (previous != nullptr && previous.use_count() == 1)
+		{
+			atomic_thread_fence(memory_order_acquire);
+			_spareSnapshot = const_pointer_cast<HeightfieldSnapshot>(previous);
+		}
+	}
+
+	shared_ptr<const HeightfieldSnapshot> WaveSim::GetSnapshot() const
+	{
+		return atomic_load(&_snapshot);
+	}
+
+	void WaveSim::SampleHeights(span<const XMFLOAT2> positions, span<HeightfieldSample> samples) const
+	{
+		shared_ptr<const HeightfieldSnapshot> snapshot = GetSnapshot();
+		if (snapshot != nullptr)
+		{
+			HeightfieldSampler::Sample(*snapshot, positions, samples, XMFLOAT2(mPosition.x, mPosition.z));
+		}
+	}
+
 
 
 	void WaveSim::UpdateVertexBuffer()
@@ -4,10 +4,16 @@
 #include <d3d11.h>
 #include <DirectXMath.h>
 #include <memory>
+#include <thread>
+#include <atomic>
+#include <gsl\gsl>
 #include "DrawableGameComponent.h"
 #include "VectorHelper.h"
 #include "MatrixHelper.h"
 #include "NodeArray.h"
+#include "HeightfieldPyramid.h"
+#include "HeightfieldSampler.h"
+#include "TripleBuffer.h"
 #include "VertexDeclarations.h"
 #include "BasicMaterial.h"
 #include "WaveSimMaterial.h"
@@ -20,6 +26,16 @@ namespace Rendering
 		//Library::BasicMaterial mMaterial;
 
 		NodeArray _nodeArray;
+		HeightfieldPyramid _heightfield;
+		std::shared_ptr<const HeightfieldSnapshot> _snapshot;
+		std::shared_ptr<HeightfieldSnapshot> _spareSnapshot;
+		std::uint64_t _heightfieldStep{ 0 };
+
+		//Simulation thread; owns _nodeArray while running
+		std::thread _simulationThread;
+		std::atomic<bool> _simulationRunning{ false };
+		float _stepsPerSecond{ 60.f };
+		TripleBuffer<std::vector<float>> _displacementFrames;
 		std::shared_ptr<WaveSimMaterial> mMaterial{ nullptr };
 		Library::Texture1D* mDisplacementMap{ nullptr };
 		ID3D11Texture1D* texResource{ nullptr };
@@ -43,7 +59,11 @@ namespace Rendering
 		void InitializeIndexBuffer();
 		void InitializeGridTex();
 		void UpdateVertexBuffer();
-		void UpdateZValueTexture();
+		void UpdateZValueTexture(const std::vector<float>& displacements);
+		void PublishSnapshot();
+		void PublishDisplacementFrame();
+		void SimulationLoop();
+		void StopSimulation();
 
 	public:
 		WaveSim
@@ -52,9 +72,17 @@ namespace Rendering
 			const std::shared_ptr<Library::Camera>& camera,
 			const DirectX::XMFLOAT4& color = DefaultColor
 		);
+		WaveSim(const WaveSim&) = delete;
+		WaveSim(WaveSim&&) = delete;
+		WaveSim& operator=(const WaveSim&) = delete;
+		WaveSim& operator=(WaveSim&&) = delete;
+		virtual ~WaveSim();
 
 		virtual void Initialize() override;
+		virtual void Shutdown() override;
 		void SetParameters(SimParams& params);
+		//Target solver rate of the simulation thread; steps that can't keep up are dropped rather than caught up
+		void SetSimulationRate(float stepsPerSecond);
 		virtual void Update(const Library::GameTime& gameTime) override;
 
 		virtual void Draw(const Library::GameTime& gameTime) override;
@@ -65,6 +93,13 @@ namespace Rendering
 
 		void SetColor(const DirectX::XMFLOAT4& color);
 
+		bool Raycast(const Library::Ray& ray, HeightfieldHit& hit, float maxDistance = std::numeric_limits<float>::max()) const;
+
+		//Latest published simulation state; may be held and sampled from any thread while the sim keeps stepping
+		std::shared_ptr<const HeightfieldSnapshot> GetSnapshot() const;
+		//World-space XZ probes against the latest snapshot
+		void SampleHeights(gsl::span<const DirectX::XMFLOAT2> positions, gsl::span<HeightfieldSample> samples) const;
+
 		inline static const DirectX::XMFLOAT4 DefaultColor{ 0.961f, 0.871f, 0.702f, 1.0f };
 	};
 }
\ No newline at end of file
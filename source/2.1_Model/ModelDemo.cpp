@@ -115,27 +115,28 @@ namespace Rendering
 
 	void ModelDemo::CreateVertexBuffer(const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer) const
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 
 		vector<VertexPositionColor> vertices;
-		vertices.reserve(sourceVertices.size());
+		vertices.reserve(vertexCount);
 		if (mesh.VertexColors().size() > 0)
 		{
-			const vector<XMFLOAT4>& vertexColors = mesh.VertexColors().at(0);
+			const auto& vertexColors = mesh.VertexColors().at(0);
 			assert(vertexColors.size() == sourceVertices.size());
 
-			for (size_t i = 0; i < sourceVertices.size(); i++)
+			for (size_t i = 0; i < vertexCount; i++)
 			{
-				const XMFLOAT3& position = sourceVertices.at(i);
-				const XMFLOAT4& color = vertexColors.at(i);
+				const XMFLOAT3& position = sourceVertices[i];
+				const XMFLOAT4& color = vertexColors[i];
 				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), color);
 			}
 		}
 		else
 		{
-			for (size_t i = 0; i < sourceVertices.size(); i++)
+			for (size_t i = 0; i < vertexCount; i++)
 			{
-				const XMFLOAT3& position = sourceVertices.at(i);
+				const XMFLOAT3& position = sourceVertices[i];
 				XMFLOAT4 color = ColorHelper::RandomColor();
 				vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), color);
 			}
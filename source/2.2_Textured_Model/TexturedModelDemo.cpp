@@ -126,15 +126,16 @@ namespace Rendering
 
 	void TexturedModelDemo::CreateVertexBuffer(const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer) const
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
 
 		vector<VertexPositionTexture> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		vertices.reserve(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = sourceUVs.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& uv = sourceUVs[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y));
 		}
 
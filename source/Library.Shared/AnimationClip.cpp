@@ -4,6 +4,9 @@
 #include "Bone.h"
 #include "MatrixHelper.h"
 #include "StreamHelper.h"
+#include "ModelFile.h"
+#include "LocalPose.h"
+#include "VectorHelper.h"
 
 using namespace std;
 using namespace gsl;
@@ -20,14 +23,16 @@ namespace Library
 
 #pragma endregion
 
-	AnimationClip::AnimationClip(Model& model, InputStreamHelper& streamHelper)
+	AnimationClip::AnimationClip(Model& model, InputStreamHelper& streamHelper, const ModelFileReader* fileReader, span<const ModelFileCompressedTrack> compressedTracks)
 	{
-		Load(model, streamHelper);
+		Load(model, streamHelper, fileReader, compressedTracks);
+		BuildTrackTable();
 	}
 
 	AnimationClip::AnimationClip(AnimationClipData&& animationClipData) :
 		mData(move(animationClipData))
-	{		
+	{
+		BuildTrackTable();
 	}
 
 	const string& AnimationClip::Name() const
@@ -60,12 +65,17 @@ namespace Library
 		return mData.KeyframeCount;
 	}
 
+	uint32_t AnimationClip::TrackIndex(uint32_t boneIndex) const
+	{
+		return (boneIndex < mTrackIndices.size() ? mTrackIndices[boneIndex] : NoTrack);
+	}
+
 	uint32_t AnimationClip::GetTransform(float time, Bone& bone, XMFLOAT4X4& transform) const
 	{
-		auto foundBoneAnimation = mData.BoneAnimationsByBone.find(&bone);
-		if (foundBoneAnimation != mData.BoneAnimationsByBone.end())
+		const uint32_t trackIndex = TrackIndex(bone.Index());
+		if (trackIndex != NoTrack)
 		{
-			return foundBoneAnimation->second->GetTransform(time, transform);
+			return mData.BoneAnimations[trackIndex]->GetTransform(time, transform);
 		}
 		else
 		{
@@ -74,20 +84,23 @@ namespace Library
 		}
 	}
 
-	void AnimationClip::GetTransforms(float time, vector<XMFLOAT4X4>& boneTransforms) const
+	uint32_t AnimationClip::GetTransforms(float time, vector<XMFLOAT4X4>& boneTransforms) const
 	{
-		for (auto& boneAnimation : mData.BoneAnimations)
+		uint32_t keyframe = 0;
+		for (size_t i = 0; i < mData.BoneAnimations.size(); i++)
 		{
-			boneAnimation->GetTransform(time, boneTransforms[boneAnimation->GetBone().Index()]);
+			keyframe = max(keyframe, mData.BoneAnimations[i]->GetTransform(time, boneTransforms[mTrackBoneIndices[i]]));
 		}
+
+		return keyframe;
 	}
 
 	void AnimationClip::GetTransformAtKeyframe(uint32_t keyframe, Bone& bone, XMFLOAT4X4& transform) const
 	{
-		auto foundBoneAnimation = mData.BoneAnimationsByBone.find(&bone);
-		if (foundBoneAnimation != mData.BoneAnimationsByBone.end())
+		const uint32_t trackIndex = TrackIndex(bone.Index());
+		if (trackIndex != NoTrack)
 		{
-			foundBoneAnimation->second->GetTransformAtKeyframe(keyframe, transform);
+			mData.BoneAnimations[trackIndex]->GetTransformAtKeyframe(keyframe, transform);
 		}
 		else
 		{
@@ -97,18 +110,18 @@ namespace Library
 
 	void AnimationClip::GetTransformsAtKeyframe(uint32_t keyframe, vector<XMFLOAT4X4>& boneTransforms) const
 	{
-		for (auto& boneAnimation : mData.BoneAnimations)
+		for (size_t i = 0; i < mData.BoneAnimations.size(); i++)
 		{
-			boneAnimation->GetTransformAtKeyframe(keyframe, boneTransforms[boneAnimation->GetBone().Index()]);
+			mData.BoneAnimations[i]->GetTransformAtKeyframe(keyframe, boneTransforms[mTrackBoneIndices[i]]);
 		}
 	}
 
 	void AnimationClip::GetInteropolatedTransform(float time, Bone& bone, XMFLOAT4X4& transform) const
 	{
-		auto foundBoneAnimation = mData.BoneAnimationsByBone.find(&bone);
-		if (foundBoneAnimation != mData.BoneAnimationsByBone.end())
+		const uint32_t trackIndex = TrackIndex(bone.Index());
+		if (trackIndex != NoTrack)
 		{
-			foundBoneAnimation->second->GetInteropolatedTransform(time, transform);
+			mData.BoneAnimations[trackIndex]->GetInteropolatedTransform(time, transform);
 		}
 		else
 		{
@@ -118,27 +131,152 @@ namespace Library
 
 	void AnimationClip::GetInteropolatedTransforms(float time, vector<XMFLOAT4X4>& boneTransforms) const
 	{
-		for (auto& boneAnimation : mData.BoneAnimations)
+		for (size_t i = 0; i < mData.BoneAnimations.size(); i++)
+		{
+			mData.BoneAnimations[i]->GetInteropolatedTransform(time, boneTransforms[mTrackBoneIndices[i]]);
+		}
+	}
+
+	uint32_t AnimationClip::GetTransforms(float time, vector<XMFLOAT4X4>& boneTransforms, vector<uint32_t>& keyframeCursors) const
+	{
+		keyframeCursors.resize(mData.BoneAnimations.size());
+
+		uint32_t keyframe = 0;
+		for (size_t i = 0; i < mData.BoneAnimations.size(); i++)
+		{
+			keyframe = max(keyframe, mData.BoneAnimations[i]->GetTransform(time, boneTransforms[mTrackBoneIndices[i]], keyframeCursors[i]));
+		}
+
+		return keyframe;
+	}
+
+	void AnimationClip::GetInteropolatedTransforms(float time, vector<XMFLOAT4X4>& boneTransforms, vector<uint32_t>& keyframeCursors) const
+	{
+		keyframeCursors.resize(mData.BoneAnimations.size());
+
+		for (size_t i = 0; i < mData.BoneAnimations.size(); i++)
+		{
+			mData.BoneAnimations[i]->GetInteropolatedTransform(time, boneTransforms[mTrackBoneIndices[i]], keyframeCursors[i]);
+		}
+	}
+
+	uint32_t AnimationClip::GetTransforms(float time, LocalPose& pose, vector<uint32_t>& keyframeCursors) const
+	{
+		keyframeCursors.resize(mData.BoneAnimations.size());
+
+		uint32_t keyframe = 0;
+		for (uint32_t boneIndex = 0; boneIndex < pose.BoneCount(); ++boneIndex)
+		{
+			const uint32_t trackIndex = TrackIndex(boneIndex);
+			if (trackIndex != NoTrack)
+			{
+				keyframe = max(keyframe, mData.BoneAnimations[trackIndex]->GetComponents(time, pose.Translations[boneIndex], pose.RotationQuaternions[boneIndex], pose.Scales[boneIndex], keyframeCursors[trackIndex]));
+			}
+			else
+			{
+				pose.Translations[boneIndex] = Vector3Helper::Zero;
+				pose.RotationQuaternions[boneIndex] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+				pose.Scales[boneIndex] = Vector3Helper::One;
+			}
+		}
+
+		return keyframe;
+	}
+
+	void AnimationClip::SampleAll(float time, span<XMFLOAT4X4> boneTransforms) const
+	{
+		for (uint32_t boneIndex = 0; boneIndex < narrow_cast<uint32_t>(boneTransforms.size()); ++boneIndex)
+		{
+			const uint32_t trackIndex = TrackIndex(boneIndex);
+			if (trackIndex != NoTrack)
+			{
+				mData.BoneAnimations[trackIndex]->GetInteropolatedTransform(time, boneTransforms[boneIndex]);
+			}
+			else
+			{
+				boneTransforms[boneIndex] = MatrixHelper::Identity;
+			}
+		}
+	}
+
+	void AnimationClip::SampleAll(float time, span<XMFLOAT4X4> boneTransforms, vector<uint32_t>& keyframeCursors) const
+	{
+		keyframeCursors.resize(mData.BoneAnimations.size());
+
+		for (uint32_t boneIndex = 0; boneIndex < narrow_cast<uint32_t>(boneTransforms.size()); ++boneIndex)
+		{
+			const uint32_t trackIndex = TrackIndex(boneIndex);
+			if (trackIndex != NoTrack)
+			{
+				mData.BoneAnimations[trackIndex]->GetInteropolatedTransform(time, boneTransforms[boneIndex], keyframeCursors[trackIndex]);
+			}
+			else
+			{
+				boneTransforms[boneIndex] = MatrixHelper::Identity;
+			}
+		}
+	}
+
+	void AnimationClip::SampleAll(float time, span<XMFLOAT4X4> boneTransforms, vector<uint32_t>& keyframeCursors, const vector<bool>& boneSet) const
+	{
+		keyframeCursors.resize(mData.BoneAnimations.size());
+
+		const uint32_t boneCount = narrow_cast<uint32_t>(min(static_cast<size_t>(boneTransforms.size()), boneSet.size()));
+		for (uint32_t boneIndex = 0; boneIndex < boneCount; ++boneIndex)
 		{
-			boneAnimation->GetInteropolatedTransform(time, boneTransforms[boneAnimation->GetBone().Index()]);
+			const uint32_t trackIndex = TrackIndex(boneIndex);
+			if (boneSet[boneIndex] && trackIndex != NoTrack)
+			{
+				mData.BoneAnimations[trackIndex]->GetInteropolatedTransform(time, boneTransforms[boneIndex], keyframeCursors[trackIndex]);
+			}
 		}
 	}
 
-	void AnimationClip::Save(OutputStreamHelper& streamHelper)
+	void AnimationClip::SampleAll(float time, LocalPose& pose, vector<uint32_t>& keyframeCursors) const
+	{
+		keyframeCursors.resize(mData.BoneAnimations.size());
+
+		for (uint32_t boneIndex = 0; boneIndex < pose.BoneCount(); ++boneIndex)
+		{
+			const uint32_t trackIndex = TrackIndex(boneIndex);
+			if (trackIndex != NoTrack)
+			{
+				mData.BoneAnimations[trackIndex]->GetInterpolatedComponents(time, pose.Translations[boneIndex], pose.RotationQuaternions[boneIndex], pose.Scales[boneIndex], keyframeCursors[trackIndex]);
+			}
+			else
+			{
+				pose.Translations[boneIndex] = Vector3Helper::Zero;
+				pose.RotationQuaternions[boneIndex] = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+				pose.Scales[boneIndex] = Vector3Helper::One;
+			}
+		}
+	}
+
+	void AnimationClip::Save(OutputStreamHelper& streamHelper, ModelFileWriter* fileWriter, vector<ModelFileCompressedTrack>* compressedTracks)
 	{
 		streamHelper << mData.Name << mData.Duration << mData.TicksPerSecond;
 		
 		// Serialize bone animations
 		streamHelper << narrow_cast<uint32_t>(mData.BoneAnimations.size());
-		for (auto& boneAnimation: mData.BoneAnimations)
+		for (size_t i = 0; i < mData.BoneAnimations.size(); i++)
 		{
-			boneAnimation->Save(streamHelper);
+			if (compressedTracks != nullptr)
+			{
+				ModelFileCompressedTrack compressedTrack{ };
+				mData.BoneAnimations[i]->Save(streamHelper, fileWriter, &compressedTrack);
+				compressedTrack.BoneAnimationIndex = narrow_cast<uint32_t>(i);
+				compressedTracks->push_back(compressedTrack);
+			}
+			else
+			{
+				mData.BoneAnimations[i]->Save(streamHelper, fileWriter);
+			}
 		}
 
 		streamHelper << mData.KeyframeCount;
 	}
 
-	void AnimationClip::Load(Model& model, InputStreamHelper& streamHelper)
+	void AnimationClip::Load(Model& model, InputStreamHelper& streamHelper, const ModelFileReader* fileReader, span<const ModelFileCompressedTrack> compressedTracks)
 	{
 		streamHelper >> mData.Name >> mData.Duration >> mData.TicksPerSecond;
 
@@ -148,11 +286,30 @@ namespace Library
 		mData.BoneAnimations.reserve(boneAnimationCount);
 		for (uint32_t i = 0; i < boneAnimationCount; i++)
 		{
-			shared_ptr<BoneAnimation> boneAnimation = make_shared<BoneAnimation>(model, streamHelper);
+			const auto compressedTrack = find_if(compressedTracks.begin(), compressedTracks.end(), [i](const ModelFileCompressedTrack& entry) { return entry.BoneAnimationIndex == i; });
+			shared_ptr<BoneAnimation> boneAnimation = make_shared<BoneAnimation>(model, streamHelper, fileReader, compressedTrack != compressedTracks.end() ? &*compressedTrack : nullptr);
 			mData.BoneAnimations.push_back(boneAnimation);
 			mData.BoneAnimationsByBone[&(boneAnimation->GetBone())] = boneAnimation;
 		}
 
 		streamHelper >> mData.KeyframeCount;
 	}
+
+	void AnimationClip::BuildTrackTable()
+	{
+		// Resolved once so sampling never goes through the bone's weak pointer or the by-bone map
+		mTrackBoneIndices.clear();
+		mTrackBoneIndices.reserve(mData.BoneAnimations.size());
+		for (auto& boneAnimation : mData.BoneAnimations)
+		{
+			mTrackBoneIndices.push_back(boneAnimation->GetBone().Index());
+		}
+
+		const uint32_t boneCount = (mTrackBoneIndices.empty() ? 0 : *max_element(mTrackBoneIndices.begin(), mTrackBoneIndices.end()) + 1);
+		mTrackIndices.assign(boneCount, NoTrack);
+		for (size_t i = 0; i < mTrackBoneIndices.size(); i++)
+		{
+			mTrackIndices[mTrackBoneIndices[i]] = narrow_cast<uint32_t>(i);
+		}
+	}
 }
@@ -7,6 +7,8 @@
 #include <map>
 #include <memory>
 #include <cstdint>
+#include <limits>
+#include <gsl\gsl>
 
 namespace Library
 {
@@ -15,6 +17,10 @@ namespace Library
 	class BoneAnimation;
 	class OutputStreamHelper;
 	class InputStreamHelper;
+	class ModelFileWriter;
+	class ModelFileReader;
+	struct ModelFileCompressedTrack;
+	struct LocalPose;
 
 	struct AnimationClipData final
 	{
@@ -37,7 +43,9 @@ namespace Library
     class AnimationClip final
     {
     public:
-		AnimationClip(Model& model, InputStreamHelper& streamHelper);
+		inline static const std::uint32_t NoTrack = std::numeric_limits<std::uint32_t>::max();
+
+		AnimationClip(Model& model, InputStreamHelper& streamHelper, const ModelFileReader* fileReader = nullptr, gsl::span<const ModelFileCompressedTrack> compressedTracks = { });
 		explicit AnimationClip(AnimationClipData&& animationClipData);
 		AnimationClip(const AnimationClip&) = default;
 		AnimationClip(AnimationClip&&) = default;
@@ -52,8 +60,12 @@ namespace Library
 		const std::map<Bone*, std::shared_ptr<BoneAnimation>>& BoneAnimationsByBone() const;
 		const std::uint32_t KeyframeCount() const;
 
+		// Index into BoneAnimations of the bone's track, or NoTrack if the clip doesn't animate it
+		std::uint32_t TrackIndex(std::uint32_t boneIndex) const;
+
 		std::uint32_t GetTransform(float time, Bone& bone, DirectX::XMFLOAT4X4& transform) const;
-		void GetTransforms(float time, std::vector<DirectX::XMFLOAT4X4>& boneTransforms) const;
+		// Fills the transforms of animated bones, by bone index, and returns the furthest keyframe any of them reached
+		std::uint32_t GetTransforms(float time, std::vector<DirectX::XMFLOAT4X4>& boneTransforms) const;
 		
 		void GetTransformAtKeyframe(std::uint32_t keyframe, Bone& bone, DirectX::XMFLOAT4X4& transform) const;
 		void GetTransformsAtKeyframe(std::uint32_t keyframe, std::vector<DirectX::XMFLOAT4X4>& boneTransforms) const;
@@ -61,11 +73,32 @@ namespace Library
 		void GetInteropolatedTransform(float time, Bone& bone, DirectX::XMFLOAT4X4& transform) const;
 		void GetInteropolatedTransforms(float time, std::vector<DirectX::XMFLOAT4X4>& boneTransforms) const;
 
-		void Save(OutputStreamHelper& streamHelper);
+		// keyframeCursors holds one cursor per bone animation for a single playback (see BoneAnimation); it's sized on first use
+		std::uint32_t GetTransforms(float time, std::vector<DirectX::XMFLOAT4X4>& boneTransforms, std::vector<std::uint32_t>& keyframeCursors) const;
+		void GetInteropolatedTransforms(float time, std::vector<DirectX::XMFLOAT4X4>& boneTransforms, std::vector<std::uint32_t>& keyframeCursors) const;
+
+		// The keyframe each bone is on, by bone index, as a pose to blend; bones without a track get identity
+		std::uint32_t GetTransforms(float time, LocalPose& pose, std::vector<std::uint32_t>& keyframeCursors) const;
+
+		// Interpolates every local bone transform, by bone index, in one pass; bones without a track get identity
+		void SampleAll(float time, gsl::span<DirectX::XMFLOAT4X4> boneTransforms) const;
+		void SampleAll(float time, gsl::span<DirectX::XMFLOAT4X4> boneTransforms, std::vector<std::uint32_t>& keyframeCursors) const;
+		void SampleAll(float time, LocalPose& pose, std::vector<std::uint32_t>& keyframeCursors) const;
+
+		// Only bones in boneSet (by bone index) are sampled; the others' transforms are left untouched
+		void SampleAll(float time, gsl::span<DirectX::XMFLOAT4X4> boneTransforms, std::vector<std::uint32_t>& keyframeCursors, const std::vector<bool>& boneSet) const;
+
+		// With a file writer/reader, keyframes go to the model file's keyframe section instead of inline in the stream.
+		// With compressedTracks, they're compressed and every bone animation adds its entry (AnimationIndex is left to the caller).
+		void Save(OutputStreamHelper& streamHelper, ModelFileWriter* fileWriter = nullptr, std::vector<ModelFileCompressedTrack>* compressedTracks = nullptr);
 
     private:
-		void Load(Model& model, InputStreamHelper& streamHelper);
+		void Load(Model& model, InputStreamHelper& streamHelper, const ModelFileReader* fileReader, gsl::span<const ModelFileCompressedTrack> compressedTracks);
+
+		void BuildTrackTable();
 
 		AnimationClipData mData;
+		std::vector<std::uint32_t> mTrackIndices;
+		std::vector<std::uint32_t> mTrackBoneIndices;
     };
 }
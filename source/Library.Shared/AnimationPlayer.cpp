@@ -4,6 +4,9 @@
 #include "Bone.h"
 #include "GameTime.h"
 #include "AnimationClip.h"
+#include "Skeleton.h"
+#include "BakedAnimationCache.h"
+#include "GameException.h"
 
 using namespace std;
 using namespace DirectX;
@@ -14,9 +17,12 @@ namespace Library
 
 	AnimationPlayer::AnimationPlayer(Game& game, shared_ptr<Model> model, bool interpolationEnabled) :
 		GameComponent(game),
-		mModel(move(model)), mInterpolationEnabled(interpolationEnabled)
+		mModel(move(model)), mInterpolationEnabled(interpolationEnabled), mPosePool(gsl::narrow_cast<uint32_t>(mModel->Bones().size()))
 	{
-		mFinalTransforms.resize(mModel->Bones().size());
+		const size_t boneCount = mModel->Bones().size();
+		mBoneTransforms.resize(boneCount, MatrixHelper::Identity);
+		mFinalTransforms.resize(boneCount);
+		mToRootTransforms.resize(mModel->GetSkeleton().NodeCount());
 	}
 
 	const shared_ptr<Model>& AnimationPlayer::GetModel() const
@@ -69,12 +75,15 @@ namespace Library
 		mCurrentClip = clip;
 		mCurrentTime = 0.0f;
 		mCurrentKeyframe = 0;
+		mKeyframeCursors.clear();
+		mFadeClip = nullptr;
+		mBakedClip = (mBakedAnimationCache != nullptr ? mBakedAnimationCache->Find(*clip) : nullptr);
 		mIsPlayingClip = true;
 
 		XMVECTOR determinant = XMMatrixDeterminant(mModel->RootNode()->TransformMatrix());
 		XMMATRIX inverseRootTransform = XMMatrixInverse(&determinant, mModel->RootNode()->TransformMatrix());
 		XMStoreFloat4x4(&mInverseRootTransform, inverseRootTransform);
-		GetPose(mCurrentTime, *(mModel->RootNode()));
+		GetPose(mCurrentTime);
 	}
 
 	void AnimationPlayer::PauseClip()
@@ -99,12 +108,17 @@ namespace Library
 	}
 
 	void AnimationPlayer::Update(const GameTime& gameTime)
+	{
+		Advance(gameTime.ElapsedGameTimeSeconds().count());
+	}
+
+	void AnimationPlayer::Advance(float elapsedSeconds, bool evaluatePose)
 	{
 		if (mIsPlayingClip)
 		{
 			assert(mCurrentClip != nullptr);
 
-			mCurrentTime += gameTime.ElapsedGameTimeSeconds().count() * mCurrentClip->TicksPerSecond();
+			mCurrentTime += elapsedSeconds * mCurrentClip->TicksPerSecond();
 			if (mCurrentTime >= mCurrentClip->Duration())
 			{
 				if (mIsClipLooped)
@@ -118,14 +132,35 @@ namespace Library
 				}
 			}
 
-			auto& rootNode = *(mModel->RootNode());
-			if (mInterpolationEnabled)
+			const bool isBlending = (mFadeClip != nullptr || mLayers.empty() == false);
+			if (isBlending)
 			{
-				GetInterpolatedPose(mCurrentTime, rootNode);
+				AdvanceBlends(elapsedSeconds);
+			}
+
+			if (evaluatePose == false)
+			{
+				return;
+			}
+
+			if (isBlending)
+			{
+				GetBlendedPose();
+			}
+			else if (mInterpolationEnabled)
+			{
+				if (mBakedClip != nullptr)
+				{
+					mBakedClip->GetPalette(mCurrentTime, mFinalTransforms);
+				}
+				else
+				{
+					GetInterpolatedPose(mCurrentTime);
+				}
 			}
 			else
 			{
-				GetPose(mCurrentTime, rootNode);
+				GetPose(mCurrentTime);
 			}
 		}
 	}
@@ -133,141 +168,245 @@ namespace Library
 	void AnimationPlayer::SetCurrentKeyFrame(uint32_t keyframe)
 	{
 		mCurrentKeyframe = keyframe;
-		GetPoseAtKeyframe(mCurrentKeyframe, *(mModel->RootNode()));
+		GetPoseAtKeyframe(mCurrentKeyframe);
 	}
 
-	void AnimationPlayer::GetBindPoseBottomUp(SceneNode& sceneNode)
+	void AnimationPlayer::GetBindPose()
 	{
-		XMMATRIX toRootTransform = sceneNode.TransformMatrix();
-
-		auto parentNode = sceneNode.GetParent().lock();
-		while (parentNode != nullptr)
+		const Skeleton& skeleton = mModel->GetSkeleton();
+		const auto boneIndices = skeleton.BoneIndices();
+		const auto localTransforms = skeleton.LocalTransforms();
+		for (uint32_t node = 0; node < skeleton.NodeCount(); ++node)
 		{
-			toRootTransform = toRootTransform * parentNode->TransformMatrix();
-			parentNode = parentNode->GetParent().lock();
+			if (boneIndices[node] != Skeleton::NoBone)
+			{
+				mBoneTransforms[boneIndices[node]] = localTransforms[node];
+			}
 		}
 
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
-		}
+		ComposePose();
+	}
 
-		for (const auto& childNode : sceneNode.Children())
+	void AnimationPlayer::CrossFade(const shared_ptr<AnimationClip>& clip, float duration)
+	{
+		if (mCurrentClip == nullptr || duration <= 0.0f)
 		{
-			GetBindPoseBottomUp(*childNode);
+			StartClip(clip);
+			return;
 		}
+
+		shared_ptr<AnimationClip> fadeClip = mCurrentClip;
+		const float fadeTime = mCurrentTime;
+		vector<uint32_t> fadeKeyframeCursors;
+		fadeKeyframeCursors.swap(mKeyframeCursors);
+
+		StartClip(clip);
+
+		mFadeClip = move(fadeClip);
+		mFadeTime = fadeTime;
+		mFadeKeyframeCursors = move(fadeKeyframeCursors);
+		mFadeElapsed = 0.0f;
+		mFadeDuration = duration;
 	}
 
-	void AnimationPlayer::GetBindPose()
+	const vector<AnimationLayer>& AnimationPlayer::Layers() const
 	{
-		GetBindPose(*(mModel->RootNode()));
+		return mLayers;
 	}
 
-	void AnimationPlayer::GetBindPose(SceneNode& sceneNode)
+	uint32_t AnimationPlayer::AddLayer(const shared_ptr<AnimationClip>& clip, AnimationLayerMode mode, float weight, vector<float> boneMask)
 	{
-		XMMATRIX toParentTransform = sceneNode.TransformMatrix();
-		auto parentNode = sceneNode.GetParent().lock();
-		XMMATRIX toRootTransform = (parentNode != nullptr ? toParentTransform * XMLoadFloat4x4(&(mToRootTransforms.at(parentNode.get()))) : toParentTransform);
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);		
+		assert(clip != nullptr);
 
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
-		}
+		AnimationLayer layer;
+		layer.Clip = clip;
+		layer.Mode = mode;
+		layer.Weight = weight;
+		layer.BoneMask = move(boneMask);
 
-		for (const auto& childNode : sceneNode.Children())
+		if (mode == AnimationLayerMode::Additive)
 		{
-			GetBindPose(*childNode);
+			layer.ReferencePose.Resize(mPosePool.BoneCount());
+			vector<uint32_t> referenceKeyframeCursors;
+			clip->SampleAll(0.0f, layer.ReferencePose, referenceKeyframeCursors);
 		}
+
+		mLayers.push_back(move(layer));
+
+		return gsl::narrow_cast<uint32_t>(mLayers.size() - 1);
 	}
 
-	void AnimationPlayer::GetPose(float time, SceneNode& sceneNode)
+	void AnimationPlayer::SetLayerWeight(uint32_t layer, float weight)
 	{
-		XMFLOAT4X4 toParentTransform;
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
-		{
-			auto keyframe = mCurrentClip->GetTransform(time, *bone, toParentTransform);
-			if (keyframe != numeric_limits<uint32_t>::max())
-			{
-				mCurrentKeyframe = keyframe;
-			}
-		}
-		else
+		mLayers.at(layer).Weight = weight;
+	}
+
+	void AnimationPlayer::RemoveLayer(uint32_t layer)
+	{
+		if (layer >= mLayers.size())
 		{
-			toParentTransform = sceneNode.Transform();
+			throw GameException("Animation layer index is out of range.");
 		}
 
-		auto parentNode = sceneNode.GetParent().lock();
-		XMMATRIX toRootTransform = (parentNode != nullptr ? XMLoadFloat4x4(&toParentTransform) * XMLoadFloat4x4(&(mToRootTransforms.at(parentNode.get()))) : XMLoadFloat4x4(&toParentTransform));
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
+		mLayers.erase(mLayers.begin() + layer);
+	}
+
+	void AnimationPlayer::ClearLayers()
+	{
+		mLayers.clear();
+	}
+
+	const shared_ptr<BakedAnimationCache>& AnimationPlayer::GetBakedAnimationCache() const
+	{
+		return mBakedAnimationCache;
+	}
+
+	void AnimationPlayer::SetBakedAnimationCache(shared_ptr<BakedAnimationCache> bakedAnimationCache)
+	{
+		assert(bakedAnimationCache == nullptr || bakedAnimationCache->GetModel() == mModel);
+
+		mBakedAnimationCache = move(bakedAnimationCache);
+		mBakedClip = (mBakedAnimationCache != nullptr && mCurrentClip != nullptr ? mBakedAnimationCache->Find(*mCurrentClip) : nullptr);
+	}
 
-		if (bone != nullptr)
+	const vector<bool>& AnimationPlayer::ReducedBoneSet() const
+	{
+		return mReducedBoneSet;
+	}
+
+	void AnimationPlayer::SetReducedBoneSet(vector<bool> boneSet)
+	{
+		mReducedBoneSet = move(boneSet);
+	}
+
+	bool AnimationPlayer::ReducedBoneSetEnabled() const
+	{
+		return mReducedBoneSetEnabled;
+	}
+
+	void AnimationPlayer::SetReducedBoneSetEnabled(bool enabled)
+	{
+		mReducedBoneSetEnabled = enabled;
+	}
+
+	void AnimationPlayer::GetPose(float time)
+	{
+		// Bones without a track in the clip stay at identity
+		fill(mBoneTransforms.begin(), mBoneTransforms.end(), MatrixHelper::Identity);
+		mCurrentKeyframe = mCurrentClip->GetTransforms(time, mBoneTransforms, mKeyframeCursors);
+		ComposePose();
+	}
+
+	void AnimationPlayer::GetPoseAtKeyframe(uint32_t keyframe)
+	{
+		fill(mBoneTransforms.begin(), mBoneTransforms.end(), MatrixHelper::Identity);
+		mCurrentClip->GetTransformsAtKeyframe(keyframe, mBoneTransforms);
+		ComposePose();
+	}
+
+	void AnimationPlayer::GetInterpolatedPose(float time)
+	{
+		if (mReducedBoneSetEnabled && mReducedBoneSet.empty() == false)
 		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			mCurrentClip->SampleAll(time, mBoneTransforms, mKeyframeCursors, mReducedBoneSet);
 		}
-
-		for (const auto& childNode : sceneNode.Children())
+		else
 		{
-			GetPose(time, *childNode);
+			mCurrentClip->SampleAll(time, mBoneTransforms, mKeyframeCursors);
 		}
+
+		ComposePose();
 	}
 
-	void AnimationPlayer::GetPoseAtKeyframe(uint32_t keyframe, SceneNode& sceneNode)
+	void AnimationPlayer::GetBlendedPose()
 	{
-		XMFLOAT4X4 toParentTransform;
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
+		// Everything is blended in local space, so the hierarchy is walked once however many clips contribute
+		mPosePool.Reset();
+		LocalPose& pose = mPosePool.Acquire();
+		if (mInterpolationEnabled)
 		{
-			mCurrentClip->GetTransformAtKeyframe(keyframe, *bone, toParentTransform);
+			mCurrentClip->SampleAll(mCurrentTime, pose, mKeyframeCursors);
 		}
 		else
 		{
-			toParentTransform = sceneNode.Transform();
+			mCurrentKeyframe = mCurrentClip->GetTransforms(mCurrentTime, pose, mKeyframeCursors);
 		}
 
-		auto parentNode = sceneNode.GetParent().lock();
-		XMMATRIX toRootTransform = (parentNode != nullptr ? XMLoadFloat4x4(&toParentTransform) * XMLoadFloat4x4(&(mToRootTransforms.at(parentNode.get()))) : XMLoadFloat4x4(&toParentTransform));
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
-
-		if (bone != nullptr)
+		if (mFadeClip != nullptr)
 		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			LocalPose& fadePose = mPosePool.Acquire();
+			SamplePose(*mFadeClip, mFadeTime, fadePose, mFadeKeyframeCursors);
+			PoseBlending::Blend(fadePose, pose, mFadeElapsed / mFadeDuration, pose);
 		}
 
-		for (const auto& childNode : sceneNode.Children())
+		for (auto& layer : mLayers)
 		{
-			GetPoseAtKeyframe(keyframe, *childNode);
+			if (layer.Weight <= 0.0f)
+			{
+				continue;
+			}
+
+			LocalPose& layerPose = mPosePool.Acquire();
+			SamplePose(*layer.Clip, layer.CurrentTime, layerPose, layer.KeyframeCursors);
+			if (layer.Mode == AnimationLayerMode::Additive)
+			{
+				PoseBlending::Add(pose, layerPose, layer.ReferencePose, layer.Weight, pose, layer.BoneMask);
+			}
+			else
+			{
+				PoseBlending::Blend(pose, layerPose, layer.Weight, pose, layer.BoneMask);
+			}
 		}
+
+		pose.GetTransforms(mBoneTransforms);
+		ComposePose();
 	}
 
-	void AnimationPlayer::GetInterpolatedPose(float time, SceneNode& sceneNode)
+	void AnimationPlayer::SamplePose(const AnimationClip& clip, float time, LocalPose& pose, vector<uint32_t>& keyframeCursors) const
 	{
-		XMFLOAT4X4 toParentTransform;
-		Bone* bone = sceneNode.As<Bone>();
-		if (bone != nullptr)
+		// Blended clips step through their keyframes too when interpolation is off
+		if (mInterpolationEnabled)
 		{
-			mCurrentClip->GetInteropolatedTransform(time, *bone, toParentTransform);
+			clip.SampleAll(time, pose, keyframeCursors);
 		}
 		else
 		{
-			toParentTransform = sceneNode.Transform();
+			clip.GetTransforms(time, pose, keyframeCursors);
 		}
+	}
 
-		auto parentNode = sceneNode.GetParent().lock();
-		XMMATRIX toRootTransform = (parentNode != nullptr ? XMLoadFloat4x4(&toParentTransform) * XMLoadFloat4x4(&(mToRootTransforms.at(parentNode.get()))) : XMLoadFloat4x4(&toParentTransform));
-		XMStoreFloat4x4(&(mToRootTransforms[&sceneNode]), toRootTransform);
-
-		if (bone != nullptr)
+	void AnimationPlayer::AdvanceBlends(float elapsedSeconds)
+	{
+		if (mFadeClip != nullptr)
 		{
-			XMStoreFloat4x4(&(mFinalTransforms[bone->Index()]), bone->OffsetTransformMatrix() * toRootTransform * XMLoadFloat4x4(&mInverseRootTransform));
+			mFadeElapsed += elapsedSeconds;
+			if (mFadeElapsed >= mFadeDuration)
+			{
+				mFadeClip = nullptr;
+			}
+			else
+			{
+				mFadeTime += elapsedSeconds * mFadeClip->TicksPerSecond();
+				if (mFadeTime >= mFadeClip->Duration())
+				{
+					mFadeTime = 0.0f;
+				}
+			}
 		}
 
-		for (const auto& childNode : sceneNode.Children())
+		// Layers loop on their own clip's duration
+		for (auto& layer : mLayers)
 		{
-			GetInterpolatedPose(time, *childNode);
+			layer.CurrentTime += elapsedSeconds * layer.Clip->TicksPerSecond();
+			if (layer.CurrentTime >= layer.Clip->Duration())
+			{
+				layer.CurrentTime = 0.0f;
+			}
 		}
 	}
-}
+
+	void AnimationPlayer::ComposePose()
+	{
+		mModel->GetSkeleton().ComposePose(mBoneTransforms, XMLoadFloat4x4(&mInverseRootTransform), mToRootTransforms, mFinalTransforms);
+	}
+}
\ No newline at end of file
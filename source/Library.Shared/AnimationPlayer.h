@@ -2,15 +2,36 @@
 
 #include "GameComponent.h"
 #include "MatrixHelper.h"
+#include "LocalPose.h"
 #include <memory>
+#include <vector>
 #include <DirectXMath.h>
 
 namespace Library
 {
 	class GameTime;
 	class Model;
-	class SceneNode;
 	class AnimationClip;
+	class BakedAnimationClip;
+	class BakedAnimationCache;
+
+	enum class AnimationLayerMode
+	{
+		Override,
+		Additive
+	};
+
+	// A clip played over the current clip. Additive layers apply their difference from the clip's first frame.
+	struct AnimationLayer final
+	{
+		std::shared_ptr<AnimationClip> Clip;
+		AnimationLayerMode Mode{ AnimationLayerMode::Override };
+		float Weight{ 1.0f };
+		std::vector<float> BoneMask;				// By bone index; empty for every bone
+		float CurrentTime{ 0.0f };
+		std::vector<std::uint32_t> KeyframeCursors;
+		LocalPose ReferencePose;
+	};
 
     class AnimationPlayer final : GameComponent
     {
@@ -43,22 +64,64 @@ namespace Library
 		void SetCurrentKeyFrame(std::uint32_t keyframe);
 		void GetBindPose();
 
+		// Starts the clip while the current one keeps playing and fades out over duration seconds
+		void CrossFade(const std::shared_ptr<AnimationClip>& clip, float duration);
+
+		// Layers are blended in order over the current clip, always interpolated, before the pose is composed.
+		// Use PoseBlending::CreateBoneMask for a layer that only drives part of the skeleton.
+		const std::vector<AnimationLayer>& Layers() const;
+		std::uint32_t AddLayer(const std::shared_ptr<AnimationClip>& clip, AnimationLayerMode mode = AnimationLayerMode::Override, float weight = 1.0f, std::vector<float> boneMask = std::vector<float>());
+		void SetLayerWeight(std::uint32_t layer, float weight);
+		void RemoveLayer(std::uint32_t layer);
+		void ClearLayers();
+
+		// With a cache (for this player's model), clips it can bake play back from their baked palettes when interpolation
+		// is enabled and nothing is blended over them; stepped playback still samples the keyframes to track CurrentKeyframe
+		const std::shared_ptr<BakedAnimationCache>& GetBakedAnimationCache() const;
+		void SetBakedAnimationCache(std::shared_ptr<BakedAnimationCache> bakedAnimationCache);
+
+		// Reduced bone sets are by bone index. While enabled, interpolated playback samples only those bones and the
+		// rest hold their last local transform.
+		const std::vector<bool>& ReducedBoneSet() const;
+		void SetReducedBoneSet(std::vector<bool> boneSet);
+		bool ReducedBoneSetEnabled() const;
+		void SetReducedBoneSetEnabled(bool enabled);
+
 		virtual void Update(const GameTime& gameTime) override;
 
+		// Moves playback forward; without evaluatePose the bone transforms are left as they are, for players updated at a
+		// reduced rate
+		void Advance(float elapsedSeconds, bool evaluatePose = true);
+
     private:
-		void GetBindPose(SceneNode& sceneNode);
-		void GetBindPoseBottomUp(SceneNode& sceneNode);
-		void GetPose(float time, SceneNode& sceneNode);
-		void GetPoseAtKeyframe(std::uint32_t keyframe, SceneNode& sceneNode);
-		void GetInterpolatedPose(float time, SceneNode& sceneNode);		
+		void GetPose(float time);
+		void GetPoseAtKeyframe(std::uint32_t keyframe);
+		void GetInterpolatedPose(float time);
+		void GetBlendedPose();
+		void SamplePose(const AnimationClip& clip, float time, LocalPose& pose, std::vector<std::uint32_t>& keyframeCursors) const;
+		void AdvanceBlends(float elapsedSeconds);
+		void ComposePose();
 
 		std::shared_ptr<Model> mModel;
 		std::shared_ptr<AnimationClip> mCurrentClip;
 		float mCurrentTime{ 0.0f };
 		std::uint32_t mCurrentKeyframe{ 0 };
-		std::map<SceneNode*, DirectX::XMFLOAT4X4> mToRootTransforms;
+		std::vector<std::uint32_t> mKeyframeCursors;			// Per bone animation of the current clip
+		std::vector<DirectX::XMFLOAT4X4> mBoneTransforms;		// Bone to parent, by bone index
+		std::vector<DirectX::XMFLOAT4X4> mToRootTransforms;	// By skeleton node
 		std::vector<DirectX::XMFLOAT4X4> mFinalTransforms;
 		DirectX::XMFLOAT4X4 mInverseRootTransform{ MatrixHelper::Identity };
+		std::shared_ptr<AnimationClip> mFadeClip;
+		float mFadeTime{ 0.0f };
+		float mFadeElapsed{ 0.0f };
+		float mFadeDuration{ 0.0f };
+		std::vector<std::uint32_t> mFadeKeyframeCursors;
+		std::vector<AnimationLayer> mLayers;
+		PosePool mPosePool;
+		std::shared_ptr<BakedAnimationCache> mBakedAnimationCache;
+		std::shared_ptr<const BakedAnimationClip> mBakedClip;
+		std::vector<bool> mReducedBoneSet;
+		bool mReducedBoneSetEnabled{ false };
 		bool mInterpolationEnabled;
 		bool mIsPlayingClip{ false };
 		bool mIsClipLooped{ true };
@@ -0,0 +1,224 @@
+#include "pch.h"
+#include "AnimationSystem.h"
+#include "AnimationPlayer.h"
+#include "ThreadPool.h"
+#include "GameTime.h"
+#include "Camera.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	RTTI_DEFINITIONS(AnimationSystem)
+
+	AnimationSystem::AnimationSystem(Game& game, shared_ptr<ThreadPool> threadPool, uint32_t playersPerJob) :
+		GameComponent(game), mThreadPool(move(threadPool)), mPlayersPerJob(max(playersPerJob, 1U))
+	{
+	}
+
+	AnimationSystem::~AnimationSystem() = default;
+
+	const vector<shared_ptr<AnimationPlayer>>& AnimationSystem::Players() const
+	{
+		return mPlayers;
+	}
+
+	uint32_t AnimationSystem::AddPlayer(shared_ptr<AnimationPlayer> player, const XMFLOAT3& position)
+	{
+		assert(player != nullptr);
+
+		// The palette starts from the player's current pose so it's valid before the first update
+		const auto& boneTransforms = player->BoneTransforms();
+		mPalettes.insert(mPalettes.end(), boneTransforms.begin(), boneTransforms.end());
+		mPaletteOffsets.push_back(narrow_cast<uint32_t>(mPalettes.size()));
+		mPlayerPositions.push_back(position);
+		mPlayers.push_back(move(player));
+
+		return narrow_cast<uint32_t>(mPlayers.size() - 1);
+	}
+
+	void AnimationSystem::SetPlayerPosition(uint32_t instance, const XMFLOAT3& position)
+	{
+		mPlayerPositions.at(instance) = position;
+	}
+
+	void AnimationSystem::Clear()
+	{
+		mPlayers.clear();
+		mPlayerPositions.clear();
+		mPalettes.clear();
+		mPaletteOffsets.assign(1, 0);
+	}
+
+	const shared_ptr<Camera>& AnimationSystem::GetCamera() const
+	{
+		return mCamera;
+	}
+
+	void AnimationSystem::SetCamera(shared_ptr<Camera> camera)
+	{
+		mCamera = move(camera);
+	}
+
+	const vector<AnimationLodLevel>& AnimationSystem::LodLevels() const
+	{
+		return mLodLevels;
+	}
+
+	void AnimationSystem::SetLodLevels(vector<AnimationLodLevel> lodLevels)
+	{
+		mLodLevels = move(lodLevels);
+		sort(mLodLevels.begin(), mLodLevels.end(), [](const AnimationLodLevel& lhs, const AnimationLodLevel& rhs) { return lhs.Distance < rhs.Distance; });
+	}
+
+	AnimationSystemStatistics AnimationSystem::Statistics() const
+	{
+		return mStatistics;
+	}
+
+	uint32_t AnimationSystem::PaletteOffset(uint32_t instance) const
+	{
+		return mPaletteOffsets.at(instance);
+	}
+
+	span<const XMFLOAT4X4> AnimationSystem::Palette(uint32_t instance) const
+	{
+		const uint32_t offset = mPaletteOffsets.at(instance);
+		return span<const XMFLOAT4X4>(mPalettes.data() + offset, mPaletteOffsets.at(instance + 1) - offset);
+	}
+
+	span<const XMFLOAT4X4> AnimationSystem::Palettes() const
+	{
+		return mPalettes;
+	}
+
+	void AnimationSystem::Update(const GameTime& gameTime)
+	{
+		const uint32_t playerCount = narrow_cast<uint32_t>(mPlayers.size());
+		const uint32_t jobCount = (mThreadPool != nullptr ? (playerCount + mPlayersPerJob - 1) / mPlayersPerJob : 1U);
+		const uint32_t playersPerJob = (mThreadPool != nullptr ? mPlayersPerJob : playerCount);
+
+		if (mCamera != nullptr)
+		{
+			mCameraPosition = mCamera->Position();
+		}
+
+		mEvaluatedPoses = 0;
+		mSkippedPoses = 0;
+
+		// Players share only read-only models and clips, and each job writes a disjoint range of the palettes
+		mJobs.clear();
+		for (uint32_t job = 1; job < jobCount; ++job)
+		{
+			const uint32_t first = job * playersPerJob;
+			const uint32_t last = min(first + playersPerJob, playerCount);
+			auto request = make_shared<promise<void>>();
+			mJobs.push_back(request->get_future());
+
+			mThreadPool->Enqueue([this, request, &gameTime, first, last]
+			{
+				try
+				{
+					UpdatePlayers(gameTime, first, last);
+					request->set_value();
+				}
+				catch (...)
+				{
+					request->set_exception(current_exception());
+				}
+			});
+		}
+
+		// The calling thread takes the first batch rather than idling
+		exception_ptr error;
+		try
+		{
+			UpdatePlayers(gameTime, 0, min(playersPerJob, playerCount));
+		}
+		catch (...)
+		{
+			error = current_exception();
+		}
+
+		// Every job references this frame's game time, so all of them finish before an error is rethrown
+		for (auto& job : mJobs)
+		{
+			try
+			{
+				job.get();
+			}
+			catch (...)
+			{
+				if (error == nullptr)
+				{
+					error = current_exception();
+				}
+			}
+		}
+
+		mStatistics.EvaluatedPoses = mEvaluatedPoses;
+		mStatistics.SkippedPoses = mSkippedPoses;
+		++mFrame;
+
+		if (error != nullptr)
+		{
+			rethrow_exception(error);
+		}
+	}
+
+	void AnimationSystem::UpdatePlayers(const GameTime& gameTime, uint32_t first, uint32_t last)
+	{
+		const float elapsedSeconds = gameTime.ElapsedGameTimeSeconds().count();
+		uint32_t evaluatedPoses = 0;
+
+		for (uint32_t instance = first; instance < last; ++instance)
+		{
+			// Skipped players still advance, so their clips stay in step for when they're next evaluated
+			AnimationPlayer& player = *mPlayers[instance];
+			const AnimationLodLevel* lodLevel = SelectLodLevel(instance);
+			const bool evaluatePose = (lodLevel == nullptr || (mFrame + instance) % max(lodLevel->UpdateInterval, 1U) == 0);
+			player.SetReducedBoneSetEnabled(lodLevel != nullptr && lodLevel->ReducedBoneSet);
+			player.Advance(elapsedSeconds, evaluatePose);
+			if (evaluatePose == false)
+			{
+				continue;
+			}
+
+			++evaluatedPoses;
+
+			const auto& boneTransforms = player.BoneTransforms();
+			assert(boneTransforms.size() == mPaletteOffsets[instance + 1] - mPaletteOffsets[instance]);
+			copy(boneTransforms.begin(), boneTransforms.end(), mPalettes.begin() + mPaletteOffsets[instance]);
+		}
+
+		mEvaluatedPoses += evaluatedPoses;
+		mSkippedPoses += (last - first) - evaluatedPoses;
+	}
+
+	const AnimationLodLevel* AnimationSystem::SelectLodLevel(uint32_t instance) const
+	{
+		if (mCamera == nullptr || mLodLevels.empty())
+		{
+			return nullptr;
+		}
+
+		const XMVECTOR offset = XMLoadFloat3(&mPlayerPositions[instance]) - XMLoadFloat3(&mCameraPosition);
+		const float distanceSquared = XMVectorGetX(XMVector3LengthSq(offset));
+
+		// Levels are sorted by distance, so the last one reached applies
+		const AnimationLodLevel* lodLevel = nullptr;
+		for (const auto& level : mLodLevels)
+		{
+			if (distanceSquared < level.Distance * level.Distance)
+			{
+				break;
+			}
+
+			lodLevel = &level;
+		}
+
+		return lodLevel;
+	}
+}
\ No newline at end of file
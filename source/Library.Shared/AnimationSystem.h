@@ -0,0 +1,92 @@
+#pragma once
+
+#include "GameComponent.h"
+#include <memory>
+#include <vector>
+#include <future>
+#include <atomic>
+#include <cstdint>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class GameTime;
+	class AnimationPlayer;
+	class Camera;
+	class ThreadPool;
+
+	// Players at least Distance from the camera are evaluated every UpdateInterval frames, optionally on their reduced
+	// bone set (see AnimationPlayer::SetReducedBoneSet)
+	struct AnimationLodLevel final
+	{
+		float Distance{ 0.0f };
+		std::uint32_t UpdateInterval{ 1 };
+		bool ReducedBoneSet{ false };
+	};
+
+	// Counts for the most recent update
+	struct AnimationSystemStatistics final
+	{
+		std::uint32_t EvaluatedPoses{ 0 };
+		std::uint32_t SkippedPoses{ 0 };
+	};
+
+	// Updates many animation players as parallel jobs and gathers their bone transforms into one contiguous buffer, each
+	// player's palette at a fixed offset, ready for upload. Players added here shouldn't also be updated as game components.
+	// The thread pool can be shared with other systems; without one, every player is updated on the calling thread.
+	class AnimationSystem final : public GameComponent
+	{
+		RTTI_DECLARATIONS(AnimationSystem, GameComponent)
+
+	public:
+		inline static const std::uint32_t DefaultPlayersPerJob = 16;
+
+		explicit AnimationSystem(Game& game, std::shared_ptr<ThreadPool> threadPool = nullptr, std::uint32_t playersPerJob = DefaultPlayersPerJob);
+		AnimationSystem(const AnimationSystem&) = delete;
+		AnimationSystem(AnimationSystem&&) = delete;
+		AnimationSystem& operator=(const AnimationSystem&) = delete;
+		AnimationSystem& operator=(AnimationSystem&&) = delete;
+		~AnimationSystem();
+
+		const std::vector<std::shared_ptr<AnimationPlayer>>& Players() const;
+
+		// Returns the player's instance index; palettes move when players are added or cleared
+		std::uint32_t AddPlayer(std::shared_ptr<AnimationPlayer> player, const DirectX::XMFLOAT3& position = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+		void SetPlayerPosition(std::uint32_t instance, const DirectX::XMFLOAT3& position);
+		void Clear();
+
+		// Without a camera or LOD levels every player is evaluated every frame. Reduced-rate players are staggered by
+		// instance so they don't all land on the same frame.
+		const std::shared_ptr<Camera>& GetCamera() const;
+		void SetCamera(std::shared_ptr<Camera> camera);
+		const std::vector<AnimationLodLevel>& LodLevels() const;
+		void SetLodLevels(std::vector<AnimationLodLevel> lodLevels);
+		AnimationSystemStatistics Statistics() const;
+
+		std::uint32_t PaletteOffset(std::uint32_t instance) const;
+		gsl::span<const DirectX::XMFLOAT4X4> Palette(std::uint32_t instance) const;
+		gsl::span<const DirectX::XMFLOAT4X4> Palettes() const;
+
+		virtual void Update(const GameTime& gameTime) override;
+
+	private:
+		void UpdatePlayers(const GameTime& gameTime, std::uint32_t first, std::uint32_t last);
+		const AnimationLodLevel* SelectLodLevel(std::uint32_t instance) const;
+
+		std::vector<std::shared_ptr<AnimationPlayer>> mPlayers;
+		std::vector<std::uint32_t> mPaletteOffsets{ 0 };	// One past the players, so instance i spans [i, i + 1)
+		std::vector<DirectX::XMFLOAT4X4> mPalettes;
+		std::vector<DirectX::XMFLOAT3> mPlayerPositions;
+		std::shared_ptr<Camera> mCamera;
+		DirectX::XMFLOAT3 mCameraPosition{ 0.0f, 0.0f, 0.0f };
+		std::vector<AnimationLodLevel> mLodLevels;
+		std::uint32_t mFrame{ 0 };
+		std::atomic<std::uint32_t> mEvaluatedPoses{ 0 };
+		std::atomic<std::uint32_t> mSkippedPoses{ 0 };
+		AnimationSystemStatistics mStatistics;
+		std::vector<std::future<void>> mJobs;
+		std::shared_ptr<ThreadPool> mThreadPool;
+		std::uint32_t mPlayersPerJob;
+	};
+}
\ No newline at end of file
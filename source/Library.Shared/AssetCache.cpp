@@ -0,0 +1,134 @@
+#include "pch.h"
+#include "AssetCache.h"
+
+using namespace std;
+
+namespace Library
+{
+	const size_t AssetCache::UnlimitedBudget = numeric_limits<size_t>::max();
+
+	AssetCache::AssetCache(size_t budget) :
+		mBudget(budget)
+	{
+	}
+
+	size_t AssetCache::Budget() const
+	{
+		return mBudget;
+	}
+
+	void AssetCache::SetBudget(size_t budget)
+	{
+		mBudget = budget;
+		Trim();
+	}
+
+	size_t AssetCache::Size() const
+	{
+		return mSize;
+	}
+
+	AssetCacheStatistics AssetCache::Statistics() const
+	{
+		AssetCacheStatistics statistics;
+		statistics.Hits = mHits;
+		statistics.Misses = mMisses;
+		statistics.Evictions = mEvictions;
+		statistics.EvictedBytes = mEvictedBytes;
+		statistics.AssetCount = mEntries.size();
+		statistics.Size = mSize;
+		statistics.Budget = mBudget;
+
+		return statistics;
+	}
+
+	void AssetCache::ResetStatistics()
+	{
+		mHits = 0;
+		mMisses = 0;
+		mEvictions = 0;
+		mEvictedBytes = 0;
+	}
+
+	shared_ptr<RTTI> AssetCache::Find(const wstring& assetName)
+	{
+		auto it = mLookup.find(assetName);
+		if (it == mLookup.end())
+		{
+			++mMisses;
+			return nullptr;
+		}
+
+		++mHits;
+		mEntries.splice(mEntries.begin(), mEntries, it->second);
+
+		return it->second->Asset;
+	}
+
+	bool AssetCache::Contains(const wstring& assetName) const
+	{
+		return mLookup.find(assetName) != mLookup.end();
+	}
+
+	void AssetCache::Insert(const wstring& assetName, const shared_ptr<RTTI>& asset, size_t size)
+	{
+		auto it = mLookup.find(assetName);
+		if (it != mLookup.end())
+		{
+			Entry& entry = *it->second;
+			mSize -= entry.Size;
+			entry.Asset = asset;
+			entry.Size = size;
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+		}
+		else
+		{
+			mEntries.push_front(Entry{ assetName, asset, size });
+			mLookup.emplace(assetName, mEntries.begin());
+		}
+
+		mSize += size;
+		Trim();
+	}
+
+	void AssetCache::Remove(const wstring& assetName)
+	{
+		auto it = mLookup.find(assetName);
+		if (it != mLookup.end())
+		{
+			mSize -= it->second->Size;
+			mEntries.erase(it->second);
+			mLookup.erase(it);
+		}
+	}
+
+	void AssetCache::Clear()
+	{
+		mEntries.clear();
+		mLookup.clear();
+		mSize = 0;
+	}
+
+	size_t AssetCache::Trim()
+	{
+		size_t evictions = 0;
+
+		// Walk from the least recently used end, skipping anything still referenced outside the cache
+		for (auto it = mEntries.end(); mSize > mBudget && it != mEntries.begin();)
+		{
+			--it;
+			if (it->Asset.use_count() == 1)
+			{
+				mSize -= it->Size;
+				mEvictedBytes += it->Size;
+				mLookup.erase(it->Name);
+				it = mEntries.erase(it);
+				++evictions;
+			}
+		}
+
+		mEvictions += evictions;
+
+		return evictions;
+	}
+}
\ No newline at end of file
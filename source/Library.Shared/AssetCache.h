@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <list>
+#include <unordered_map>
+#include <limits>
+#include "RTTI.h"
+
+namespace Library
+{
+	struct AssetCacheStatistics final
+	{
+		std::uint64_t Hits{ 0 };
+		std::uint64_t Misses{ 0 };
+		std::uint64_t Evictions{ 0 };
+		std::uint64_t EvictedBytes{ 0 };
+		std::size_t AssetCount{ 0 };
+		std::size_t Size{ 0 };
+		std::size_t Budget{ 0 };
+	};
+
+	// Least-recently-used cache of loaded assets. Only assets the cache holds the last reference to are ever evicted, so the
+	// budget is a soft limit: while everything is still in use the cache is allowed to grow past it.
+	class AssetCache final
+	{
+	public:
+		static const std::size_t UnlimitedBudget;
+
+		explicit AssetCache(std::size_t budget = UnlimitedBudget);
+		AssetCache(const AssetCache&) = delete;
+		AssetCache& operator=(const AssetCache&) = delete;
+		AssetCache(AssetCache&&) = default;
+		AssetCache& operator=(AssetCache&&) = default;
+		~AssetCache() = default;
+
+		std::size_t Budget() const;
+		void SetBudget(std::size_t budget);
+		std::size_t Size() const;
+		AssetCacheStatistics Statistics() const;
+		void ResetStatistics();
+
+		// Records a hit or a miss and marks a found asset as most recently used
+		std::shared_ptr<RTTI> Find(const std::wstring& assetName);
+		bool Contains(const std::wstring& assetName) const;
+
+		void Insert(const std::wstring& assetName, const std::shared_ptr<RTTI>& asset, std::size_t size);
+		void Remove(const std::wstring& assetName);
+		void Clear();
+		std::size_t Trim();
+
+	private:
+		struct Entry final
+		{
+			std::wstring Name;
+			std::shared_ptr<RTTI> Asset;
+			std::size_t Size;
+		};
+
+		using EntryList = std::list<Entry>;
+
+		EntryList mEntries;
+		std::unordered_map<std::wstring, EntryList::iterator> mLookup;
+		std::size_t mBudget;
+		std::size_t mSize{ 0 };
+		std::uint64_t mHits{ 0 };
+		std::uint64_t mMisses{ 0 };
+		std::uint64_t mEvictions{ 0 };
+		std::uint64_t mEvictedBytes{ 0 };
+	};
+}
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "pch.h"
+#include "BakedAnimationCache.h"
+#include "Model.h"
+#include "AnimationClip.h"
+#include "SceneNode.h"
+#include "Skeleton.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+#pragma region BakedAnimationClip
+
+	BakedAnimationClip::BakedAnimationClip(const Model& model, const AnimationClip& clip, float framesPerSecond) :
+		mFrameCount(FrameCount(clip, framesPerSecond)), mBoneCount(narrow_cast<uint32_t>(model.Bones().size())),
+		mTicksPerFrame(clip.Duration() / (mFrameCount - 1))
+	{
+		const Skeleton& skeleton = model.GetSkeleton();
+		mPalettes.resize(static_cast<size_t>(mFrameCount) * mBoneCount);
+
+		XMMATRIX inverseRootTransform = XMMatrixIdentity();
+		if (model.RootNode() != nullptr)
+		{
+			XMVECTOR determinant = XMMatrixDeterminant(model.RootNode()->TransformMatrix());
+			inverseRootTransform = XMMatrixInverse(&determinant, model.RootNode()->TransformMatrix());
+		}
+
+		vector<XMFLOAT4X4> boneTransforms(mBoneCount);
+		vector<XMFLOAT4X4> toRootTransforms(skeleton.NodeCount());
+		vector<uint32_t> keyframeCursors;
+		for (uint32_t frame = 0; frame < mFrameCount; ++frame)
+		{
+			clip.SampleAll(frame * mTicksPerFrame, boneTransforms, keyframeCursors);
+			skeleton.ComposePose(boneTransforms, inverseRootTransform, toRootTransforms, span<XMFLOAT4X4>(&mPalettes[static_cast<size_t>(frame) * mBoneCount], mBoneCount));
+		}
+	}
+
+	uint32_t BakedAnimationClip::FrameCount() const
+	{
+		return mFrameCount;
+	}
+
+	uint32_t BakedAnimationClip::BoneCount() const
+	{
+		return mBoneCount;
+	}
+
+	size_t BakedAnimationClip::Size() const
+	{
+		return mPalettes.size() * sizeof(XMFLOAT4X4);
+	}
+
+	void BakedAnimationClip::GetPalette(float time, span<XMFLOAT4X4> palette, bool interpolate) const
+	{
+		assert(static_cast<uint32_t>(palette.size()) >= mBoneCount);
+
+		const float position = (mTicksPerFrame > 0.0f ? clamp(time / mTicksPerFrame, 0.0f, static_cast<float>(mFrameCount - 1)) : 0.0f);
+		if (interpolate == false)
+		{
+			const auto frame = mPalettes.begin() + static_cast<size_t>(lround(position)) * mBoneCount;
+			copy(frame, frame + mBoneCount, palette.begin());
+			return;
+		}
+
+		// Blending the matrices is close enough to blending the poses at the rates clips are baked at
+		const uint32_t frameOne = min(static_cast<uint32_t>(position), mFrameCount - 2);
+		const float lerpValue = position - frameOne;
+		const XMFLOAT4X4* paletteOne = &mPalettes[static_cast<size_t>(frameOne) * mBoneCount];
+		const XMFLOAT4X4* paletteTwo = paletteOne + mBoneCount;
+
+		for (uint32_t bone = 0; bone < mBoneCount; ++bone)
+		{
+			const XMMATRIX transformOne = XMLoadFloat4x4(&paletteOne[bone]);
+			const XMMATRIX transformTwo = XMLoadFloat4x4(&paletteTwo[bone]);
+
+			XMMATRIX transform;
+			for (int row = 0; row < 4; ++row)
+			{
+				transform.r[row] = XMVectorLerp(transformOne.r[row], transformTwo.r[row], lerpValue);
+			}
+
+			XMStoreFloat4x4(&palette[bone], transform);
+		}
+	}
+
+	uint32_t BakedAnimationClip::FrameCount(const AnimationClip& clip, float framesPerSecond)
+	{
+		// Clips without a tick rate are treated as authored in seconds; every clip gets at least its first and last frame
+		const float ticksPerSecond = (clip.TicksPerSecond() > 0.0f ? clip.TicksPerSecond() : 1.0f);
+		const float durationSeconds = clip.Duration() / ticksPerSecond;
+
+		return max(static_cast<uint32_t>(ceil(durationSeconds * framesPerSecond)) + 1, 2U);
+	}
+
+	size_t BakedAnimationClip::Size(const Model& model, const AnimationClip& clip, float framesPerSecond)
+	{
+		return static_cast<size_t>(FrameCount(clip, framesPerSecond)) * model.Bones().size() * sizeof(XMFLOAT4X4);
+	}
+
+#pragma endregion
+
+#pragma region BakedAnimationCache
+
+	const size_t BakedAnimationCache::UnlimitedBudget = numeric_limits<size_t>::max();
+
+	BakedAnimationCache::BakedAnimationCache(shared_ptr<Model> model, float framesPerSecond, size_t budget) :
+		mModel(move(model)), mFramesPerSecond(framesPerSecond), mBudget(budget)
+	{
+		assert(mModel != nullptr);
+	}
+
+	const shared_ptr<Model>& BakedAnimationCache::GetModel() const
+	{
+		return mModel;
+	}
+
+	float BakedAnimationCache::FramesPerSecond() const
+	{
+		return mFramesPerSecond;
+	}
+
+	size_t BakedAnimationCache::Budget() const
+	{
+		lock_guard<mutex> lock(mMutex);
+		return mBudget;
+	}
+
+	void BakedAnimationCache::SetBudget(size_t budget)
+	{
+		lock_guard<mutex> lock(mMutex);
+		mBudget = budget;
+		Evict(mBudget);
+	}
+
+	size_t BakedAnimationCache::Size() const
+	{
+		lock_guard<mutex> lock(mMutex);
+		return mSize;
+	}
+
+	shared_ptr<const BakedAnimationClip> BakedAnimationCache::Find(const AnimationClip& clip)
+	{
+		// Players running as parallel jobs share the cache, so baking happens under the lock
+		lock_guard<mutex> lock(mMutex);
+
+		auto it = mLookup.find(&clip);
+		if (it != mLookup.end())
+		{
+			mEntries.splice(mEntries.begin(), mEntries, it->second);
+			return it->second->BakedClip;
+		}
+
+		const size_t size = BakedAnimationClip::Size(*mModel, clip, mFramesPerSecond);
+		if (size > mBudget)
+		{
+			return nullptr;
+		}
+
+		// Only evict once it's known to make room, so a clip that can't be baked doesn't cost the cache its other clips
+		size_t evictableSize = 0;
+		for (const Entry& entry : mEntries)
+		{
+			if (entry.BakedClip.use_count() == 1)
+			{
+				evictableSize += entry.Size;
+			}
+		}
+
+		if (mSize - evictableSize > mBudget - size)
+		{
+			return nullptr;
+		}
+
+		Evict(mBudget - size);
+
+		auto bakedClip = make_shared<const BakedAnimationClip>(*mModel, clip, mFramesPerSecond);
+		mEntries.push_front(Entry{ &clip, bakedClip, size });
+		mLookup.emplace(&clip, mEntries.begin());
+		mSize += size;
+
+		return bakedClip;
+	}
+
+	void BakedAnimationCache::Clear()
+	{
+		lock_guard<mutex> lock(mMutex);
+		mEntries.clear();
+		mLookup.clear();
+		mSize = 0;
+	}
+
+	size_t BakedAnimationCache::Trim()
+	{
+		lock_guard<mutex> lock(mMutex);
+		return Evict(mBudget);
+	}
+
+	size_t BakedAnimationCache::Evict(size_t targetSize)
+	{
+		size_t evictions = 0;
+
+		// Walk from the least recently used end, skipping clips a player still holds
+		for (auto it = mEntries.end(); mSize > targetSize && it != mEntries.begin();)
+		{
+			--it;
+			if (it->BakedClip.use_count() == 1)
+			{
+				mSize -= it->Size;
+				mLookup.erase(it->Clip);
+				it = mEntries.erase(it);
+				++evictions;
+			}
+		}
+
+		return evictions;
+	}
+
+#pragma endregion
+}
\ No newline at end of file
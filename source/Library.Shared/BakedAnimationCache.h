@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class Model;
+	class AnimationClip;
+
+	// A clip's skinning transforms precomputed at a fixed rate, so playback is a lookup and a blend between two frames
+	class BakedAnimationClip final
+	{
+	public:
+		BakedAnimationClip(const Model& model, const AnimationClip& clip, float framesPerSecond);
+		BakedAnimationClip(const BakedAnimationClip&) = default;
+		BakedAnimationClip(BakedAnimationClip&&) = default;
+		BakedAnimationClip& operator=(const BakedAnimationClip&) = default;
+		BakedAnimationClip& operator=(BakedAnimationClip&&) = default;
+		~BakedAnimationClip() = default;
+
+		std::uint32_t FrameCount() const;
+		std::uint32_t BoneCount() const;
+		std::size_t Size() const;
+
+		// time is in the clip's ticks, as AnimationPlayer tracks it; without interpolation the nearest frame is used
+		void GetPalette(float time, gsl::span<DirectX::XMFLOAT4X4> palette, bool interpolate = true) const;
+
+		static std::uint32_t FrameCount(const AnimationClip& clip, float framesPerSecond);
+		static std::size_t Size(const Model& model, const AnimationClip& clip, float framesPerSecond);
+
+	private:
+		std::vector<DirectX::XMFLOAT4X4> mPalettes;		// Frame-major, each frame a full palette by bone index
+		std::uint32_t mFrameCount;
+		std::uint32_t mBoneCount;
+		float mTicksPerFrame;
+	};
+
+	// Baked clips of one model, shared by every player of that model. Clips are baked on first request and evicted least
+	// recently used first, though only once no player holds them. A clip that can't fit within the budget isn't baked.
+	class BakedAnimationCache final
+	{
+	public:
+		static const std::size_t UnlimitedBudget;
+		inline static const float DefaultFramesPerSecond = 30.0f;
+
+		explicit BakedAnimationCache(std::shared_ptr<Model> model, float framesPerSecond = DefaultFramesPerSecond, std::size_t budget = UnlimitedBudget);
+		BakedAnimationCache(const BakedAnimationCache&) = delete;
+		BakedAnimationCache& operator=(const BakedAnimationCache&) = delete;
+		BakedAnimationCache(BakedAnimationCache&&) = delete;
+		BakedAnimationCache& operator=(BakedAnimationCache&&) = delete;
+		~BakedAnimationCache() = default;
+
+		const std::shared_ptr<Model>& GetModel() const;
+		float FramesPerSecond() const;
+		std::size_t Budget() const;
+		void SetBudget(std::size_t budget);
+		std::size_t Size() const;
+
+		// Returns nullptr when the clip doesn't fit, so the caller evaluates it live
+		std::shared_ptr<const BakedAnimationClip> Find(const AnimationClip& clip);
+		void Clear();
+		std::size_t Trim();
+
+	private:
+		struct Entry final
+		{
+			const AnimationClip* Clip;
+			std::shared_ptr<const BakedAnimationClip> BakedClip;
+			std::size_t Size;
+		};
+
+		using EntryList = std::list<Entry>;
+
+		std::size_t Evict(std::size_t targetSize);
+
+		std::shared_ptr<Model> mModel;
+		float mFramesPerSecond;
+		EntryList mEntries;
+		std::unordered_map<const AnimationClip*, EntryList::iterator> mLookup;
+		std::size_t mBudget;
+		std::size_t mSize{ 0 };
+		mutable std::mutex mMutex;
+	};
+}
\ No newline at end of file
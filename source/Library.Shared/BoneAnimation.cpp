@@ -2,8 +2,9 @@
 #include "BoneAnimation.h"
 #include "Model.h"
 #include "Bone.h"
-#include "Keyframe.h"
 #include "StreamHelper.h"
+#include "ModelFile.h"
+#include "KeyframeCompression.h"
 #include "VectorHelper.h"
 
 using namespace std;
@@ -12,10 +13,10 @@ using namespace DirectX;
 
 namespace Library
 {
-	BoneAnimation::BoneAnimation(Model& model, InputStreamHelper& streamHelper) :
+	BoneAnimation::BoneAnimation(Model& model, InputStreamHelper& streamHelper, const ModelFileReader* fileReader, const ModelFileCompressedTrack* compressedTrack) :
 		mModel(&model)
 	{
-		Load(streamHelper);
+		Load(streamHelper, fileReader, compressedTrack);
 	}
 
 	BoneAnimation::BoneAnimation(Model& model, const BoneAnimationData& boneAnimationData) :
@@ -37,16 +38,21 @@ namespace Library
 		return *bone;
 	}
 	
-	vector<shared_ptr<Keyframe>>& BoneAnimation::Keyframes()
+	const KeyframeTrack& BoneAnimation::Keyframes() const
 	{
 		return mKeyframes;
 	}
 
 	uint32_t BoneAnimation::GetTransform(float time, XMFLOAT4X4& transform) const
 	{
-		uint32_t keyframeIndex = FindKeyframeIndex(time);
-		const shared_ptr<Keyframe>& keyframe = mKeyframes[keyframeIndex];
-		XMStoreFloat4x4(&transform, keyframe->Transform());
+		uint32_t cursor = 0;
+		return GetTransform(time, transform, cursor);
+	}
+
+	uint32_t BoneAnimation::GetTransform(float time, XMFLOAT4X4& transform, uint32_t& cursor) const
+	{
+		uint32_t keyframeIndex = FindKeyframeIndex(time, cursor);
+		XMStoreFloat4x4(&transform, mKeyframes.Transform(keyframeIndex));
 
 		return keyframeIndex;
 	}
@@ -54,68 +60,80 @@ namespace Library
 	void BoneAnimation::GetTransformAtKeyframe(uint32_t keyframeIndex, XMFLOAT4X4& transform) const
 	{
 		// Clamp the keyframe
-		if (keyframeIndex >= mKeyframes.size())
+		if (keyframeIndex >= mKeyframes.Size())
 		{
-			keyframeIndex = narrow_cast<uint32_t>(mKeyframes.size() - 1);
+			keyframeIndex = mKeyframes.Size() - 1;
 		}
 		
-		const shared_ptr<Keyframe>& keyframe = mKeyframes[keyframeIndex];
-		XMStoreFloat4x4(&transform, keyframe->Transform());
+		XMStoreFloat4x4(&transform, mKeyframes.Transform(keyframeIndex));
 	}
 
 	void BoneAnimation::GetInteropolatedTransform(float time, XMFLOAT4X4& transform) const
 	{
-		const shared_ptr<Keyframe>& firstKeyframe = mKeyframes.front();
-		const shared_ptr<Keyframe>& lastKeyframe = mKeyframes.back();
+		uint32_t cursor = 0;
+		GetInteropolatedTransform(time, transform, cursor);
+	}
 
-		if (time <= firstKeyframe->Time())
-		{
-			// Specified time is before the start time of the animation, so return the first keyframe
-			XMStoreFloat4x4(&transform, firstKeyframe->Transform());
-		}
-		else if (time >= lastKeyframe->Time())
-		{
-			// Specified time is after the end time of the animation, so return the last keyframe
-			XMStoreFloat4x4(&transform, lastKeyframe->Transform());
-		}
-		else
-		{
-			// Interpolate the transform between keyframes
-			const uint32_t keyframeIndex = FindKeyframeIndex(time);
-			const shared_ptr<Keyframe>& keyframeOne = mKeyframes[keyframeIndex];
-			const shared_ptr<Keyframe>& keyframeTwo = mKeyframes[keyframeIndex + 1];
-
-			const XMVECTOR translationOne = keyframeOne->TranslationVector();
-			const XMVECTOR rotationQuaternionOne = keyframeOne->RotationQuaternionVector();
-			const XMVECTOR scaleOne = keyframeOne->ScaleVector();
-			
-			const XMVECTOR translationTwo = keyframeTwo->TranslationVector();
-			const XMVECTOR rotationQuaternionTwo = keyframeTwo->RotationQuaternionVector();
-			const XMVECTOR scaleTwo = keyframeTwo->ScaleVector();
-
-			float lerpValue = ((time - keyframeOne->Time()) / (keyframeTwo->Time() - keyframeOne->Time()));
-			const XMVECTOR translation = XMVectorLerp(translationOne, translationTwo, lerpValue);
-			const XMVECTOR rotationQuaternion = XMQuaternionSlerp(rotationQuaternionOne, rotationQuaternionTwo, lerpValue);
-			const XMVECTOR scale = XMVectorLerp(scaleOne, scaleTwo, lerpValue);
-
-			const XMVECTOR rotationOrigin = XMLoadFloat4(&Vector4Helper::Zero);
-			XMStoreFloat4x4(&transform, XMMatrixAffineTransformation(scale, rotationOrigin, rotationQuaternion, translation));
-		}
+	void BoneAnimation::GetInteropolatedTransform(float time, XMFLOAT4X4& transform, uint32_t& cursor) const
+	{
+		XMVECTOR translation;
+		XMVECTOR rotationQuaternion;
+		XMVECTOR scale;
+		Interpolate(time, cursor, translation, rotationQuaternion, scale);
+
+		const XMVECTOR rotationOrigin = XMLoadFloat4(&Vector4Helper::Zero);
+		XMStoreFloat4x4(&transform, XMMatrixAffineTransformation(scale, rotationOrigin, rotationQuaternion, translation));
+	}
+
+	uint32_t BoneAnimation::GetComponents(float time, XMFLOAT3& translation, XMFLOAT4& rotationQuaternion, XMFLOAT3& scale, uint32_t& cursor) const
+	{
+		uint32_t keyframeIndex = FindKeyframeIndex(time, cursor);
+		translation = mKeyframes.Translations[keyframeIndex];
+		rotationQuaternion = mKeyframes.RotationQuaternions[keyframeIndex];
+		scale = mKeyframes.Scales[keyframeIndex];
+
+		return keyframeIndex;
 	}
 
-	void BoneAnimation::Save(OutputStreamHelper& streamHelper)
+	void BoneAnimation::GetInterpolatedComponents(float time, XMFLOAT3& translation, XMFLOAT4& rotationQuaternion, XMFLOAT3& scale, uint32_t& cursor) const
+	{
+		XMVECTOR translationVector;
+		XMVECTOR rotationQuaternionVector;
+		XMVECTOR scaleVector;
+		Interpolate(time, cursor, translationVector, rotationQuaternionVector, scaleVector);
+
+		XMStoreFloat3(&translation, translationVector);
+		XMStoreFloat4(&rotationQuaternion, rotationQuaternionVector);
+		XMStoreFloat3(&scale, scaleVector);
+	}
+
+	void BoneAnimation::Save(OutputStreamHelper& streamHelper, ModelFileWriter* fileWriter, ModelFileCompressedTrack* compressedTrack)
 	{
 		Bone& bone = GetBone();
 		streamHelper << bone.Name();
 
-		streamHelper << narrow_cast<uint32_t>(mKeyframes.size());
-		for (auto& keyframe: mKeyframes)
+		// Compressed tracks are encoded straight from the arrays; the other layouts store interleaved KeyframeData
+		if (fileWriter != nullptr)
+		{
+			ModelFileRange range{ 0, 0 };
+			if (compressedTrack != nullptr)
+			{
+				KeyframeCompression::Encode(mKeyframes, *fileWriter, *compressedTrack);
+			}
+			else
+			{
+				range = fileWriter->Append(ModelFileSection::Keyframes, mKeyframes.Data());
+			}
+
+			streamHelper << range.Offset << range.Count;
+		}
+		else
 		{
-			keyframe->Save(streamHelper);
+			streamHelper.WriteArray(mKeyframes.Data());
 		}
 	}
 
-	void BoneAnimation::Load(InputStreamHelper& streamHelper)
+	void BoneAnimation::Load(InputStreamHelper& streamHelper, const ModelFileReader* fileReader, const ModelFileCompressedTrack* compressedTrack)
 	{
 		// Deserialize the referenced bone
 		string name;
@@ -124,33 +142,99 @@ namespace Library
 		mBone = mModel->Bones().at(boneIndex);
 
 		// Deserialize the keyframes
-		uint32_t keyframeCount;
-		streamHelper >> keyframeCount;
-		mKeyframes.reserve(keyframeCount);
-		for (uint32_t i = 0; i < keyframeCount; i++)
+		if (fileReader != nullptr)
 		{
-			mKeyframes.push_back(make_shared<Keyframe>(streamHelper));
+			ModelFileRange range;
+			streamHelper >> range.Offset >> range.Count;
+			if (compressedTrack != nullptr)
+			{
+				KeyframeCompression::Decode(*fileReader, *compressedTrack, mKeyframes);
+			}
+			else
+			{
+				mKeyframes.Assign(fileReader->Get<KeyframeData>(ModelFileSection::Keyframes, range));
+			}
+		}
+		else
+		{
+			vector<KeyframeData> keyframes;
+			streamHelper.ReadArray(keyframes);
+			mKeyframes.Assign(keyframes);
 		}
 	}
 
 	uint32_t BoneAnimation::FindKeyframeIndex(float time) const
 	{
-		const shared_ptr<Keyframe>& firstKeyframe = mKeyframes.front();
-		if (time <= firstKeyframe->Time())
+		const vector<float>& times = mKeyframes.Times;
+		if (time <= times.front())
 		{
 			return 0;
 		}
 
-		const shared_ptr<Keyframe>& lastKeyframe = mKeyframes.back();
-		if (time >= lastKeyframe->Time())
+		if (time >= times.back())
+		{
+			return narrow_cast<uint32_t>(times.size() - 1);
+		}
+
+		// The keyframe before the first one that starts after time; the last keyframe is excluded as it was handled above
+		const auto next = upper_bound(times.begin() + 1, times.end() - 1, time);
+
+		return narrow_cast<uint32_t>(distance(times.begin(), next) - 1);
+	}
+
+	uint32_t BoneAnimation::FindKeyframeIndex(float time, uint32_t& cursor) const
+	{
+		// Playback mostly samples within the cursor's span or the one after it; seeks and loops fall back to the search
+		const vector<float>& times = mKeyframes.Times;
+		const size_t lastIndex = times.size() - 1;
+		if (cursor < lastIndex && time >= times[cursor])
 		{
-			return narrow_cast<uint32_t>(mKeyframes.size() - 1);
+			if (time < times[cursor + 1])
+			{
+				return cursor;
+			}
+
+			if (cursor + 1 < lastIndex && time < times[cursor + 2])
+			{
+				return ++cursor;
+			}
 		}
 
-		uint32_t keyframeIndex = 1;
+		cursor = FindKeyframeIndex(time);
 
-		for (; keyframeIndex < mKeyframes.size() - 1 && time >= mKeyframes[keyframeIndex]->Time(); keyframeIndex++);
+		return cursor;
+	}
 
-		return keyframeIndex - 1;
+	void BoneAnimation::Interpolate(float time, uint32_t& cursor, XMVECTOR& translation, XMVECTOR& rotationQuaternion, XMVECTOR& scale) const
+	{
+		// Times before the start or after the end of the animation clamp to the first or last keyframe
+		uint32_t keyframeOne;
+		float lerpValue = 0.0f;
+		if (time <= mKeyframes.Times.front())
+		{
+			keyframeOne = 0;
+		}
+		else if (time >= mKeyframes.Times.back())
+		{
+			keyframeOne = mKeyframes.Size() - 1;
+		}
+		else
+		{
+			keyframeOne = FindKeyframeIndex(time, cursor);
+			const float timeOne = mKeyframes.Times[keyframeOne];
+			lerpValue = ((time - timeOne) / (mKeyframes.Times[keyframeOne + 1] - timeOne));
+		}
+
+		translation = XMLoadFloat3(&mKeyframes.Translations[keyframeOne]);
+		rotationQuaternion = XMLoadFloat4(&mKeyframes.RotationQuaternions[keyframeOne]);
+		scale = XMLoadFloat3(&mKeyframes.Scales[keyframeOne]);
+
+		if (lerpValue > 0.0f)
+		{
+			const uint32_t keyframeTwo = keyframeOne + 1;
+			translation = XMVectorLerp(translation, XMLoadFloat3(&mKeyframes.Translations[keyframeTwo]), lerpValue);
+			rotationQuaternion = XMQuaternionSlerp(rotationQuaternion, XMLoadFloat4(&mKeyframes.RotationQuaternions[keyframeTwo]), lerpValue);
+			scale = XMVectorLerp(scale, XMLoadFloat3(&mKeyframes.Scales[keyframeTwo]), lerpValue);
+		}
 	}
 }
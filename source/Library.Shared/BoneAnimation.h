@@ -6,25 +6,28 @@
 #include <memory>
 #include <string>
 #include <cstdint>
+#include "Keyframe.h"
 
 namespace Library
 {
 	class Model;
 	class Bone;
-	class Keyframe;
 	class OutputStreamHelper;
 	class InputStreamHelper;
+	class ModelFileWriter;
+	class ModelFileReader;
+	struct ModelFileCompressedTrack;
 
 	struct BoneAnimationData final
 	{
 		std::uint32_t BoneIndex{ 0 };
-		std::vector<std::shared_ptr<Keyframe>> Keyframes;
+		KeyframeTrack Keyframes;
 	};
 
     class BoneAnimation final
     {
     public:
-		BoneAnimation(Model& model, InputStreamHelper& streamHelper);
+		BoneAnimation(Model& model, InputStreamHelper& streamHelper, const ModelFileReader* fileReader = nullptr, const ModelFileCompressedTrack* compressedTrack = nullptr);
 		BoneAnimation(Model& model, const BoneAnimationData& boneAnimationData);
 		BoneAnimation(Model& model, BoneAnimationData&& boneAnimationData);
 		BoneAnimation(const BoneAnimation&) = default;
@@ -34,20 +37,31 @@ namespace Library
 		~BoneAnimation() = default;
 
 		Bone& GetBone();
-		std::vector<std::shared_ptr<Keyframe>>& Keyframes();
+		const KeyframeTrack& Keyframes() const;
 
 		std::uint32_t GetTransform(float time, DirectX::XMFLOAT4X4& transform) const;
 		void GetTransformAtKeyframe(std::uint32_t keyframeIndex, DirectX::XMFLOAT4X4& transform) const;
 		void GetInteropolatedTransform(float time, DirectX::XMFLOAT4X4& transform) const;
 
-		void Save(OutputStreamHelper& streamHelper);
+		// cursor is the caller's keyframe index from the previous sample of this track (0 to start), and is updated
+		std::uint32_t GetTransform(float time, DirectX::XMFLOAT4X4& transform, std::uint32_t& cursor) const;
+		void GetInteropolatedTransform(float time, DirectX::XMFLOAT4X4& transform, std::uint32_t& cursor) const;
+
+		// The local transform as its components, for blending poses before they become matrices
+		std::uint32_t GetComponents(float time, DirectX::XMFLOAT3& translation, DirectX::XMFLOAT4& rotationQuaternion, DirectX::XMFLOAT3& scale, std::uint32_t& cursor) const;
+		void GetInterpolatedComponents(float time, DirectX::XMFLOAT3& translation, DirectX::XMFLOAT4& rotationQuaternion, DirectX::XMFLOAT3& scale, std::uint32_t& cursor) const;
+
+		// With compressedTrack, keyframes are written through KeyframeCompression and recorded there instead
+		void Save(OutputStreamHelper& streamHelper, ModelFileWriter* fileWriter = nullptr, ModelFileCompressedTrack* compressedTrack = nullptr);
 
     private:
-		void Load(InputStreamHelper& streamHelper);
+		void Load(InputStreamHelper& streamHelper, const ModelFileReader* fileReader, const ModelFileCompressedTrack* compressedTrack);
 		std::uint32_t FindKeyframeIndex(float time) const;
+		std::uint32_t FindKeyframeIndex(float time, std::uint32_t& cursor) const;
+		void Interpolate(float time, std::uint32_t& cursor, DirectX::XMVECTOR& translation, DirectX::XMVECTOR& rotationQuaternion, DirectX::XMVECTOR& scale) const;
 
 		Model* mModel;
 		std::weak_ptr<Bone> mBone;
-		std::vector<std::shared_ptr<Keyframe>> mKeyframes;
+		KeyframeTrack mKeyframes;
     };
 }
@@ -5,6 +5,7 @@
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 using namespace DirectX;
 using namespace winrt;
 
@@ -19,10 +20,16 @@ namespace Library
 
 	shared_ptr<ComputeShader> ComputeShaderReader::_Read(const wstring& assetName)
 	{
-		com_ptr<ID3D11ComputeShader> hullShader;
 		vector<char> compiledComputeShader;
 		Utility::LoadBinaryFile(assetName, compiledComputeShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreateComputeShader(&compiledComputeShader[0], compiledComputeShader.size(), nullptr, hullShader.put()), "ID3D11Device::CreatedComputeShader() failed.");
+
+		return _Read(assetName, span<const uint8_t>(reinterpret_cast<const uint8_t*>(compiledComputeShader.data()), compiledComputeShader.size()), nullptr);
+	}
+
+	shared_ptr<ComputeShader> ComputeShaderReader::_Read(const wstring&, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11ComputeShader> hullShader;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateComputeShader(data.data(), data.size_bytes(), nullptr, hullShader.put()), "ID3D11Device::CreatedComputeShader() failed.");
 		
 		return shared_ptr<ComputeShader>(new ComputeShader(move(hullShader)));
 	}
@@ -0,0 +1,276 @@
+#include "pch.h"
+#include "ContentArchive.h"
+#include "MemoryMappedFile.h"
+#include "GameException.h"
+#include "Utility.h"
+#include <compressapi.h>
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	namespace
+	{
+		const uint64_t FnvOffsetBasis = 14695981039346656037ULL;
+		const uint64_t FnvPrime = 1099511628211ULL;
+
+		struct CompressorHandle final
+		{
+			COMPRESSOR_HANDLE Handle{ nullptr };
+			~CompressorHandle() { if (Handle != nullptr) CloseCompressor(Handle); }
+		};
+
+		struct DecompressorHandle final
+		{
+			DECOMPRESSOR_HANDLE Handle{ nullptr };
+			~DecompressorHandle() { if (Handle != nullptr) CloseDecompressor(Handle); }
+		};
+
+		uint64_t AlignOffset(uint64_t offset, uint32_t alignment)
+		{
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		vector<uint8_t> Compress(span<const uint8_t> data)
+		{
+			CompressorHandle compressor;
+			if (CreateCompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &compressor.Handle) == FALSE)
+			{
+				throw GameException("CreateCompressor() failed.", HRESULT_FROM_WIN32(GetLastError()));
+			}
+
+			SIZE_T compressedSize = 0;
+			if (::Compress(compressor.Handle, data.data(), data.size_bytes(), nullptr, 0, &compressedSize) == FALSE && GetLastError() != ERROR_INSUFFICIENT_BUFFER)
+			{
+				throw GameException("Compress() failed.", HRESULT_FROM_WIN32(GetLastError()));
+			}
+
+			vector<uint8_t> compressed(compressedSize);
+			if (::Compress(compressor.Handle, data.data(), data.size_bytes(), compressed.data(), compressed.size(), &compressedSize) == FALSE)
+			{
+				throw GameException("Compress() failed.", HRESULT_FROM_WIN32(GetLastError()));
+			}
+
+			compressed.resize(compressedSize);
+			return compressed;
+		}
+	}
+
+	ContentArchive::ContentArchive(const wstring& filename) :
+		mFilename(filename), mFile(make_shared<MemoryMappedFile>(Utility::ToString(filename))), mData(mFile->Data())
+	{
+		if (static_cast<size_t>(mData.size()) < sizeof(ContentArchiveHeader))
+		{
+			throw GameException("Content archive is truncated.");
+		}
+
+		const auto& header = *reinterpret_cast<const ContentArchiveHeader*>(mData.data());
+		if (header.Magic != ContentArchiveMagic || header.Version != ContentArchiveVersion)
+		{
+			throw GameException("Unsupported content archive.");
+		}
+
+		const auto index = Range(header.IndexOffset, uint64_t(header.EntryCount) * sizeof(ContentArchiveEntry));
+		if (reinterpret_cast<uintptr_t>(index.data()) % alignof(ContentArchiveEntry) != 0)
+		{
+			throw GameException("Content archive index is misaligned.");
+		}
+
+		mEntries = span<const ContentArchiveEntry>(reinterpret_cast<const ContentArchiveEntry*>(index.data()), header.EntryCount);
+
+		const auto paths = Range(header.PathsOffset, static_cast<uint64_t>(mData.size()) - header.PathsOffset);
+		mPaths = span<const wchar_t>(reinterpret_cast<const wchar_t*>(paths.data()), static_cast<size_t>(paths.size()) / sizeof(wchar_t));
+
+		for (const ContentArchiveEntry& entry : mEntries)
+		{
+			if (uint64_t(entry.PathOffset) + entry.PathLength > static_cast<uint64_t>(mPaths.size()))
+			{
+				throw GameException("Content archive path is out of range.");
+			}
+
+			Range(entry.Offset, entry.StoredSize);
+		}
+	}
+
+	const wstring& ContentArchive::Filename() const
+	{
+		return mFilename;
+	}
+
+	uint32_t ContentArchive::EntryCount() const
+	{
+		return static_cast<uint32_t>(mEntries.size());
+	}
+
+	const ContentArchiveEntry* ContentArchive::Find(const wstring& path) const
+	{
+		const wstring normalizedPath = NormalizePath(path);
+		const uint64_t hash = HashPath(normalizedPath);
+
+		auto it = lower_bound(mEntries.begin(), mEntries.end(), hash, [](const ContentArchiveEntry& entry, uint64_t value) { return entry.PathHash < value; });
+		for (; it != mEntries.end() && it->PathHash == hash; ++it)
+		{
+			if (EntryPath(*it) == normalizedPath)
+			{
+				return &(*it);
+			}
+		}
+
+		return nullptr;
+	}
+
+	wstring ContentArchive::EntryPath(const ContentArchiveEntry& entry) const
+	{
+		return wstring(mPaths.data() + entry.PathOffset, entry.PathLength);
+	}
+
+	span<const uint8_t> ContentArchive::Read(const ContentArchiveEntry& entry, shared_ptr<const void>& owner) const
+	{
+		const auto stored = Range(entry.Offset, entry.StoredSize);
+		if (entry.Compression == ContentArchiveCompression::None)
+		{
+			owner = mFile;
+			return stored;
+		}
+
+		DecompressorHandle decompressor;
+		if (CreateDecompressor(COMPRESS_ALGORITHM_XPRESS_HUFF, nullptr, &decompressor.Handle) == FALSE)
+		{
+			throw GameException("CreateDecompressor() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		auto buffer = make_shared<vector<uint8_t>>(narrow<size_t>(entry.Size));
+		SIZE_T decompressedSize = 0;
+		if (Decompress(decompressor.Handle, stored.data(), stored.size_bytes(), buffer->data(), buffer->size(), &decompressedSize) == FALSE || decompressedSize != buffer->size())
+		{
+			throw GameException("Decompress() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		owner = buffer;
+		return span<const uint8_t>(*buffer);
+	}
+
+	wstring ContentArchive::NormalizePath(const wstring& path)
+	{
+		wstring normalizedPath(path);
+		for (auto& character : normalizedPath)
+		{
+			character = (character == L'/' ? L'\\' : static_cast<wchar_t>(towlower(character)));
+		}
+
+		return normalizedPath;
+	}
+
+	uint64_t ContentArchive::HashPath(const wstring& normalizedPath)
+	{
+		// FNV-1a over the UTF-16 code units
+		uint64_t hash = FnvOffsetBasis;
+		for (const wchar_t character : normalizedPath)
+		{
+			hash = (hash ^ static_cast<uint16_t>(character)) * FnvPrime;
+		}
+
+		return hash;
+	}
+
+	span<const uint8_t> ContentArchive::Range(uint64_t offset, uint64_t size) const
+	{
+		const uint64_t dataSize = static_cast<uint64_t>(mData.size());
+		if (offset > dataSize || size > dataSize - offset)
+		{
+			throw GameException("Content archive entry is out of range.");
+		}
+
+		return span<const uint8_t>(mData.data() + offset, static_cast<size_t>(size));
+	}
+
+	ContentArchiveWriter::ContentArchiveWriter(uint32_t alignment) :
+		mAlignment(max(alignment, static_cast<uint32_t>(alignof(ContentArchiveEntry))))
+	{
+	}
+
+	void ContentArchiveWriter::Add(const wstring& path, span<const uint8_t> data, bool compress)
+	{
+		PendingEntry pendingEntry{ ContentArchive::NormalizePath(path), ContentArchiveEntry{}, vector<uint8_t>() };
+		ContentArchiveEntry& entry = pendingEntry.Entry;
+		entry.PathHash = ContentArchive::HashPath(pendingEntry.Path);
+		entry.Size = static_cast<uint64_t>(data.size());
+		entry.Compression = ContentArchiveCompression::None;
+
+		if (compress && data.size() > 0)
+		{
+			// Keep the compressed form only when it saves at least an eighth
+			vector<uint8_t> compressed = Compress(data);
+			if (compressed.size() < static_cast<size_t>(data.size()) - static_cast<size_t>(data.size()) / 8)
+			{
+				pendingEntry.Data = move(compressed);
+				entry.Compression = ContentArchiveCompression::XpressHuffman;
+			}
+		}
+
+		if (entry.Compression == ContentArchiveCompression::None)
+		{
+			pendingEntry.Data.assign(data.begin(), data.end());
+		}
+
+		entry.StoredSize = pendingEntry.Data.size();
+		mEntries.push_back(move(pendingEntry));
+	}
+
+	void ContentArchiveWriter::Write(ostream& stream) const
+	{
+		vector<ContentArchiveEntry> index;
+		index.reserve(mEntries.size());
+		wstring paths;
+
+		uint64_t offset = AlignOffset(sizeof(ContentArchiveHeader), mAlignment);
+		for (const PendingEntry& pendingEntry : mEntries)
+		{
+			ContentArchiveEntry entry = pendingEntry.Entry;
+			entry.Offset = offset;
+			entry.PathOffset = narrow<uint32_t>(paths.size());
+			entry.PathLength = narrow<uint32_t>(pendingEntry.Path.size());
+			paths += pendingEntry.Path;
+			index.push_back(entry);
+
+			offset = AlignOffset(offset + entry.StoredSize, mAlignment);
+		}
+
+		sort(index.begin(), index.end(), [](const ContentArchiveEntry& lhs, const ContentArchiveEntry& rhs) { return lhs.PathHash < rhs.PathHash; });
+
+		ContentArchiveHeader header{};
+		header.Magic = ContentArchiveMagic;
+		header.Version = ContentArchiveVersion;
+		header.EntryCount = narrow<uint32_t>(index.size());
+		header.Alignment = mAlignment;
+		header.IndexOffset = offset;
+		header.PathsOffset = offset + index.size() * sizeof(ContentArchiveEntry);
+
+		const vector<char> padding(mAlignment, 0);
+		auto pad = [&stream, &padding](uint64_t position, uint64_t alignedPosition)
+		{
+			stream.write(padding.data(), static_cast<streamsize>(alignedPosition - position));
+		};
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		uint64_t position = sizeof(header);
+		for (size_t i = 0; i < mEntries.size(); ++i)
+		{
+			const auto& data = mEntries[i].Data;
+			const uint64_t entryOffset = AlignOffset(position, mAlignment);
+			pad(position, entryOffset);
+			stream.write(reinterpret_cast<const char*>(data.data()), static_cast<streamsize>(data.size()));
+			position = entryOffset + data.size();
+		}
+
+		pad(position, header.IndexOffset);
+		stream.write(reinterpret_cast<const char*>(index.data()), static_cast<streamsize>(index.size() * sizeof(ContentArchiveEntry)));
+		stream.write(reinterpret_cast<const char*>(paths.data()), static_cast<streamsize>(paths.size() * sizeof(wchar_t)));
+
+		if (stream.fail())
+		{
+			throw GameException("Could not write content archive.");
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <memory>
+#include <gsl\gsl>
+
+namespace Library
+{
+	class MemoryMappedFile;
+
+	// Layout: a ContentArchiveHeader, the entry data (each entry starting on an Alignment boundary), the ContentArchiveEntry index
+	// sorted by PathHash, and finally the UTF-16 path strings the index refers to. Paths are stored normalized (see NormalizePath).
+	enum class ContentArchiveCompression : std::uint32_t
+	{
+		None,
+		XpressHuffman
+	};
+
+	const std::uint32_t ContentArchiveMagic = 0x4B504E43; // "CNPK"
+	const std::uint32_t ContentArchiveVersion = 1;
+	const std::uint32_t ContentArchiveDefaultAlignment = 4096;
+
+	struct ContentArchiveHeader final
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t EntryCount;
+		std::uint32_t Alignment;
+		std::uint64_t IndexOffset;
+		std::uint64_t PathsOffset;
+	};
+
+	struct ContentArchiveEntry final
+	{
+		std::uint64_t PathHash;
+		std::uint64_t Offset;
+		std::uint64_t StoredSize;
+		std::uint64_t Size;
+		std::uint32_t PathOffset;
+		std::uint32_t PathLength;
+		ContentArchiveCompression Compression;
+		std::uint32_t Reserved;
+	};
+
+	class ContentArchive final
+	{
+	public:
+		explicit ContentArchive(const std::wstring& filename);
+		ContentArchive(const ContentArchive&) = delete;
+		ContentArchive& operator=(const ContentArchive&) = delete;
+		ContentArchive(ContentArchive&&) = default;
+		ContentArchive& operator=(ContentArchive&&) = default;
+		~ContentArchive() = default;
+
+		const std::wstring& Filename() const;
+		std::uint32_t EntryCount() const;
+
+		const ContentArchiveEntry* Find(const std::wstring& path) const;
+		std::wstring EntryPath(const ContentArchiveEntry& entry) const;
+
+		// Stored entries are returned in place and owned by the mapping; compressed entries are expanded into a new buffer.
+		// Either way, owner keeps the returned bytes alive.
+		gsl::span<const std::uint8_t> Read(const ContentArchiveEntry& entry, std::shared_ptr<const void>& owner) const;
+
+		static std::wstring NormalizePath(const std::wstring& path);
+		static std::uint64_t HashPath(const std::wstring& normalizedPath);
+
+	private:
+		gsl::span<const std::uint8_t> Range(std::uint64_t offset, std::uint64_t size) const;
+
+		std::wstring mFilename;
+		std::shared_ptr<MemoryMappedFile> mFile;
+		gsl::span<const std::uint8_t> mData;
+		gsl::span<const ContentArchiveEntry> mEntries;
+		gsl::span<const wchar_t> mPaths;
+	};
+
+	class ContentArchiveWriter final
+	{
+	public:
+		explicit ContentArchiveWriter(std::uint32_t alignment = ContentArchiveDefaultAlignment);
+		ContentArchiveWriter(const ContentArchiveWriter&) = delete;
+		ContentArchiveWriter& operator=(const ContentArchiveWriter&) = delete;
+		ContentArchiveWriter(ContentArchiveWriter&&) = default;
+		ContentArchiveWriter& operator=(ContentArchiveWriter&&) = default;
+		~ContentArchiveWriter() = default;
+
+		// Compressed entries are only kept compressed when that saves space
+		void Add(const std::wstring& path, gsl::span<const std::uint8_t> data, bool compress);
+		void Write(std::ostream& stream) const;
+
+	private:
+		struct PendingEntry final
+		{
+			std::wstring Path;
+			ContentArchiveEntry Entry;
+			std::vector<std::uint8_t> Data;
+		};
+
+		std::uint32_t mAlignment;
+		std::vector<PendingEntry> mEntries;
+	};
+}
\ No newline at end of file
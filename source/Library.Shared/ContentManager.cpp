@@ -1,8 +1,11 @@
 #include "pch.h"
 #include "ContentManager.h"
 #include "ContentTypeReaderManager.h"
+#include "ThreadPool.h"
+#include "ContentArchive.h"
 
 using namespace std;
+using namespace gsl;
 
 namespace Library
 {
@@ -13,22 +16,71 @@ namespace Library
 	{
 	}
 
-	void ContentManager::AddAsset(const wstring& assetName, const shared_ptr<RTTI>& asset)
+	ContentManager::~ContentManager()
 	{
-		mLoadedAssets[assetName] = asset;
+		WaitForPendingLoads();
+	}
+
+	void ContentManager::AddAsset(const wstring& assetName, const shared_ptr<RTTI>& asset, size_t assetSize)
+	{
+		lock_guard<mutex> lock(mMutex);
+		mCache.Insert(assetName, asset, assetSize);
 	}
 
 	void ContentManager::RemoveAsset(const wstring& assetName)
 	{
-		mLoadedAssets.erase(assetName);
+		lock_guard<mutex> lock(mMutex);
+		mCache.Remove(assetName);
 	}
 
 	void ContentManager::Clear()
 	{
-		mLoadedAssets.clear();
+		lock_guard<mutex> lock(mMutex);
+		mCache.Clear();
+	}
+
+	void ContentManager::WaitForPendingLoads()
+	{
+		// The pool drains its queue before joining, so every outstanding future is fulfilled. It's taken under the lock so
+		// LoadAsync can't enqueue onto it mid-destruction, but destroyed outside it because the loads themselves take the lock.
+		unique_ptr<ThreadPool> threadPool;
+		{
+			lock_guard<mutex> lock(mMutex);
+			threadPool = move(mThreadPool);
+		}
+	}
+
+	size_t ContentManager::MemoryBudget() const
+	{
+		lock_guard<mutex> lock(mMutex);
+		return mCache.Budget();
+	}
+
+	void ContentManager::SetMemoryBudget(size_t budget)
+	{
+		lock_guard<mutex> lock(mMutex);
+		mCache.SetBudget(budget);
+	}
+
+	AssetCacheStatistics ContentManager::CacheStatistics() const
+	{
+		lock_guard<mutex> lock(mMutex);
+		return mCache.Statistics();
+	}
+
+	void ContentManager::ResetCacheStatistics()
+	{
+		lock_guard<mutex> lock(mMutex);
+		mCache.ResetStatistics();
 	}
 
-	shared_ptr<RTTI> ContentManager::ReadAsset(const int64_t targetTypeId, const wstring& assetName)
+	size_t ContentManager::TrimCache()
+	{
+		lock_guard<mutex> lock(mMutex);
+		return mCache.Trim();
+	}
+
+	shared_ptr<RTTI> ContentManager::ReadAsset(const int64_t targetTypeId, const wstring& assetName, const wstring& pathName, size_t& assetSize)
 	{
 		const auto& contentTypeReaders = ContentTypeReaderManager::ContentTypeReaders();
 		auto it = contentTypeReaders.find(targetTypeId);
@@ -37,7 +89,118 @@ namespace Library
 			throw GameException("Content type reader not registered.");
 		}
 
+		// The most recently mounted archive wins; loose files are the fallback
+		vector<shared_ptr<const ContentArchive>> archives;
+		{
+			lock_guard<mutex> lock(mMutex);
+			archives = mArchives;
+		}
+
+		shared_ptr<const ContentArchive> archive;
+		const ContentArchiveEntry* entry = nullptr;
+		for (auto archiveIt = archives.rbegin(); archiveIt != archives.rend() && entry == nullptr; ++archiveIt)
+		{
+			archive = *archiveIt;
+			entry = archive->Find(assetName);
+		}
+
 		auto& reader = it->second;
-		return reader->Read(assetName);
+		unique_lock<mutex> serializedRead(mSerializedReadMutex, defer_lock);
+		if (reader->SupportsConcurrentReads() == false)
+		{
+			serializedRead.lock();
+		}
+
+		shared_ptr<RTTI> asset;
+		if (entry != nullptr)
+		{
+			shared_ptr<const void> owner;
+			const auto data = archive->Read(*entry, owner);
+			asset = reader->Read(pathName, data, owner);
+			assetSize = reader->AssetSize(pathName, *asset, narrow_cast<size_t>(entry->Size));
+		}
+		else
+		{
+			asset = reader->Read(pathName);
+			assetSize = reader->AssetSize(pathName, *asset, Utility::GetFileSize(pathName));
+		}
+
+		return asset;
+	}
+
+	void ContentManager::MountArchive(const wstring& filename)
+	{
+		MountArchive(make_shared<ContentArchive>(filename));
+	}
+
+	void ContentManager::MountArchive(const shared_ptr<const ContentArchive>& archive)
+	{
+		lock_guard<mutex> lock(mMutex);
+		mArchives.push_back(archive);
+	}
+
+	void ContentManager::UnmountArchives()
+	{
+		lock_guard<mutex> lock(mMutex);
+		mArchives.clear();
+	}
+
+	ContentManager::AssetFuture ContentManager::LoadAsync(const uint64_t targetTypeId, const wstring& assetName, bool reload)
+	{
+		lock_guard<mutex> lock(mMutex);
+
+		// A load already in flight will produce a fresh copy, so it also satisfies a reload
+		auto pending = mPendingAssets.find(assetName);
+		if (pending != mPendingAssets.end())
+		{
+			return pending->second;
+		}
+
+		if (reload == false)
+		{
+			auto loadedAsset = mCache.Find(assetName);
+			if (loadedAsset != nullptr)
+			{
+				promise<shared_ptr<RTTI>> loaded;
+				loaded.set_value(move(loadedAsset));
+				return loaded.get_future().share();
+			}
+		}
+
+		if (mThreadPool == nullptr)
+		{
+			mThreadPool = make_unique<ThreadPool>();
+		}
+
+		auto request = make_shared<promise<shared_ptr<RTTI>>>();
+		AssetFuture future = request->get_future().share();
+		mPendingAssets.emplace(assetName, future);
+
+		mThreadPool->Enqueue([this, request, targetTypeId, assetName, pathName = mRootDirectory + assetName]
+		{
+			try
+			{
+				size_t assetSize;
+				auto asset = ReadAsset(targetTypeId, assetName, pathName, assetSize);
+				{
+					lock_guard<mutex> lock(mMutex);
+					mCache.Insert(assetName, asset, assetSize);
+					mPendingAssets.erase(assetName);
+				}
+
+				request->set_value(move(asset));
+			}
+			catch (...)
+			{
+				{
+					lock_guard<mutex> lock(mMutex);
+					mPendingAssets.erase(assetName);
+				}
+
+				request->set_exception(current_exception());
+			}
+		});
+
+		return future;
 	}
 }
\ No newline at end of file
@@ -1,45 +1,99 @@
 #pragma once
 
 #include <memory>
-#include <map>
+#include <vector>
+#include <unordered_map>
 #include <algorithm>
+#include <future>
+#include <mutex>
 #include "RTTI.h"
+#include "AssetCache.h"
 #include "GameException.h"
 #include "StringHelper.h"
+#include "Utility.h"
 
 namespace Library
 {
 	class Game;
+	class ThreadPool;
+	class ContentArchive;
+
+	template <typename T>
+	class AssetHandle final
+	{
+	public:
+		AssetHandle() = default;
+		explicit AssetHandle(std::shared_future<std::shared_ptr<RTTI>> future);
+		AssetHandle(const AssetHandle&) = default;
+		AssetHandle& operator=(const AssetHandle&) = default;
+		AssetHandle(AssetHandle&&) = default;
+		AssetHandle& operator=(AssetHandle&&) = default;
+		~AssetHandle() = default;
+
+		bool IsValid() const;
+		bool IsReady() const;
+		void Wait() const;
+
+		// Blocks until the asset has been read; rethrows the reader's exception if the load failed
+		std::shared_ptr<T> Get() const;
+
+	private:
+		std::shared_future<std::shared_ptr<RTTI>> mFuture;
+	};
 
 	class ContentManager final
 	{
 	public:
 		ContentManager(Library::Game& game, const std::wstring& rootDirectory = DefaultRootDirectory);
-		ContentManager(ContentManager&&) = default;
 		ContentManager(const ContentManager&) = delete;
-		ContentManager& operator=(const ContentManager&) = delete;		
-		ContentManager& operator=(ContentManager&&) = default;
-		~ContentManager() = default;
+		ContentManager& operator=(const ContentManager&) = delete;
+		ContentManager(ContentManager&&) = delete;
+		ContentManager& operator=(ContentManager&&) = delete;
+		~ContentManager();
 
-		const std::map<std::wstring, std::shared_ptr<RTTI>>& LoadedAssets() const;
 		const std::wstring& RootDirectory() const;
 		void SetRootDirectory(const std::wstring& rootDirectory);
 
 		template <typename T>
 		std::shared_ptr<T> Load(const std::wstring& assetName, bool reload = false, std::function<std::shared_ptr<T>(std::wstring&)> customReader = nullptr);
 
-		void AddAsset(const std::wstring& assetName, const std::shared_ptr<RTTI>& asset);
+		template <typename T>
+		AssetHandle<T> LoadAsync(const std::wstring& assetName, bool reload = false);
+
+		void AddAsset(const std::wstring& assetName, const std::shared_ptr<RTTI>& asset, std::size_t assetSize = 0);
 		void RemoveAsset(const std::wstring& assetName);
 		void Clear();
+		void WaitForPendingLoads();
+
+		// Assets are resolved through mounted archives before falling back to loose files under the root directory
+		void MountArchive(const std::wstring& filename);
+		void MountArchive(const std::shared_ptr<const ContentArchive>& archive);
+		void UnmountArchives();
+
+		std::size_t MemoryBudget() const;
+		void SetMemoryBudget(std::size_t budget);
+		AssetCacheStatistics CacheStatistics() const;
+		void ResetCacheStatistics();
+
+		// Evicts unreferenced assets until the cache is back within budget; returns the number evicted
+		std::size_t TrimCache();
 
 	private:
+		using AssetFuture = std::shared_future<std::shared_ptr<RTTI>>;
+
 		static const std::wstring DefaultRootDirectory;
 
-		std::shared_ptr<RTTI> ReadAsset(const std::int64_t targetTypeId, const std::wstring& assetName);
+		std::shared_ptr<RTTI> ReadAsset(const std::int64_t targetTypeId, const std::wstring& assetName, const std::wstring& pathName, std::size_t& assetSize);
+		AssetFuture LoadAsync(const std::uint64_t targetTypeId, const std::wstring& assetName, bool reload);
 
 		Library::Game& mGame;
-		std::map<std::wstring, std::shared_ptr<RTTI>> mLoadedAssets;
+		AssetCache mCache;
+		std::unordered_map<std::wstring, AssetFuture> mPendingAssets;
+		std::vector<std::shared_ptr<const ContentArchive>> mArchives;
 		std::wstring mRootDirectory;
+		mutable std::mutex mMutex;
+		std::mutex mSerializedReadMutex;
+		std::unique_ptr<ThreadPool> mThreadPool;
 	};
 }
 
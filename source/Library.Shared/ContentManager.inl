@@ -3,11 +3,6 @@
 
 namespace Library
 {
-	inline const std::map<std::wstring, std::shared_ptr<RTTI>>& ContentManager::LoadedAssets() const
-	{
-		return mLoadedAssets;
-	}
-
 	inline const std::wstring& ContentManager::RootDirectory() const
 	{
 		return mRootDirectory;
@@ -23,18 +18,77 @@ namespace Library
 	{
 		if (reload == false)
 		{
-			auto it = mLoadedAssets.find(assetName);
-			if (it != mLoadedAssets.end())
+			std::unique_lock<std::mutex> lock(mMutex);
+			auto loadedAsset = mCache.Find(assetName);
+			if (loadedAsset != nullptr)
 			{
-				return static_pointer_cast<T>(it->second);
+				return std::static_pointer_cast<T>(loadedAsset);
+			}
+
+			// Join an asynchronous load of the same asset rather than reading it a second time
+			auto pending = mPendingAssets.find(assetName);
+			if (pending != mPendingAssets.end())
+			{
+				AssetFuture future = pending->second;
+				lock.unlock();
+
+				return std::static_pointer_cast<T>(future.get());
 			}
 		}
 
 		uint64_t targetTypeId = T::TypeIdClass();
 		auto pathName = mRootDirectory + assetName;
-		auto asset = (customReader != nullptr ? customReader(pathName) : ReadAsset(targetTypeId, pathName));
-		mLoadedAssets[assetName] = asset;
+		std::shared_ptr<RTTI> asset;
+		std::size_t assetSize;
+		if (customReader != nullptr)
+		{
+			asset = customReader(pathName);
+			assetSize = Utility::GetFileSize(pathName);
+		}
+		else
+		{
+			asset = ReadAsset(targetTypeId, assetName, pathName, assetSize);
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		mCache.Insert(assetName, asset, assetSize);
+
+		return std::static_pointer_cast<T>(asset);
+	}
+
+	template<typename T>
+	inline AssetHandle<T> ContentManager::LoadAsync(const std::wstring& assetName, bool reload)
+	{
+		return AssetHandle<T>(LoadAsync(T::TypeIdClass(), assetName, reload));
+	}
 
-		return static_pointer_cast<T>(asset);
+	template<typename T>
+	inline AssetHandle<T>::AssetHandle(std::shared_future<std::shared_ptr<RTTI>> future) :
+		mFuture(std::move(future))
+	{
+	}
+
+	template<typename T>
+	inline bool AssetHandle<T>::IsValid() const
+	{
+		return mFuture.valid();
+	}
+
+	template<typename T>
+	inline bool AssetHandle<T>::IsReady() const
+	{
+		return mFuture.valid() && mFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	template<typename T>
+	inline void AssetHandle<T>::Wait() const
+	{
+		mFuture.wait();
+	}
+
+	template<typename T>
+	inline std::shared_ptr<T> AssetHandle<T>::Get() const
+	{
+		return std::static_pointer_cast<T>(mFuture.get());
 	}
 }
\ No newline at end of file
@@ -12,6 +12,16 @@ namespace Library
 		return mTargetTypeId;
 	}
 
+	bool AbstractContentTypeReader::SupportsConcurrentReads() const
+	{
+		return true;
+	}
+
+	size_t AbstractContentTypeReader::AssetSize(const wstring&, const RTTI&, size_t sourceSize) const
+	{
+		return sourceSize;
+	}
+
 	AbstractContentTypeReader::AbstractContentTypeReader(Game& game, const uint64_t targetTypeId) :
 		mGame(&game), mTargetTypeId(targetTypeId)
 	{
@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <gsl\gsl>
+#include "GameException.h"
 #include "RTTI.h"
 
 namespace Library
@@ -20,8 +21,19 @@ namespace Library
 		virtual ~AbstractContentTypeReader() = default;
 
 		std::uint64_t TargetTypeId() const;
+
+		// The device is created free-threaded, so readers that only create device objects may run concurrently on the content
+		// manager's worker threads. Readers that touch the immediate context or other shared state override this to be serialized.
+		virtual bool SupportsConcurrentReads() const;
+
+		// Approximate memory held by an asset this reader produced, charged against the content manager's budget.
+		// Defaults to the size of the source file or archive entry.
+		virtual std::size_t AssetSize(const std::wstring& assetName, const RTTI& asset, std::size_t sourceSize) const;
 		virtual std::shared_ptr<RTTI> Read(const std::wstring& assetName) = 0;
 
+		// Reads an asset already in memory, such as a ContentArchive entry. Owner keeps data alive for assets that reference it in place.
+		virtual std::shared_ptr<RTTI> Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner) = 0;
+
 	protected:
 		AbstractContentTypeReader(Game& game, const std::uint64_t targetTypeId);
 
@@ -40,11 +52,13 @@ namespace Library
 		virtual ~ContentTypeReader() = default;
 
 		virtual std::shared_ptr<RTTI> Read(const std::wstring& assetName) override;
+		virtual std::shared_ptr<RTTI> Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner) override;
 
 	protected:
 		ContentTypeReader(Game& game, const std::uint64_t targetTypeId);
 
 		virtual std::shared_ptr<T> _Read(const std::wstring& assetName) = 0;
+		virtual std::shared_ptr<T> _Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner);
 	};
 }
 
@@ -13,4 +13,16 @@ namespace Library
 	{
 		return _Read(assetName);
 	}
+
+	template<typename T>
+	inline std::shared_ptr<RTTI> ContentTypeReader<T>::Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner)
+	{
+		return _Read(assetName, data, owner);
+	}
+
+	template<typename T>
+	inline std::shared_ptr<T> ContentTypeReader<T>::_Read(const std::wstring&, gsl::span<const std::uint8_t>, const std::shared_ptr<const void>&)
+	{
+		throw GameException("Content type reader does not support reading from memory.");
+	}
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 using namespace DirectX;
 using namespace winrt;
 
@@ -19,10 +20,16 @@ namespace Library
 
 	shared_ptr<DomainShader> DomainShaderReader::_Read(const wstring& assetName)
 	{
-		com_ptr<ID3D11DomainShader> hullShader;
 		vector<char> compiledDomainShader;
 		Utility::LoadBinaryFile(assetName, compiledDomainShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreateDomainShader(&compiledDomainShader[0], compiledDomainShader.size(), nullptr, hullShader.put()), "ID3D11Device::CreatedDomainShader() failed.");
+
+		return _Read(assetName, span<const uint8_t>(reinterpret_cast<const uint8_t*>(compiledDomainShader.data()), compiledDomainShader.size()), nullptr);
+	}
+
+	shared_ptr<DomainShader> DomainShaderReader::_Read(const wstring&, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11DomainShader> hullShader;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateDomainShader(data.data(), data.size_bytes(), nullptr, hullShader.put()), "ID3D11Device::CreatedDomainShader() failed.");
 		
 		return shared_ptr<DomainShader>(new DomainShader(move(hullShader)));
 	}
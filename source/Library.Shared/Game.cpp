@@ -46,6 +46,9 @@ namespace Library
 
 	void Game::Shutdown()
 	{
+		// Asynchronous loads still hold the device and the content type readers
+		mContentManager.WaitForPendingLoads();
+
 		for (auto& component : mComponents)
 		{
 			component->Shutdown();
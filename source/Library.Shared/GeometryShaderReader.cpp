@@ -5,6 +5,7 @@
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 using namespace DirectX;
 using namespace winrt;
 
@@ -19,10 +20,16 @@ namespace Library
 
 	shared_ptr<GeometryShader> GeometryShaderReader::_Read(const wstring& assetName)
 	{
-		com_ptr<ID3D11GeometryShader> hullShader;
 		vector<char> compiledGeometryShader;
 		Utility::LoadBinaryFile(assetName, compiledGeometryShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreateGeometryShader(&compiledGeometryShader[0], compiledGeometryShader.size(), nullptr, hullShader.put()), "ID3D11Device::CreatedGeometryShader() failed.");
+
+		return _Read(assetName, span<const uint8_t>(reinterpret_cast<const uint8_t*>(compiledGeometryShader.data()), compiledGeometryShader.size()), nullptr);
+	}
+
+	shared_ptr<GeometryShader> GeometryShaderReader::_Read(const wstring&, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11GeometryShader> hullShader;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateGeometryShader(data.data(), data.size_bytes(), nullptr, hullShader.put()), "ID3D11Device::CreatedGeometryShader() failed.");
 		
 		return shared_ptr<GeometryShader>(new GeometryShader(move(hullShader)));
 	}
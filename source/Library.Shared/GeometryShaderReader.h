@@ -19,5 +19,6 @@ namespace Library
 
 	protected:
 		virtual std::shared_ptr<GeometryShader> _Read(const std::wstring& assetName) override;
+		virtual std::shared_ptr<GeometryShader> _Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner) override;
 	};
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 using namespace DirectX;
 using namespace winrt;
 
@@ -19,10 +20,16 @@ namespace Library
 
 	shared_ptr<HullShader> HullShaderReader::_Read(const wstring& assetName)
 	{
-		com_ptr<ID3D11HullShader> hullShader;
 		vector<char> compiledHullShader;
 		Utility::LoadBinaryFile(assetName, compiledHullShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreateHullShader(&compiledHullShader[0], compiledHullShader.size(), nullptr, hullShader.put()), "ID3D11Device::CreatedHullShader() failed.");
+
+		return _Read(assetName, span<const uint8_t>(reinterpret_cast<const uint8_t*>(compiledHullShader.data()), compiledHullShader.size()), nullptr);
+	}
+
+	shared_ptr<HullShader> HullShaderReader::_Read(const wstring&, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11HullShader> hullShader;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreateHullShader(data.data(), data.size_bytes(), nullptr, hullShader.put()), "ID3D11Device::CreatedHullShader() failed.");
 		
 		return shared_ptr<HullShader>(new HullShader(move(hullShader)));
 	}
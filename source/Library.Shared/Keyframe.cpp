@@ -3,10 +3,13 @@
 #include "VectorHelper.h"
 #include "StreamHelper.h"
 
+using namespace std;
 using namespace DirectX;
 
 namespace Library
 {
+	static_assert(sizeof(KeyframeData) == 11 * sizeof(float), "KeyframeData must match the serialized keyframe layout.");
+
 	Keyframe::Keyframe(InputStreamHelper& streamHelper)
 	{
 		Load(streamHelper);
@@ -17,6 +20,11 @@ namespace Library
     {
     }
 
+	Keyframe::Keyframe(const KeyframeData& data) :
+		mTime(data.Time), mTranslation(data.Translation), mRotationQuaternion(data.RotationQuaternion), mScale(data.Scale)
+	{
+	}
+
 	float Keyframe::Time() const
 	{
 		return mTime;
@@ -59,19 +67,80 @@ namespace Library
 		return XMMatrixAffineTransformation(ScaleVector(), rotationOrigin, RotationQuaternionVector(), TranslationVector());
 	}
 
+	KeyframeData Keyframe::Data() const
+	{
+		return KeyframeData{ mTime, mTranslation, mRotationQuaternion, mScale };
+	}
+
 	void Keyframe::Save(OutputStreamHelper& streamHelper)
 	{
-		streamHelper << mTime;
-		streamHelper << mTranslation.x << mTranslation.y << mTranslation.z;
-		streamHelper << mRotationQuaternion.x << mRotationQuaternion.y << mRotationQuaternion.z << mRotationQuaternion.w;
-		streamHelper << mScale.x << mScale.y << mScale.z;
+		const KeyframeData data = Data();
+		streamHelper.WriteRaw(gsl::span<const KeyframeData>(&data, 1));
 	}
 
 	void Keyframe::Load(InputStreamHelper& streamHelper)
 	{
-		streamHelper >> mTime;
-		streamHelper >> mTranslation.x >> mTranslation.y >> mTranslation.z;
-		streamHelper >> mRotationQuaternion.x >> mRotationQuaternion.y >> mRotationQuaternion.z >> mRotationQuaternion.w;
-		streamHelper >> mScale.x >> mScale.y >> mScale.z;
+		KeyframeData data;
+		streamHelper.ReadRaw(gsl::span<KeyframeData>(&data, 1));
+		*this = Keyframe(data);
 	}
+
+#pragma region KeyframeTrack
+
+	uint32_t KeyframeTrack::Size() const
+	{
+		return gsl::narrow_cast<uint32_t>(Times.size());
+	}
+
+	void KeyframeTrack::Reserve(size_t size)
+	{
+		Times.reserve(size);
+		Translations.reserve(size);
+		RotationQuaternions.reserve(size);
+		Scales.reserve(size);
+	}
+
+	void KeyframeTrack::PushBack(float time, const XMFLOAT3& translation, const XMFLOAT4& rotationQuaternion, const XMFLOAT3& scale)
+	{
+		Times.push_back(time);
+		Translations.push_back(translation);
+		RotationQuaternions.push_back(rotationQuaternion);
+		Scales.push_back(scale);
+	}
+
+	void KeyframeTrack::Assign(gsl::span<const KeyframeData> keyframes)
+	{
+		const size_t size = static_cast<size_t>(keyframes.size());
+		Times.resize(size);
+		Translations.resize(size);
+		RotationQuaternions.resize(size);
+		Scales.resize(size);
+
+		for (size_t i = 0; i < size; i++)
+		{
+			const KeyframeData& keyframe = keyframes[i];
+			Times[i] = keyframe.Time;
+			Translations[i] = keyframe.Translation;
+			RotationQuaternions[i] = keyframe.RotationQuaternion;
+			Scales[i] = keyframe.Scale;
+		}
+	}
+
+	vector<KeyframeData> KeyframeTrack::Data() const
+	{
+		vector<KeyframeData> keyframes(Times.size());
+		for (size_t i = 0; i < keyframes.size(); i++)
+		{
+			keyframes[i] = KeyframeData{ Times[i], Translations[i], RotationQuaternions[i], Scales[i] };
+		}
+
+		return keyframes;
+	}
+
+	XMMATRIX KeyframeTrack::Transform(uint32_t index) const
+	{
+		return XMMatrixAffineTransformation(XMLoadFloat3(&Scales[index]), XMVectorZero(), XMLoadFloat4(&RotationQuaternions[index]), XMLoadFloat3(&Translations[index]));
+	}
+
+#pragma endregion
 }
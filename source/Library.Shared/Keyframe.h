@@ -1,17 +1,50 @@
 #pragma once
 
 #include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+#include <gsl\gsl>
 
 namespace Library
 {
 	class OutputStreamHelper;
 	class InputStreamHelper;
 
+	// On-disk layout of a keyframe, so whole tracks can be read and written in one block
+	struct KeyframeData final
+	{
+		float Time;
+		DirectX::XMFLOAT3 Translation;
+		DirectX::XMFLOAT4 RotationQuaternion;
+		DirectX::XMFLOAT3 Scale;
+	};
+
+	// A bone animation's keyframes as parallel arrays, one element per keyframe. Lookups search the contiguous times, and
+	// sampling loads only the two keyframes it interpolates.
+	struct KeyframeTrack final
+	{
+		std::vector<float> Times;
+		std::vector<DirectX::XMFLOAT3> Translations;
+		std::vector<DirectX::XMFLOAT4> RotationQuaternions;
+		std::vector<DirectX::XMFLOAT3> Scales;
+
+		std::uint32_t Size() const;
+		void Reserve(std::size_t size);
+		void PushBack(float time, const DirectX::XMFLOAT3& translation, const DirectX::XMFLOAT4& rotationQuaternion, const DirectX::XMFLOAT3& scale);
+
+		// Conversions to and from the serialized (interleaved) layout
+		void Assign(gsl::span<const KeyframeData> keyframes);
+		std::vector<KeyframeData> Data() const;
+
+		DirectX::XMMATRIX Transform(std::uint32_t index) const;
+	};
+
     class Keyframe final
     {
     public:
 		Keyframe(InputStreamHelper& streamHelper);
 		Keyframe(float time, const DirectX::XMFLOAT3& translation, const DirectX::XMFLOAT4& rotationQuaternion, const DirectX::XMFLOAT3& scale);
+		explicit Keyframe(const KeyframeData& data);
 		Keyframe(const Keyframe&) = default;
 		Keyframe(Keyframe&&) = default;
 		Keyframe& operator=(const Keyframe&) = default;
@@ -27,6 +60,7 @@ namespace Library
 		DirectX::XMVECTOR RotationQuaternionVector() const;
 		DirectX::XMVECTOR ScaleVector() const;
 		DirectX::XMMATRIX Transform() const;
+		KeyframeData Data() const;
 
 		void Save(OutputStreamHelper& streamHelper);
 
@@ -0,0 +1,177 @@
+#include "pch.h"
+#include "KeyframeCompression.h"
+#include "Keyframe.h"
+#include "ModelFile.h"
+#include "VertexQuantization.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	namespace
+	{
+		const float VectorComponentMax = 65535.0f;
+		const float RotationComponentMax = 32767.0f;
+		const float SqrtTwo = 1.41421356f;
+
+		template <typename T>
+		void CollapseConstantStream(vector<T>& encoded)
+		{
+			const auto differs = [&encoded](const T& value) { return memcmp(&value, &encoded.front(), sizeof(T)) != 0; };
+			if (encoded.empty() == false && none_of(encoded.begin() + 1, encoded.end(), differs))
+			{
+				encoded.resize(1);
+			}
+		}
+
+		template <typename T>
+		const T& StreamElement(span<const T> stream, size_t index)
+		{
+			return stream[stream.size() == 1 ? 0 : index];
+		}
+	}
+
+	CompressedRotation KeyframeCompression::EncodeRotation(FXMVECTOR rotationQuaternion)
+	{
+		XMFLOAT4 quaternion;
+		XMStoreFloat4(&quaternion, XMQuaternionNormalize(rotationQuaternion));
+		const float components[] = { quaternion.x, quaternion.y, quaternion.z, quaternion.w };
+
+		uint32_t largest = 0;
+		for (uint32_t i = 1; i < 4; ++i)
+		{
+			if (fabsf(components[i]) > fabsf(components[largest]))
+			{
+				largest = i;
+			}
+		}
+
+		// The remaining components lie within +/-1/sqrt(2)
+		const float sign = (components[largest] < 0.0f ? -1.0f : 1.0f);
+		uint64_t packed = largest;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i != largest)
+			{
+				const float normalized = clamp(components[i] * sign * SqrtTwo * 0.5f + 0.5f, 0.0f, 1.0f);
+				packed = (packed << 15) | static_cast<uint64_t>(lroundf(normalized * RotationComponentMax));
+			}
+		}
+
+		return CompressedRotation{ { static_cast<uint16_t>(packed >> 32), static_cast<uint16_t>(packed >> 16), static_cast<uint16_t>(packed) } };
+	}
+
+	XMVECTOR KeyframeCompression::DecodeRotation(const CompressedRotation& encoded)
+	{
+		const uint64_t packed = (static_cast<uint64_t>(encoded.Components[0]) << 32) | (static_cast<uint64_t>(encoded.Components[1]) << 16) | encoded.Components[2];
+		const uint32_t largest = static_cast<uint32_t>((packed >> 45) & 0x3);
+
+		float components[4];
+		float sumOfSquares = 0.0f;
+		uint32_t shift = 30;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			if (i != largest)
+			{
+				const float normalized = static_cast<float>((packed >> shift) & 0x7FFF) / RotationComponentMax;
+				components[i] = (normalized * 2.0f - 1.0f) / SqrtTwo;
+				sumOfSquares += components[i] * components[i];
+				shift -= 15;
+			}
+		}
+
+		components[largest] = sqrtf(max(1.0f - sumOfSquares, 0.0f));
+
+		return XMQuaternionNormalize(XMVectorSet(components[0], components[1], components[2], components[3]));
+	}
+
+	void KeyframeCompression::Encode(const KeyframeTrack& keyframes, ModelFileWriter& fileWriter, ModelFileCompressedTrack& compressedTrack)
+	{
+		vector<CompressedRotation> rotations;
+		rotations.reserve(keyframes.RotationQuaternions.size());
+		for (const XMFLOAT4& rotationQuaternion : keyframes.RotationQuaternions)
+		{
+			rotations.push_back(EncodeRotation(XMLoadFloat4(&rotationQuaternion)));
+		}
+
+		vector<CompressedVector> encodedTranslations;
+		vector<CompressedVector> encodedScales;
+		XMFLOAT3 translationOffset;
+		XMFLOAT3 translationScale;
+		XMFLOAT3 scaleOffset;
+		XMFLOAT3 scaleScale;
+		EncodeVectors(keyframes.Translations, encodedTranslations, translationOffset, translationScale);
+		EncodeVectors(keyframes.Scales, encodedScales, scaleOffset, scaleScale);
+
+		CollapseConstantStream(encodedTranslations);
+		CollapseConstantStream(rotations);
+		CollapseConstantStream(encodedScales);
+
+		memcpy(compressedTrack.TranslationOffset, &translationOffset, sizeof(compressedTrack.TranslationOffset));
+		memcpy(compressedTrack.TranslationScale, &translationScale, sizeof(compressedTrack.TranslationScale));
+		memcpy(compressedTrack.ScaleOffset, &scaleOffset, sizeof(compressedTrack.ScaleOffset));
+		memcpy(compressedTrack.ScaleScale, &scaleScale, sizeof(compressedTrack.ScaleScale));
+		compressedTrack.Times = fileWriter.Append(ModelFileSection::CompressedKeyframes, keyframes.Times);
+		compressedTrack.Translations = fileWriter.Append(ModelFileSection::CompressedKeyframes, encodedTranslations);
+		compressedTrack.Rotations = fileWriter.Append(ModelFileSection::CompressedKeyframes, rotations);
+		compressedTrack.Scales = fileWriter.Append(ModelFileSection::CompressedKeyframes, encodedScales);
+	}
+
+	void KeyframeCompression::Decode(const ModelFileReader& fileReader, const ModelFileCompressedTrack& compressedTrack, KeyframeTrack& keyframes)
+	{
+		const auto times = fileReader.Get<float>(ModelFileSection::CompressedKeyframes, compressedTrack.Times);
+		const auto translations = fileReader.Get<CompressedVector>(ModelFileSection::CompressedKeyframes, compressedTrack.Translations);
+		const auto rotations = fileReader.Get<CompressedRotation>(ModelFileSection::CompressedKeyframes, compressedTrack.Rotations);
+		const auto scales = fileReader.Get<CompressedVector>(ModelFileSection::CompressedKeyframes, compressedTrack.Scales);
+
+		const auto isValidStream = [&times](size_t size) { return size == 1 || size == static_cast<size_t>(times.size()); };
+		if (times.empty() || isValidStream(translations.size()) == false || isValidStream(rotations.size()) == false || isValidStream(scales.size()) == false)
+		{
+			throw GameException("Compressed keyframe streams don't match the track's keyframe count.");
+		}
+
+		const XMFLOAT3 translationOffset(compressedTrack.TranslationOffset);
+		const XMFLOAT3 translationScale(compressedTrack.TranslationScale);
+		const XMFLOAT3 scaleOffset(compressedTrack.ScaleOffset);
+		const XMFLOAT3 scaleScale(compressedTrack.ScaleScale);
+
+		const size_t keyframeCount = static_cast<size_t>(times.size());
+		keyframes.Times.assign(times.begin(), times.end());
+		keyframes.Translations.resize(keyframeCount);
+		keyframes.RotationQuaternions.resize(keyframeCount);
+		keyframes.Scales.resize(keyframeCount);
+		for (size_t i = 0; i < keyframeCount; ++i)
+		{
+			XMStoreFloat3(&keyframes.Translations[i], DecodeVector(StreamElement(translations, i), XMLoadFloat3(&translationOffset), XMLoadFloat3(&translationScale)));
+			XMStoreFloat4(&keyframes.RotationQuaternions[i], DecodeRotation(StreamElement(rotations, i)));
+			XMStoreFloat3(&keyframes.Scales[i], DecodeVector(StreamElement(scales, i), XMLoadFloat3(&scaleOffset), XMLoadFloat3(&scaleScale)));
+		}
+	}
+
+	void KeyframeCompression::EncodeVectors(span<const XMFLOAT3> values, vector<CompressedVector>& encoded, XMFLOAT3& offset, XMFLOAT3& scale)
+	{
+		// Keys are quantized across the track's bounding box, the same range vertex positions use
+		VertexQuantization::GetEncodingRange(values, offset, scale);
+		const XMVECTOR minimum = XMLoadFloat3(&offset);
+		const XMVECTOR extent = XMLoadFloat3(&scale);
+
+		const XMVECTOR toComponents = XMVectorScale(XMVectorReciprocal(extent), VectorComponentMax);
+		encoded.resize(static_cast<size_t>(values.size()));
+		for (size_t i = 0; i < encoded.size(); ++i)
+		{
+			XMFLOAT3 components;
+			XMStoreFloat3(&components, XMVectorClamp(XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&values[i]), minimum), toComponents), XMVectorZero(), XMVectorReplicate(VectorComponentMax)));
+			encoded[i] = CompressedVector{ { static_cast<uint16_t>(lroundf(components.x)), static_cast<uint16_t>(lroundf(components.y)), static_cast<uint16_t>(lroundf(components.z)) } };
+		}
+	}
+
+	XMVECTOR KeyframeCompression::DecodeVector(const CompressedVector& encoded, FXMVECTOR offset, FXMVECTOR scale)
+	{
+		const XMVECTOR normalized = XMVectorScale(XMVectorSet(static_cast<float>(encoded.Components[0]), static_cast<float>(encoded.Components[1]), static_cast<float>(encoded.Components[2]), 0.0f), 1.0f / VectorComponentMax);
+
+		return XMVectorMultiplyAdd(normalized, scale, offset);
+	}
+}
\ No newline at end of file
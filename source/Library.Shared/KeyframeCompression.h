@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	struct KeyframeTrack;
+	struct ModelFileCompressedTrack;
+	class ModelFileWriter;
+	class ModelFileReader;
+
+	// 16-bit UNORM per axis across the track's bounding box
+	struct CompressedVector final
+	{
+		std::uint16_t Components[3];
+	};
+
+	// Smallest-three quaternion in 48 bits: the index of the largest component in two bits, then the other three at 15 bits each.
+	// The largest component is rebuilt from unit length; q and -q are the same rotation, so it's always stored as positive.
+	struct CompressedRotation final
+	{
+		std::uint16_t Components[3];
+	};
+
+	class KeyframeCompression final
+	{
+	public:
+		KeyframeCompression() = delete;
+		KeyframeCompression(const KeyframeCompression&) = delete;
+		KeyframeCompression& operator=(const KeyframeCompression&) = delete;
+		KeyframeCompression(KeyframeCompression&&) = delete;
+		KeyframeCompression& operator=(KeyframeCompression&&) = delete;
+		~KeyframeCompression() = default;
+
+		static CompressedRotation EncodeRotation(DirectX::FXMVECTOR rotationQuaternion);
+		static DirectX::XMVECTOR DecodeRotation(const CompressedRotation& encoded);
+
+		// Streams whose keys all quantize to the same value are stored as a single element
+		static void Encode(const KeyframeTrack& keyframes, ModelFileWriter& fileWriter, ModelFileCompressedTrack& compressedTrack);
+		static void Decode(const ModelFileReader& fileReader, const ModelFileCompressedTrack& compressedTrack, KeyframeTrack& keyframes);
+
+	private:
+		static void EncodeVectors(gsl::span<const DirectX::XMFLOAT3> values, std::vector<CompressedVector>& encoded, DirectX::XMFLOAT3& offset, DirectX::XMFLOAT3& scale);
+		static DirectX::XMVECTOR DecodeVector(const CompressedVector& encoded, DirectX::FXMVECTOR offset, DirectX::FXMVECTOR scale);
+	};
+}
\ No newline at end of file
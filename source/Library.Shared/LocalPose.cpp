@@ -0,0 +1,155 @@
+#include "pch.h"
+#include "LocalPose.h"
+#include "Model.h"
+#include "Skeleton.h"
+#include "GameException.h"
+#include "VectorHelper.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+#pragma region LocalPose
+
+	uint32_t LocalPose::BoneCount() const
+	{
+		return narrow_cast<uint32_t>(Translations.size());
+	}
+
+	void LocalPose::Resize(uint32_t boneCount)
+	{
+		Translations.resize(boneCount);
+		RotationQuaternions.resize(boneCount);
+		Scales.resize(boneCount);
+	}
+
+	void LocalPose::GetTransforms(span<XMFLOAT4X4> transforms) const
+	{
+		assert(static_cast<size_t>(transforms.size()) >= Translations.size());
+
+		const XMVECTOR rotationOrigin = XMLoadFloat4(&Vector4Helper::Zero);
+		for (size_t i = 0; i < Translations.size(); i++)
+		{
+			XMStoreFloat4x4(&transforms[i], XMMatrixAffineTransformation(XMLoadFloat3(&Scales[i]), rotationOrigin, XMLoadFloat4(&RotationQuaternions[i]), XMLoadFloat3(&Translations[i])));
+		}
+	}
+
+#pragma endregion
+
+#pragma region PosePool
+
+	PosePool::PosePool(uint32_t boneCount) :
+		mBoneCount(boneCount)
+	{
+	}
+
+	uint32_t PosePool::BoneCount() const
+	{
+		return mBoneCount;
+	}
+
+	LocalPose& PosePool::Acquire()
+	{
+		if (mAcquiredCount == mPoses.size())
+		{
+			// A deque keeps the poses already handed out in place as it grows
+			mPoses.emplace_back().Resize(mBoneCount);
+		}
+
+		return mPoses[mAcquiredCount++];
+	}
+
+	void PosePool::Reset()
+	{
+		mAcquiredCount = 0;
+	}
+
+#pragma endregion
+
+#pragma region PoseBlending
+
+	void PoseBlending::Blend(const LocalPose& from, const LocalPose& to, float weight, LocalPose& result, span<const float> boneMask)
+	{
+		assert(from.BoneCount() == to.BoneCount() && result.BoneCount() == from.BoneCount());
+		assert(boneMask.empty() || static_cast<uint32_t>(boneMask.size()) >= from.BoneCount());
+
+		for (uint32_t i = 0; i < from.BoneCount(); ++i)
+		{
+			const float boneWeight = (boneMask.empty() ? weight : weight * boneMask[i]);
+			if (boneWeight <= 0.0f)
+			{
+				result.Translations[i] = from.Translations[i];
+				result.RotationQuaternions[i] = from.RotationQuaternions[i];
+				result.Scales[i] = from.Scales[i];
+				continue;
+			}
+
+			XMStoreFloat3(&result.Translations[i], XMVectorLerp(XMLoadFloat3(&from.Translations[i]), XMLoadFloat3(&to.Translations[i]), boneWeight));
+			XMStoreFloat4(&result.RotationQuaternions[i], XMQuaternionSlerp(XMLoadFloat4(&from.RotationQuaternions[i]), XMLoadFloat4(&to.RotationQuaternions[i]), boneWeight));
+			XMStoreFloat3(&result.Scales[i], XMVectorLerp(XMLoadFloat3(&from.Scales[i]), XMLoadFloat3(&to.Scales[i]), boneWeight));
+		}
+	}
+
+	void PoseBlending::Add(const LocalPose& base, const LocalPose& additive, const LocalPose& reference, float weight, LocalPose& result, span<const float> boneMask)
+	{
+		assert(base.BoneCount() == additive.BoneCount() && reference.BoneCount() == base.BoneCount() && result.BoneCount() == base.BoneCount());
+		assert(boneMask.empty() || static_cast<uint32_t>(boneMask.size()) >= base.BoneCount());
+
+		const XMVECTOR identityQuaternion = XMQuaternionIdentity();
+		const XMVECTOR one = XMLoadFloat3(&Vector3Helper::One);
+
+		for (uint32_t i = 0; i < base.BoneCount(); ++i)
+		{
+			const float boneWeight = (boneMask.empty() ? weight : weight * boneMask[i]);
+			if (boneWeight <= 0.0f)
+			{
+				result.Translations[i] = base.Translations[i];
+				result.RotationQuaternions[i] = base.RotationQuaternions[i];
+				result.Scales[i] = base.Scales[i];
+				continue;
+			}
+
+			const XMVECTOR referenceRotation = XMLoadFloat4(&reference.RotationQuaternions[i]);
+			const XMVECTOR translationDelta = XMLoadFloat3(&additive.Translations[i]) - XMLoadFloat3(&reference.Translations[i]);
+			const XMVECTOR rotationDelta = XMQuaternionMultiply(XMQuaternionInverse(referenceRotation), XMLoadFloat4(&additive.RotationQuaternions[i]));
+			const XMVECTOR scaleDelta = XMVectorDivide(XMLoadFloat3(&additive.Scales[i]), XMLoadFloat3(&reference.Scales[i]));
+
+			XMStoreFloat3(&result.Translations[i], XMVectorMultiplyAdd(translationDelta, XMVectorReplicate(boneWeight), XMLoadFloat3(&base.Translations[i])));
+			XMStoreFloat4(&result.RotationQuaternions[i], XMQuaternionMultiply(XMLoadFloat4(&base.RotationQuaternions[i]), XMQuaternionSlerp(identityQuaternion, rotationDelta, boneWeight)));
+			XMStoreFloat3(&result.Scales[i], XMLoadFloat3(&base.Scales[i]) * XMVectorLerp(one, scaleDelta, boneWeight));
+		}
+	}
+
+	vector<float> PoseBlending::CreateBoneMask(const Model& model, const string& rootBoneName)
+	{
+		const auto boneIndexMapping = model.BoneIndexMapping();
+		const auto rootBone = boneIndexMapping.find(rootBoneName);
+		if (rootBone == boneIndexMapping.end())
+		{
+			throw GameException("Bone mask root is not a bone of the model.");
+		}
+
+		// The skeleton lists parents before children, so a node is in the mask when it's the root or its parent is
+		const Skeleton& skeleton = model.GetSkeleton();
+		const auto parentIndices = skeleton.ParentIndices();
+		const auto boneIndices = skeleton.BoneIndices();
+		vector<bool> nodeIncluded(skeleton.NodeCount(), false);
+		vector<float> boneMask(model.Bones().size(), 0.0f);
+
+		for (uint32_t node = 0; node < skeleton.NodeCount(); ++node)
+		{
+			const uint32_t parentIndex = parentIndices[node];
+			nodeIncluded[node] = (boneIndices[node] == rootBone->second || (parentIndex != Skeleton::NoParent && nodeIncluded[parentIndex]));
+			if (nodeIncluded[node] && boneIndices[node] != Skeleton::NoBone)
+			{
+				boneMask[boneIndices[node]] = 1.0f;
+			}
+		}
+
+		return boneMask;
+	}
+
+#pragma endregion
+}
\ No newline at end of file
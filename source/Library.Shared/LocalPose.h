@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class Model;
+
+	// Bone to parent transforms as separate components, by bone index. Poses are blended in this form and turned into
+	// matrices once, before the hierarchy pass.
+	struct LocalPose final
+	{
+		std::vector<DirectX::XMFLOAT3> Translations;
+		std::vector<DirectX::XMFLOAT4> RotationQuaternions;
+		std::vector<DirectX::XMFLOAT3> Scales;
+
+		std::uint32_t BoneCount() const;
+		void Resize(std::uint32_t boneCount);
+		void GetTransforms(gsl::span<DirectX::XMFLOAT4X4> transforms) const;
+	};
+
+	// Hands out poses for a single frame. Poses are kept when the pool is reset, so once it has grown to a frame's
+	// peak use, acquiring them doesn't allocate.
+	class PosePool final
+	{
+	public:
+		explicit PosePool(std::uint32_t boneCount = 0);
+		PosePool(const PosePool&) = default;
+		PosePool(PosePool&&) = default;
+		PosePool& operator=(const PosePool&) = default;
+		PosePool& operator=(PosePool&&) = default;
+		~PosePool() = default;
+
+		std::uint32_t BoneCount() const;
+
+		// The pose's contents are left from its previous use; it stays valid until the pool is reset
+		LocalPose& Acquire();
+		void Reset();
+
+	private:
+		std::deque<LocalPose> mPoses;
+		std::uint32_t mAcquiredCount{ 0 };
+		std::uint32_t mBoneCount;
+	};
+
+	class PoseBlending final
+	{
+	public:
+		PoseBlending() = delete;
+		PoseBlending(const PoseBlending&) = delete;
+		PoseBlending& operator=(const PoseBlending&) = delete;
+		PoseBlending(PoseBlending&&) = delete;
+		PoseBlending& operator=(PoseBlending&&) = delete;
+		~PoseBlending() = default;
+
+		// boneMask scales weight per bone index (empty for every bone at full weight). result may be any of the inputs.
+		static void Blend(const LocalPose& from, const LocalPose& to, float weight, LocalPose& result, gsl::span<const float> boneMask = { });
+
+		// Applies additive's difference from reference on top of base
+		static void Add(const LocalPose& base, const LocalPose& additive, const LocalPose& reference, float weight, LocalPose& result, gsl::span<const float> boneMask = { });
+
+		// Full weight for the named bone and every bone beneath it, zero elsewhere
+		static std::vector<float> CreateBoneMask(const Model& model, const std::string& rootBoneName);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "pch.h"
+#include "MemoryMappedFile.h"
+#include "GameException.h"
+#include "Utility.h"
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	MemoryMappedFile::MemoryMappedFile(const string& filename)
+	{
+		mFile = CreateFileW(Utility::ToWideString(filename).c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (mFile == INVALID_HANDLE_VALUE)
+		{
+			throw GameException("CreateFileW() failed.", HRESULT_FROM_WIN32(GetLastError()));
+		}
+
+		LARGE_INTEGER fileSize;
+		if (GetFileSizeEx(mFile, &fileSize) == FALSE)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			Close();
+			throw GameException("GetFileSizeEx() failed.", hr);
+		}
+
+		mSize = narrow<size_t>(fileSize.QuadPart);
+		if (mSize == 0)
+		{
+			// Zero-length files can't be mapped
+			return;
+		}
+
+		mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mMapping == nullptr)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			Close();
+			throw GameException("CreateFileMappingW() failed.", hr);
+		}
+
+		mView = reinterpret_cast<const uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+		if (mView == nullptr)
+		{
+			HRESULT hr = HRESULT_FROM_WIN32(GetLastError());
+			Close();
+			throw GameException("MapViewOfFile() failed.", hr);
+		}
+	}
+
+	MemoryMappedFile::~MemoryMappedFile()
+	{
+		Close();
+	}
+
+	span<const uint8_t> MemoryMappedFile::Data() const
+	{
+		return span<const uint8_t>(mView, mSize);
+	}
+
+	void MemoryMappedFile::Close()
+	{
+		if (mView != nullptr)
+		{
+			UnmapViewOfFile(mView);
+			mView = nullptr;
+		}
+
+		if (mMapping != nullptr)
+		{
+			CloseHandle(mMapping);
+			mMapping = nullptr;
+		}
+
+		if (mFile != INVALID_HANDLE_VALUE)
+		{
+			CloseHandle(mFile);
+			mFile = INVALID_HANDLE_VALUE;
+		}
+
+		mSize = 0;
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <windows.h>
+#include <string>
+#include <cstdint>
+#include <gsl\gsl>
+
+namespace Library
+{
+	class MemoryMappedFile final
+	{
+	public:
+		explicit MemoryMappedFile(const std::string& filename);
+		MemoryMappedFile(const MemoryMappedFile&) = delete;
+		MemoryMappedFile(MemoryMappedFile&&) = delete;
+		MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+		MemoryMappedFile& operator=(MemoryMappedFile&&) = delete;
+		~MemoryMappedFile();
+
+		gsl::span<const std::uint8_t> Data() const;
+
+	private:
+		void Close();
+
+		HANDLE mFile{ INVALID_HANDLE_VALUE };
+		HANDLE mMapping{ nullptr };
+		const std::uint8_t* mView{ nullptr };
+		std::size_t mSize{ 0 };
+	};
+}
@@ -5,22 +5,171 @@
 #include "ModelMaterial.h"
 #include "Model.h"
 #include "Bone.h"
+#include "ModelFile.h"
+#include "VertexQuantization.h"
 
 using namespace std;
 using namespace gsl;
 using namespace DirectX;
+using namespace DirectX::PackedVector;
 
 namespace Library
 {
+	namespace
+	{
+		// On-disk layout of BoneVertexWeights::VertexWeight, which isn't default constructible
+		struct SerializedVertexWeight
+		{
+			float Weight;
+			uint32_t BoneIndex;
+		};
+
+		static_assert(sizeof(SerializedVertexWeight) == sizeof(float) + sizeof(uint32_t), "SerializedVertexWeight must match the serialized layout.");
+
+		template <typename T>
+		void BindDecodedStream(span<const T>& stream, const vector<T>& decoded)
+		{
+			if (decoded.empty() == false)
+			{
+				stream = decoded;
+			}
+		}
+	}
+
 	Mesh::Mesh(Model& model, InputStreamHelper& streamHelper) :
 		mModel(&model)
 	{
 		Load(streamHelper);
+		BindStreams();
 	}
 
 	Mesh::Mesh(Model& model, MeshData&& meshData) :
 		mModel(&model), mData(move(meshData))
 	{
+		BindStreams();
+	}
+
+	Mesh::Mesh(Model& model, const ModelFileReader& fileReader, const ModelFileMesh& fileMesh, span<const ModelFileMeshLod> fileLods, span<const Meshlet> meshlets, const ModelFileQuantizedMesh* quantizedMesh) :
+		mModel(&model), mStorage(fileReader.Owner()), mMeshlets(meshlets)
+	{
+		if (fileMesh.MaterialIndex >= 0)
+		{
+			mData.Material = model.Materials().at(static_cast<size_t>(fileMesh.MaterialIndex));
+		}
+
+		mData.Name = fileReader.GetString(fileMesh.Name);
+		mData.FaceCount = fileMesh.FaceCount;
+
+		mVertices = fileReader.Get<XMFLOAT3>(ModelFileSection::VertexData, fileMesh.Vertices);
+		mNormals = fileReader.Get<XMFLOAT3>(ModelFileSection::VertexData, fileMesh.Normals);
+		mTangents = fileReader.Get<XMFLOAT3>(ModelFileSection::VertexData, fileMesh.Tangents);
+		mBiNormals = fileReader.Get<XMFLOAT3>(ModelFileSection::VertexData, fileMesh.BiNormals);
+		mIndices = fileReader.Get<uint32_t>(ModelFileSection::Indices, fileMesh.Indices);
+
+		const uint32_t textureCoordinateSetCount = min(fileMesh.TextureCoordinateSetCount, ModelFileMaxVertexSets);
+		mTextureCoordinates.reserve(textureCoordinateSetCount);
+		for (uint32_t i = 0; i < textureCoordinateSetCount; i++)
+		{
+			mTextureCoordinates.push_back(fileReader.Get<XMFLOAT3>(ModelFileSection::VertexData, fileMesh.TextureCoordinates[i]));
+		}
+
+		const uint32_t vertexColorSetCount = min(fileMesh.VertexColorSetCount, ModelFileMaxVertexSets);
+		mVertexColors.reserve(vertexColorSetCount);
+		for (uint32_t i = 0; i < vertexColorSetCount; i++)
+		{
+			mVertexColors.push_back(fileReader.Get<XMFLOAT4>(ModelFileSection::VertexData, fileMesh.VertexColors[i]));
+		}
+
+		// BoneVertexWeights owns its weights, so these are still expanded on load
+		const auto boneWeights = fileReader.Get<ModelFileBoneWeights>(ModelFileSection::BoneWeights, fileMesh.BoneWeights);
+		mData.BoneWeights.resize(boneWeights.size());
+		for (size_t i = 0; i < mData.BoneWeights.size(); i++)
+		{
+			const ModelFileBoneWeights& vertexWeights = boneWeights[i];
+			const uint32_t weightCount = min(vertexWeights.Count, static_cast<uint32_t>(BoneVertexWeights::MaxBoneWeightsPerVertex));
+			for (uint32_t j = 0; j < weightCount; j++)
+			{
+				mData.BoneWeights[i].AddWeight(vertexWeights.Weights[j], vertexWeights.BoneIndices[j]);
+			}
+		}
+
+		mLods.reserve(static_cast<size_t>(fileLods.size()) + 1);
+		mLods.push_back({ 0.0f, mData.FaceCount, 0U, mIndices });
+		for (const ModelFileMeshLod& fileLod : fileLods)
+		{
+			const MeshLod& previous = mLods.back();
+			const uint32_t startIndex = previous.StartIndex + narrow_cast<uint32_t>(previous.Indices.size());
+			mLods.push_back({ fileLod.Error, fileLod.FaceCount, startIndex, fileReader.Get<uint32_t>(ModelFileSection::Indices, fileLod.Indices) });
+		}
+
+		if (quantizedMesh != nullptr)
+		{
+			DecodeQuantizedStreams(fileReader, *quantizedMesh);
+			BindStreams();
+		}
+	}
+
+	Mesh::Mesh(const Mesh& rhs) :
+		mModel(rhs.mModel), mData(rhs.mData), mStorage(rhs.mStorage),
+		mVertices(rhs.mVertices), mNormals(rhs.mNormals), mTangents(rhs.mTangents), mBiNormals(rhs.mBiNormals),
+		mTextureCoordinates(rhs.mTextureCoordinates), mVertexColors(rhs.mVertexColors), mIndices(rhs.mIndices), mLods(rhs.mLods), mMeshlets(rhs.mMeshlets)
+	{
+		BindStreams();
+	}
+
+	Mesh& Mesh::operator=(const Mesh& rhs)
+	{
+		if (this != &rhs)
+		{
+			Mesh copy(rhs);
+			*this = move(copy);
+		}
+
+		return *this;
+	}
+
+	void Mesh::BindStreams()
+	{
+		// Mapped meshes keep pointing at the shared mapping, apart from quantized streams decoded into their own vectors.
+		// Owned meshes view their own vectors.
+		if (mStorage != nullptr)
+		{
+			BindDecodedStream(mVertices, mData.Vertices);
+			BindDecodedStream(mNormals, mData.Normals);
+			BindDecodedStream(mTangents, mData.Tangents);
+			BindDecodedStream(mBiNormals, mData.BiNormals);
+			for (size_t i = 0; i < min(mData.TextureCoordinates.size(), mTextureCoordinates.size()); i++)
+			{
+				BindDecodedStream(mTextureCoordinates[i], mData.TextureCoordinates[i]);
+			}
+
+			return;
+		}
+
+		mVertices = mData.Vertices;
+		mNormals = mData.Normals;
+		mTangents = mData.Tangents;
+		mBiNormals = mData.BiNormals;
+		mIndices = mData.Indices;
+		mMeshlets = mData.Meshlets;
+
+		mTextureCoordinates.assign(mData.TextureCoordinates.begin(), mData.TextureCoordinates.end());
+		mVertexColors.assign(mData.VertexColors.begin(), mData.VertexColors.end());
+
+		BindLods();
+	}
+
+	void Mesh::BindLods()
+	{
+		mLods.clear();
+		mLods.reserve(mData.Lods.size() + 1);
+		mLods.push_back({ 0.0f, mData.FaceCount, 0U, mIndices });
+		for (const MeshLodData& lod : mData.Lods)
+		{
+			const MeshLod& previous = mLods.back();
+			const uint32_t startIndex = previous.StartIndex + narrow_cast<uint32_t>(previous.Indices.size());
+			mLods.push_back({ lod.Error, lod.FaceCount, startIndex, lod.Indices });
+		}
 	}
 
 	Model& Mesh::GetModel()
@@ -38,34 +187,34 @@ namespace Library
 		return mData.Name;
 	}
 
-	const vector<XMFLOAT3>& Mesh::Vertices() const
+	span<const XMFLOAT3> Mesh::Vertices() const
 	{
-		return mData.Vertices;
+		return mVertices;
 	}
 
-	const vector<XMFLOAT3>& Mesh::Normals() const
+	span<const XMFLOAT3> Mesh::Normals() const
 	{
-		return mData.Normals;
+		return mNormals;
 	}
 
-	const vector<XMFLOAT3>& Mesh::Tangents() const
+	span<const XMFLOAT3> Mesh::Tangents() const
 	{
-		return mData.Tangents;
+		return mTangents;
 	}
 
-	const vector<XMFLOAT3>& Mesh::BiNormals() const
+	span<const XMFLOAT3> Mesh::BiNormals() const
 	{
-		return mData.BiNormals;
+		return mBiNormals;
 	}
 
-	const vector<vector<XMFLOAT3>>& Mesh::TextureCoordinates() const
+	const vector<span<const XMFLOAT3>>& Mesh::TextureCoordinates() const
 	{
-		return mData.TextureCoordinates;
+		return mTextureCoordinates;
 	}
 
-	const vector<vector<XMFLOAT4>>& Mesh::VertexColors() const
+	const vector<span<const XMFLOAT4>>& Mesh::VertexColors() const
 	{
-		return mData.VertexColors;
+		return mVertexColors;
 	}
 
 	uint32_t Mesh::FaceCount() const
@@ -73,9 +222,9 @@ namespace Library
 		return mData.FaceCount;
 	}
 
-	const vector<uint32_t>& Mesh::Indices() const
+	span<const uint32_t> Mesh::Indices() const
 	{
-		return mData.Indices;
+		return mIndices;
 	}
 
 	const vector<BoneVertexWeights>& Mesh::BoneWeights() const
@@ -83,15 +232,53 @@ namespace Library
 		return mData.BoneWeights;
 	}
 
+	const vector<MeshLod>& Mesh::Lods() const
+	{
+		return mLods;
+	}
+
+	uint32_t Mesh::SelectLod(float pixelsPerUnit, float maxScreenError) const
+	{
+		// Errors grow with the level, so take the coarsest one that still projects under the threshold
+		for (size_t level = mLods.size() - 1; level > 0; --level)
+		{
+			if (mLods[level].Error * pixelsPerUnit <= maxScreenError)
+			{
+				return narrow_cast<uint32_t>(level);
+			}
+		}
+
+		return 0;
+	}
+
+	span<const Meshlet> Mesh::Meshlets() const
+	{
+		return mMeshlets;
+	}
+
 	void Mesh::CreateIndexBuffer(ID3D11Device& device, gsl::not_null<ID3D11Buffer**> indexBuffer)
 	{
+		span<const uint32_t> indices = mIndices;
+		vector<uint32_t> lodIndices;
+		if (mLods.size() > 1)
+		{
+			const MeshLod& lastLod = mLods.back();
+			lodIndices.reserve(lastLod.StartIndex + static_cast<size_t>(lastLod.Indices.size()));
+			for (const MeshLod& lod : mLods)
+			{
+				lodIndices.insert(lodIndices.end(), lod.Indices.begin(), lod.Indices.end());
+			}
+
+			indices = lodIndices;
+		}
+
 		D3D11_BUFFER_DESC indexBufferDesc{ 0 };
-		indexBufferDesc.ByteWidth = narrow_cast<uint32_t>(sizeof(uint32_t) * mData.Indices.size());
+		indexBufferDesc.ByteWidth = narrow_cast<uint32_t>(indices.size_bytes());
 		indexBufferDesc.Usage = D3D11_USAGE_IMMUTABLE;
 		indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
 
 		D3D11_SUBRESOURCE_DATA indexSubResourceData{ 0 };
-		indexSubResourceData.pSysMem = &mData.Indices[0];
+		indexSubResourceData.pSysMem = indices.data();
 
 		ThrowIfFailed(device.CreateBuffer(&indexBufferDesc, &indexSubResourceData, indexBuffer), "ID3D11Device::CreateBuffer() failed.");
 	}
@@ -105,75 +292,204 @@ namespace Library
 		streamHelper << mData.Name;
 
 		// Serialize vertices
-		streamHelper << narrow_cast<uint32_t>(mData.Vertices.size());
-		for (const XMFLOAT3& vertex : mData.Vertices)
+		streamHelper.WriteArray(mVertices);
+
+		// Serialize normals
+		streamHelper.WriteArray(mNormals);
+
+		// Serialize tangents
+		streamHelper.WriteArray(mTangents);
+
+		// Serialize binormals
+		streamHelper.WriteArray(mBiNormals);
+
+		// Serialize texture coordinates
+		streamHelper << narrow_cast<uint32_t>(mTextureCoordinates.size());
+		for (const auto& uvList : mTextureCoordinates)
 		{
-			streamHelper << vertex.x << vertex.y << vertex.z;
+			streamHelper.WriteArray(uvList);
 		}
 
-		// Serialize normals
-		streamHelper << narrow_cast<uint32_t>(mData.Normals.size());
-		for (const XMFLOAT3& normal : mData.Normals)
+		// Serialize vertex colors
+		streamHelper << narrow_cast<uint32_t>(mVertexColors.size());
+		for (const auto& vertexColorList : mVertexColors)
 		{
-			streamHelper << normal.x << normal.y << normal.z;
+			streamHelper.WriteArray(vertexColorList);
 		}
 
-		// Serialize tangents
-		streamHelper << narrow_cast<uint32_t>(mData.Tangents.size());
-		for (const XMFLOAT3& tangents : mData.Tangents)
+		// Serialize indices (version 1 files have no LODs or meshlets, so only the full-detail level is written)
+		streamHelper << mData.FaceCount;
+		streamHelper.WriteArray(mIndices);
+
+		// Serialize bone weights
+		streamHelper << narrow_cast<uint32_t>(mData.BoneWeights.size());
+		vector<SerializedVertexWeight> weights;
+		for (const BoneVertexWeights& boneVertexWeight : mData.BoneWeights)
 		{
-			streamHelper << tangents.x << tangents.y << tangents.z;
+			weights.clear();
+			for (const BoneVertexWeights::VertexWeight& weight : boneVertexWeight.Weights())
+			{
+				weights.push_back({ weight.Weight, weight.BoneIndex });
+			}
+
+			streamHelper.WriteArray(weights);
 		}
+	}
 
-		// Serialize binormals
-		streamHelper << narrow_cast<uint32_t>(mData.BiNormals.size());
-		for (const XMFLOAT3& binormal : mData.BiNormals)
+	ModelFileMesh Mesh::Save(ModelFileWriter& fileWriter, ModelFileQuantizedMesh* quantizedMesh) const
+	{
+		if (mTextureCoordinates.size() > ModelFileMaxVertexSets || mVertexColors.size() > ModelFileMaxVertexSets)
 		{
-			streamHelper << binormal.x << binormal.y << binormal.z;
+			throw GameException("Mesh has more vertex sets than the model file supports.");
 		}
 
-		// Serialize texture coordinates
-		streamHelper << narrow_cast<uint32_t>(mData.TextureCoordinates.size());
-		for (const auto& uvList : mData.TextureCoordinates)
+		ModelFileMesh fileMesh{ };
+		fileMesh.MaterialIndex = -1;
+		const auto& materials = mModel->Materials();
+		auto material = find(materials.begin(), materials.end(), mData.Material);
+		if (material != materials.end())
 		{
-			streamHelper << narrow_cast<uint32_t>(uvList.size());
-			for (const XMFLOAT3& uv : uvList)
+			fileMesh.MaterialIndex = narrow<int32_t>(distance(materials.begin(), material));
+		}
+
+		fileMesh.Name = fileWriter.AddString(mData.Name);
+		fileMesh.FaceCount = mData.FaceCount;
+
+		// Streams that don't fit their quantized encoding (non-unit directions, 3D texture coordinates) stay at full precision
+		const bool quantize = (quantizedMesh != nullptr);
+		ModelFileQuantizedMesh unquantized{ };
+		ModelFileQuantizedMesh& quantized = (quantize ? *quantizedMesh : unquantized);
+		quantized = ModelFileQuantizedMesh{ };
+
+		if (quantize && mVertices.empty() == false)
+		{
+			vector<XMUSHORTN4> positions;
+			XMFLOAT3 offset;
+			XMFLOAT3 scale;
+			VertexQuantization::EncodePositions(mVertices, positions, offset, scale);
+			quantized.Positions = fileWriter.Append(ModelFileSection::VertexData, positions);
+			memcpy(quantized.PositionOffset, &offset, sizeof(quantized.PositionOffset));
+			memcpy(quantized.PositionScale, &scale, sizeof(quantized.PositionScale));
+			quantized.Streams |= ModelFileQuantizedPositions;
+		}
+		else
+		{
+			fileMesh.Vertices = fileWriter.Append(ModelFileSection::VertexData, mVertices);
+		}
+
+		const auto saveDirections = [&](span<const XMFLOAT3> directions, uint32_t stream, ModelFileRange& range, ModelFileRange& quantizedRange)
+		{
+			if (quantize && directions.empty() == false && VertexQuantization::CanEncodeDirections(directions))
+			{
+				vector<XMSHORTN2> encoded;
+				VertexQuantization::EncodeDirections(directions, encoded);
+				quantizedRange = fileWriter.Append(ModelFileSection::VertexData, encoded);
+				quantized.Streams |= stream;
+			}
+			else
 			{
-				streamHelper << uv.x << uv.y << uv.z;
+				range = fileWriter.Append(ModelFileSection::VertexData, directions);
+			}
+		};
+
+		saveDirections(mNormals, ModelFileQuantizedNormals, fileMesh.Normals, quantized.Normals);
+		saveDirections(mTangents, ModelFileQuantizedTangents, fileMesh.Tangents, quantized.Tangents);
+		saveDirections(mBiNormals, ModelFileQuantizedBiNormals, fileMesh.BiNormals, quantized.BiNormals);
+
+		fileMesh.TextureCoordinateSetCount = narrow<uint32_t>(mTextureCoordinates.size());
+		for (size_t i = 0; i < mTextureCoordinates.size(); i++)
+		{
+			if (quantize && mTextureCoordinates[i].empty() == false && VertexQuantization::CanEncodeTextureCoordinates(mTextureCoordinates[i]))
+			{
+				vector<XMHALF2> encoded;
+				VertexQuantization::EncodeTextureCoordinates(mTextureCoordinates[i], encoded);
+				quantized.TextureCoordinates[i] = fileWriter.Append(ModelFileSection::VertexData, encoded);
+				quantized.Streams |= (ModelFileQuantizedTextureCoordinates << i);
+			}
+			else
+			{
+				fileMesh.TextureCoordinates[i] = fileWriter.Append(ModelFileSection::VertexData, mTextureCoordinates[i]);
 			}
 		}
 
-		// Serialize vertex colors
-		streamHelper << narrow_cast<uint32_t>(mData.VertexColors.size());
-		for (const auto& vertexColorList : mData.VertexColors)
+		fileMesh.VertexColorSetCount = narrow<uint32_t>(mVertexColors.size());
+		for (size_t i = 0; i < mVertexColors.size(); i++)
 		{
-			streamHelper << vertexColorList.size();
-			for (const XMFLOAT4& vertexColor : vertexColorList)
+			fileMesh.VertexColors[i] = fileWriter.Append(ModelFileSection::VertexData, mVertexColors[i]);
+		}
+
+		fileMesh.Indices = fileWriter.Append(ModelFileSection::Indices, mIndices);
+
+		vector<ModelFileBoneWeights> boneWeights;
+		boneWeights.reserve(mData.BoneWeights.size());
+		for (const BoneVertexWeights& vertexWeights : mData.BoneWeights)
+		{
+			ModelFileBoneWeights fileWeights{ };
+			fileWeights.Count = narrow<uint32_t>(min<size_t>(vertexWeights.Weights().size(), BoneVertexWeights::MaxBoneWeightsPerVertex));
+			for (uint32_t j = 0; j < fileWeights.Count; j++)
 			{
-				streamHelper << vertexColor.x << vertexColor.y << vertexColor.z << vertexColor.w;
+				fileWeights.Weights[j] = vertexWeights.Weights()[j].Weight;
+				fileWeights.BoneIndices[j] = vertexWeights.Weights()[j].BoneIndex;
 			}
+
+			boneWeights.push_back(fileWeights);
 		}
+		fileMesh.BoneWeights = fileWriter.Append(ModelFileSection::BoneWeights, boneWeights);
 
-		// Serialize indices
-		streamHelper << mData.FaceCount;
-		streamHelper << narrow_cast<uint32_t>(mData.Indices.size());
-		for (const uint32_t& index : mData.Indices)
+		return fileMesh;
+	}
+
+	void Mesh::DecodeQuantizedStreams(const ModelFileReader& fileReader, const ModelFileQuantizedMesh& quantizedMesh)
+	{
+		if ((quantizedMesh.Streams & ModelFileQuantizedPositions) != 0)
 		{
-			streamHelper << index;
+			const XMFLOAT3 offset(quantizedMesh.PositionOffset);
+			const XMFLOAT3 scale(quantizedMesh.PositionScale);
+			VertexQuantization::DecodePositions(fileReader.Get<XMUSHORTN4>(ModelFileSection::VertexData, quantizedMesh.Positions), offset, scale, mData.Vertices);
 		}
 
-		// Serialize bone weights
-		streamHelper << narrow_cast<uint32_t>(mData.BoneWeights.size());
-		for (const BoneVertexWeights& boneVertexWeight : mData.BoneWeights)
+		if ((quantizedMesh.Streams & ModelFileQuantizedNormals) != 0)
 		{
-			streamHelper << narrow_cast<uint32_t>(boneVertexWeight.Weights().size());
-			for (const BoneVertexWeights::VertexWeight& weight : boneVertexWeight.Weights())
+			VertexQuantization::DecodeDirections(fileReader.Get<XMSHORTN2>(ModelFileSection::VertexData, quantizedMesh.Normals), mData.Normals);
+		}
+
+		if ((quantizedMesh.Streams & ModelFileQuantizedTangents) != 0)
+		{
+			VertexQuantization::DecodeDirections(fileReader.Get<XMSHORTN2>(ModelFileSection::VertexData, quantizedMesh.Tangents), mData.Tangents);
+		}
+
+		if ((quantizedMesh.Streams & ModelFileQuantizedBiNormals) != 0)
+		{
+			VertexQuantization::DecodeDirections(fileReader.Get<XMSHORTN2>(ModelFileSection::VertexData, quantizedMesh.BiNormals), mData.BiNormals);
+		}
+
+		mData.TextureCoordinates.resize(mTextureCoordinates.size());
+		for (size_t i = 0; i < mTextureCoordinates.size(); i++)
+		{
+			if ((quantizedMesh.Streams & (ModelFileQuantizedTextureCoordinates << i)) != 0)
 			{
-				streamHelper << weight.Weight << weight.BoneIndex;
+				VertexQuantization::DecodeTextureCoordinates(fileReader.Get<XMHALF2>(ModelFileSection::VertexData, quantizedMesh.TextureCoordinates[i]), mData.TextureCoordinates[i]);
 			}
 		}
 	}
 
+	void Mesh::SaveLods(ModelFileWriter& fileWriter, uint32_t meshIndex, vector<ModelFileMeshLod>& fileLods) const
+	{
+		for (size_t level = 1; level < mLods.size(); level++)
+		{
+			const MeshLod& lod = mLods[level];
+			fileLods.push_back({ meshIndex, lod.FaceCount, lod.Error, 0U, fileWriter.Append(ModelFileSection::Indices, lod.Indices) });
+		}
+	}
+
+	void Mesh::SaveMeshlets(ModelFileWriter& fileWriter, uint32_t meshIndex, vector<ModelFileMeshlets>& fileMeshlets) const
+	{
+		if (mMeshlets.empty() == false)
+		{
+			fileMeshlets.push_back({ meshIndex, 0U, fileWriter.Append(ModelFileSection::Meshlets, mMeshlets) });
+		}
+	}
+
 	void Mesh::Load(InputStreamHelper& streamHelper)
 	{
 		// Deserialize material reference
@@ -195,56 +511,16 @@ namespace Library
 		streamHelper >> mData.Name;
 
 		// Deserialize vertices
-		{
-			uint32_t vertexCount;
-			streamHelper >> vertexCount;
-			mData.Vertices.reserve(vertexCount);
-			for (uint32_t i = 0; i < vertexCount; i++)
-			{
-				XMFLOAT3 vertex;
-				streamHelper >> vertex.x >> vertex.y >> vertex.z;
-				mData.Vertices.push_back(vertex);
-			}
-		}
+		streamHelper.ReadArray(mData.Vertices);
 
 		// Deserialize normals
-		{
-			uint32_t normalCount;
-			streamHelper >> normalCount;
-			mData.Normals.reserve(normalCount);
-			for (uint32_t i = 0; i < normalCount; i++)
-			{
-				XMFLOAT3 normal;
-				streamHelper >> normal.x >> normal.y >> normal.z;
-				mData.Normals.push_back(normal);
-			}
-		}
+		streamHelper.ReadArray(mData.Normals);
 
 		// Deserialize tangents
-		{
-			uint32_t tangentCount;
-			streamHelper >> tangentCount;
-			mData.Tangents.reserve(tangentCount);
-			for (uint32_t i = 0; i < tangentCount; i++)
-			{
-				XMFLOAT3 tangent;
-				streamHelper >> tangent.x >> tangent.y >> tangent.z;
-				mData.Tangents.push_back(tangent);
-			}
-		}
+		streamHelper.ReadArray(mData.Tangents);
 
 		// Deserialize binormals
-		{
-			uint32_t binormalCount;
-			streamHelper >> binormalCount;
-			mData.BiNormals.reserve(binormalCount);
-			for (uint32_t i = 0; i < binormalCount; i++)
-			{
-				XMFLOAT3 binormal;
-				streamHelper >> binormal.x >> binormal.y >> binormal.z;
-				mData.BiNormals.push_back(binormal);
-			}
-		}
+		streamHelper.ReadArray(mData.BiNormals);
 
 		// Deserialize texture coordinates
 		{
@@ -253,19 +529,10 @@ namespace Library
 			mData.TextureCoordinates.reserve(textureCoordinateCount);
 			for (uint32_t i = 0; i < textureCoordinateCount; i++)
 			{
-				uint32_t uvListCount;
-				streamHelper >> uvListCount;
-				if (uvListCount > 0)
+				vector<XMFLOAT3> uvs;
+				streamHelper.ReadArray(uvs);
+				if (uvs.size() > 0)
 				{
-					std::vector<XMFLOAT3> uvs;
-					uvs.reserve(uvListCount);
-					for (uint32_t j = 0; j < uvListCount; j++)
-					{
-						XMFLOAT3 uv;
-						streamHelper >> uv.x >> uv.y >> uv.z;
-						uvs.push_back(uv);
-					}
-
 					mData.TextureCoordinates.push_back(move(uvs));
 				}
 			}
@@ -278,55 +545,31 @@ namespace Library
 			mData.VertexColors.reserve(vertexColorCount);
 			for (uint32_t i = 0; i < vertexColorCount; i++)
 			{
-				uint32_t vertexColorListCount;
-				streamHelper >> vertexColorListCount;
-				if (vertexColorListCount > 0)
+				vector<XMFLOAT4> vertexColors;
+				streamHelper.ReadArray(vertexColors);
+				if (vertexColors.size() > 0)
 				{
-					std::vector<XMFLOAT4> vertexColors;
-					vertexColors.reserve(vertexColorListCount);
-					for (uint32_t j = 0; j < vertexColorListCount; j++)
-					{
-						XMFLOAT4 vertexColor;
-						streamHelper >> vertexColor.x >> vertexColor.y >> vertexColor.z >> vertexColor.w;
-						vertexColors.push_back(vertexColor);
-					}
-
 					mData.VertexColors.push_back(move(vertexColors));
 				}
 			}
 		}
 
 		// Deserialize indexes	
-		{
-			streamHelper >> mData.FaceCount;
-			uint32_t indexCount;
-			streamHelper >> indexCount;
-			mData.Indices.reserve(indexCount);
-			for (uint32_t i = 0; i < indexCount; i++)
-			{
-				uint32_t index;
-				streamHelper >> index;
-				mData.Indices.push_back(index);
-			}
-		}
+		streamHelper >> mData.FaceCount;
+		streamHelper.ReadArray(mData.Indices);
 
 		// Deserialize bone weights
 		{
 			uint32_t boneVertexWeightCount;
 			streamHelper >> boneVertexWeightCount;
 			mData.BoneWeights.resize(boneVertexWeightCount);
+			vector<SerializedVertexWeight> weights;
 			for (uint32_t i = 0; i < boneVertexWeightCount; i++)
 			{
-				uint32_t weightCount;
-				streamHelper >> weightCount;
-				mData.BoneWeights.reserve(weightCount);
-				for (uint32_t j = 0; j < weightCount; j++)
+				streamHelper.ReadArray(weights);
+				for (const SerializedVertexWeight& weight : weights)
 				{
-					float weight;
-					uint32_t boneIndex;
-					streamHelper >> weight >> boneIndex;
-
-					mData.BoneWeights[i].AddWeight(weight, boneIndex);
+					mData.BoneWeights[i].AddWeight(weight.Weight, weight.BoneIndex);
 				}
 			}
 		}
@@ -3,6 +3,7 @@
 #include <gsl\gsl>
 #include <d3d11.h>
 #include "Bone.h"
+#include "Meshlet.h"
 
 namespace Library
 {
@@ -11,6 +12,28 @@ namespace Library
     class ModelMaterial;
 	class OutputStreamHelper;
 	class InputStreamHelper;
+	class ModelFileWriter;
+	class ModelFileReader;
+	struct ModelFileMesh;
+	struct ModelFileMeshLod;
+	struct ModelFileMeshlets;
+	struct ModelFileQuantizedMesh;
+
+	// A simplified triangle list over the same vertex streams as the full-detail mesh
+	struct MeshLodData final
+	{
+		float Error{ 0.0f };	// Object-space deviation from the full-detail surface
+		std::uint32_t FaceCount{ 0 };
+		std::vector<std::uint32_t> Indices;
+	};
+
+	struct MeshLod final
+	{
+		float Error;
+		std::uint32_t FaceCount;
+		std::uint32_t StartIndex;	// Offset of this level in the index buffer built by CreateIndexBuffer()
+		gsl::span<const std::uint32_t> Indices;
+	};
 
 	struct MeshData final
 	{
@@ -25,6 +48,8 @@ namespace Library
 		std::uint32_t FaceCount{ 0 };
 		std::vector<std::uint32_t> Indices;
 		std::vector<BoneVertexWeights> BoneWeights;
+		std::vector<MeshLodData> Lods;	// Coarser levels only, ordered by increasing error
+		std::vector<Meshlet> Meshlets;	// Cover the full-detail indices in order
 	};
 
     class Mesh final
@@ -32,9 +57,10 @@ namespace Library
     public:
 		Mesh(Library::Model& model, InputStreamHelper& streamHelper);
 		Mesh(Library::Model& model, MeshData&& meshData);
-		Mesh(const Mesh&) = default;
+		Mesh(Library::Model& model, const ModelFileReader& fileReader, const ModelFileMesh& fileMesh, gsl::span<const ModelFileMeshLod> fileLods, gsl::span<const Meshlet> meshlets, const ModelFileQuantizedMesh* quantizedMesh);
+		Mesh(const Mesh& rhs);
 		Mesh(Mesh&&) = default;
-		Mesh& operator=(const Mesh&) = default;
+		Mesh& operator=(const Mesh& rhs);
 		Mesh& operator=(Mesh&&) = default;
 		~Mesh() = default;
 
@@ -42,23 +68,48 @@ namespace Library
         std::shared_ptr<ModelMaterial> GetMaterial();
         const std::string& Name() const;
 
-		const std::vector<DirectX::XMFLOAT3>& Vertices() const;
-		const std::vector<DirectX::XMFLOAT3>& Normals() const;
-		const std::vector<DirectX::XMFLOAT3>& Tangents() const;
-		const std::vector<DirectX::XMFLOAT3>& BiNormals() const;
-		const std::vector<std::vector<DirectX::XMFLOAT3>>& TextureCoordinates() const;
-		const std::vector<std::vector<DirectX::XMFLOAT4>>& VertexColors() const;
+		// Vertex streams and indices view either the mesh's own MeshData or, for meshes loaded from a mapped v2 file, the mapping itself
+		gsl::span<const DirectX::XMFLOAT3> Vertices() const;
+		gsl::span<const DirectX::XMFLOAT3> Normals() const;
+		gsl::span<const DirectX::XMFLOAT3> Tangents() const;
+		gsl::span<const DirectX::XMFLOAT3> BiNormals() const;
+		const std::vector<gsl::span<const DirectX::XMFLOAT3>>& TextureCoordinates() const;
+		const std::vector<gsl::span<const DirectX::XMFLOAT4>>& VertexColors() const;
 		std::uint32_t FaceCount() const;
-		const std::vector<std::uint32_t>& Indices() const;
+		gsl::span<const std::uint32_t> Indices() const;
 		const std::vector<BoneVertexWeights>& BoneWeights() const;
 
+		// Level 0 is the full-detail mesh
+		const std::vector<MeshLod>& Lods() const;
+		std::uint32_t SelectLod(float pixelsPerUnit, float maxScreenError = 1.0f) const;
+
+		gsl::span<const Meshlet> Meshlets() const;
+
+		// Every level is appended to the same buffer; draw a level with its FaceCount and StartIndex
         void CreateIndexBuffer(ID3D11Device& device, gsl::not_null<ID3D11Buffer**> indexBuffer);
 		void Save(OutputStreamHelper& streamHelper) const;
+		// With quantizedMesh, every stream that fits its quantized encoding is written that way and recorded there instead
+		ModelFileMesh Save(ModelFileWriter& fileWriter, ModelFileQuantizedMesh* quantizedMesh = nullptr) const;
+		void SaveLods(ModelFileWriter& fileWriter, std::uint32_t meshIndex, std::vector<ModelFileMeshLod>& fileLods) const;
+		void SaveMeshlets(ModelFileWriter& fileWriter, std::uint32_t meshIndex, std::vector<ModelFileMeshlets>& fileMeshlets) const;
 
     private:
 		void Load(InputStreamHelper& streamHelper);
+		void BindStreams();
+		void BindLods();
+		void DecodeQuantizedStreams(const ModelFileReader& fileReader, const ModelFileQuantizedMesh& quantizedMesh);
 
         gsl::not_null<Library::Model*> mModel;
 		MeshData mData;
+		std::shared_ptr<const void> mStorage;
+		gsl::span<const DirectX::XMFLOAT3> mVertices;
+		gsl::span<const DirectX::XMFLOAT3> mNormals;
+		gsl::span<const DirectX::XMFLOAT3> mTangents;
+		gsl::span<const DirectX::XMFLOAT3> mBiNormals;
+		std::vector<gsl::span<const DirectX::XMFLOAT3>> mTextureCoordinates;
+		std::vector<gsl::span<const DirectX::XMFLOAT4>> mVertexColors;
+		gsl::span<const std::uint32_t> mIndices;
+		std::vector<MeshLod> mLods;
+		gsl::span<const Meshlet> mMeshlets;
     };
 }
\ No newline at end of file
@@ -0,0 +1,296 @@
+#include "pch.h"
+#include "MeshSkinner.h"
+#include "Mesh.h"
+#include "Bone.h"
+#include "ThreadPool.h"
+#include "GameException.h"
+#include <future>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	MeshSkinner::MeshSkinner(const Mesh& mesh) :
+		mVertices(mesh.Vertices()), mNormals(mesh.Normals())
+	{
+		const auto& boneWeights = mesh.BoneWeights();
+		if (boneWeights.size() != static_cast<size_t>(mVertices.size()))
+		{
+			throw GameException("Mesh needs bone weights for every vertex to be skinned.");
+		}
+
+		mInfluences.resize(boneWeights.size());
+		for (size_t i = 0; i < boneWeights.size(); i++)
+		{
+			Influences& influences = mInfluences[i];
+			const auto& weights = boneWeights[i].Weights();
+			uint32_t usedSlots = 0;
+			for (size_t weight = 0; weight < weights.size() && usedSlots < BoneInfluenceCount; ++weight)
+			{
+				if (weights[weight].Weight > 0.0f)
+				{
+					influences.BoneIndices[usedSlots] = weights[weight].BoneIndex;
+					influences.Weights[usedSlots] = weights[weight].Weight;
+					++usedSlots;
+				}
+			}
+
+			for (uint32_t slot = usedSlots; slot < BoneInfluenceCount; ++slot)
+			{
+				influences.BoneIndices[slot] = 0;
+				influences.Weights[slot] = 0.0f;
+			}
+		}
+	}
+
+	uint32_t MeshSkinner::VertexCount() const
+	{
+		return narrow_cast<uint32_t>(mVertices.size());
+	}
+
+	void MeshSkinner::Skin(span<const XMFLOAT4X4> boneTransforms, SkinnedVertices& result, SkinningMethod method, ThreadPool* threadPool) const
+	{
+		assert(all_of(mInfluences.begin(), mInfluences.end(), [&boneTransforms](const Influences& influences)
+		{
+			for (uint32_t slot = 0; slot < BoneInfluenceCount; ++slot)
+			{
+				if (influences.Weights[slot] > 0.0f && influences.BoneIndices[slot] >= static_cast<uint32_t>(boneTransforms.size()))
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}));
+
+		const uint32_t vertexCount = VertexCount();
+		result.Positions.resize(vertexCount);
+		result.Normals.resize(mNormals.size());
+		if (vertexCount == 0)
+		{
+			result.Minimum = result.Maximum = XMFLOAT3(0.0f, 0.0f, 0.0f);
+			return;
+		}
+
+		// Dual quaternions are built once per bone rather than per influence
+		vector<XMFLOAT4> rotations;
+		vector<XMFLOAT4> duals;
+		if (method == SkinningMethod::DualQuaternion)
+		{
+			rotations.resize(boneTransforms.size());
+			duals.resize(boneTransforms.size());
+			for (size_t bone = 0; bone < rotations.size(); bone++)
+			{
+				XMVECTOR scale;
+				XMVECTOR rotation;
+				XMVECTOR translation;
+				XMMatrixDecompose(&scale, &rotation, &translation, XMLoadFloat4x4(&boneTransforms[bone]));
+
+				// The dual part is half the translation (as a pure quaternion) times the rotation
+				XMStoreFloat4(&rotations[bone], rotation);
+				XMStoreFloat4(&duals[bone], XMVectorScale(XMQuaternionMultiply(rotation, XMVectorSetW(translation, 0.0f)), 0.5f));
+			}
+		}
+
+		const uint32_t jobCount = (threadPool != nullptr ? (vertexCount + VerticesPerJob - 1) / VerticesPerJob : 1U);
+		const uint32_t verticesPerJob = (threadPool != nullptr ? VerticesPerJob : vertexCount);
+		vector<XMFLOAT3> minimums(jobCount);
+		vector<XMFLOAT3> maximums(jobCount);
+
+		auto skinRange = [&](uint32_t job)
+		{
+			const uint32_t first = job * verticesPerJob;
+			const uint32_t last = min(first + verticesPerJob, vertexCount);
+			if (method == SkinningMethod::DualQuaternion)
+			{
+				SkinDualQuaternion(rotations, duals, first, last, result, minimums[job], maximums[job]);
+			}
+			else
+			{
+				SkinLinearBlend(boneTransforms, first, last, result, minimums[job], maximums[job]);
+			}
+		};
+
+		// Each job writes its own range of vertices and its own bounds, which are merged once every job is done
+		vector<future<void>> jobs;
+		for (uint32_t job = 1; job < jobCount; ++job)
+		{
+			auto request = make_shared<promise<void>>();
+			jobs.push_back(request->get_future());
+
+			threadPool->Enqueue([request, &skinRange, job]
+			{
+				try
+				{
+					skinRange(job);
+					request->set_value();
+				}
+				catch (...)
+				{
+					request->set_exception(current_exception());
+				}
+			});
+		}
+
+		// The calling thread takes the first range; every job references these locals, so all of them finish before
+		// an error is rethrown
+		exception_ptr error;
+		try
+		{
+			skinRange(0);
+		}
+		catch (...)
+		{
+			error = current_exception();
+		}
+
+		for (auto& job : jobs)
+		{
+			try
+			{
+				job.get();
+			}
+			catch (...)
+			{
+				if (error == nullptr)
+				{
+					error = current_exception();
+				}
+			}
+		}
+
+		if (error != nullptr)
+		{
+			rethrow_exception(error);
+		}
+
+		XMVECTOR minimum = XMLoadFloat3(&minimums[0]);
+		XMVECTOR maximum = XMLoadFloat3(&maximums[0]);
+		for (uint32_t job = 1; job < jobCount; ++job)
+		{
+			minimum = XMVectorMin(minimum, XMLoadFloat3(&minimums[job]));
+			maximum = XMVectorMax(maximum, XMLoadFloat3(&maximums[job]));
+		}
+
+		XMStoreFloat3(&result.Minimum, minimum);
+		XMStoreFloat3(&result.Maximum, maximum);
+	}
+
+	void MeshSkinner::SkinLinearBlend(span<const XMFLOAT4X4> boneTransforms, uint32_t first, uint32_t last, SkinnedVertices& result, XMFLOAT3& minimum, XMFLOAT3& maximum) const
+	{
+		const bool hasNormals = (mNormals.empty() == false);
+		XMVECTOR minimumVector = XMVectorReplicate(numeric_limits<float>::max());
+		XMVECTOR maximumVector = XMVectorReplicate(-numeric_limits<float>::max());
+
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const Influences& influences = mInfluences[i];
+			if (influences.Weights[0] <= 0.0f)
+			{
+				PassThrough(i, result, minimumVector, maximumVector);
+				continue;
+			}
+
+			// Blend the bone matrices first so each vertex is transformed once
+			XMMATRIX skinTransform = XMLoadFloat4x4(&boneTransforms[influences.BoneIndices[0]]);
+			const XMVECTOR weight = XMVectorReplicate(influences.Weights[0]);
+			for (int row = 0; row < 4; ++row)
+			{
+				skinTransform.r[row] = XMVectorMultiply(skinTransform.r[row], weight);
+			}
+
+			for (uint32_t slot = 1; slot < BoneInfluenceCount; ++slot)
+			{
+				if (influences.Weights[slot] > 0.0f)
+				{
+					const XMMATRIX boneTransform = XMLoadFloat4x4(&boneTransforms[influences.BoneIndices[slot]]);
+					const XMVECTOR slotWeight = XMVectorReplicate(influences.Weights[slot]);
+					for (int row = 0; row < 4; ++row)
+					{
+						skinTransform.r[row] = XMVectorMultiplyAdd(boneTransform.r[row], slotWeight, skinTransform.r[row]);
+					}
+				}
+			}
+
+			const XMVECTOR position = XMVector3Transform(XMLoadFloat3(&mVertices[i]), skinTransform);
+			XMStoreFloat3(&result.Positions[i], position);
+			minimumVector = XMVectorMin(minimumVector, position);
+			maximumVector = XMVectorMax(maximumVector, position);
+
+			if (hasNormals)
+			{
+				XMStoreFloat3(&result.Normals[i], XMVector3Normalize(XMVector3TransformNormal(XMLoadFloat3(&mNormals[i]), skinTransform)));
+			}
+		}
+
+		XMStoreFloat3(&minimum, minimumVector);
+		XMStoreFloat3(&maximum, maximumVector);
+	}
+
+	void MeshSkinner::SkinDualQuaternion(span<const XMFLOAT4> rotations, span<const XMFLOAT4> duals, uint32_t first, uint32_t last, SkinnedVertices& result, XMFLOAT3& minimum, XMFLOAT3& maximum) const
+	{
+		const bool hasNormals = (mNormals.empty() == false);
+		XMVECTOR minimumVector = XMVectorReplicate(numeric_limits<float>::max());
+		XMVECTOR maximumVector = XMVectorReplicate(-numeric_limits<float>::max());
+
+		for (uint32_t i = first; i < last; ++i)
+		{
+			const Influences& influences = mInfluences[i];
+			if (influences.Weights[0] <= 0.0f)
+			{
+				PassThrough(i, result, minimumVector, maximumVector);
+				continue;
+			}
+
+			const XMVECTOR pivot = XMLoadFloat4(&rotations[influences.BoneIndices[0]]);
+			XMVECTOR blendedRotation = XMVectorZero();
+			XMVECTOR blendedDual = XMVectorZero();
+
+			for (uint32_t slot = 0; slot < BoneInfluenceCount; ++slot)
+			{
+				if (influences.Weights[slot] > 0.0f)
+				{
+					// q and -q are the same rotation; blend every influence in the first one's hemisphere
+					const uint32_t boneIndex = influences.BoneIndices[slot];
+					const XMVECTOR rotation = XMLoadFloat4(&rotations[boneIndex]);
+					const float weight = (XMVectorGetX(XMVector4Dot(rotation, pivot)) < 0.0f ? -influences.Weights[slot] : influences.Weights[slot]);
+					blendedRotation = XMVectorMultiplyAdd(rotation, XMVectorReplicate(weight), blendedRotation);
+					blendedDual = XMVectorMultiplyAdd(XMLoadFloat4(&duals[boneIndex]), XMVectorReplicate(weight), blendedDual);
+				}
+			}
+
+			const XMVECTOR inverseLength = XMVector4ReciprocalLength(blendedRotation);
+			const XMVECTOR rotation = XMVectorMultiply(blendedRotation, inverseLength);
+			const XMVECTOR dual = XMVectorMultiply(blendedDual, inverseLength);
+			const XMVECTOR translation = XMVectorScale(XMQuaternionMultiply(XMQuaternionConjugate(rotation), dual), 2.0f);
+
+			const XMVECTOR position = XMVectorAdd(XMVector3Rotate(XMLoadFloat3(&mVertices[i]), rotation), translation);
+			XMStoreFloat3(&result.Positions[i], position);
+			minimumVector = XMVectorMin(minimumVector, position);
+			maximumVector = XMVectorMax(maximumVector, position);
+
+			if (hasNormals)
+			{
+				XMStoreFloat3(&result.Normals[i], XMVector3Normalize(XMVector3Rotate(XMLoadFloat3(&mNormals[i]), rotation)));
+			}
+		}
+
+		XMStoreFloat3(&minimum, minimumVector);
+		XMStoreFloat3(&maximum, maximumVector);
+	}
+
+	void MeshSkinner::PassThrough(uint32_t index, SkinnedVertices& result, XMVECTOR& minimum, XMVECTOR& maximum) const
+	{
+		const XMVECTOR position = XMLoadFloat3(&mVertices[index]);
+		result.Positions[index] = mVertices[index];
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
+
+		if (mNormals.empty() == false)
+		{
+			result.Normals[index] = mNormals[index];
+		}
+	}
+}
\ No newline at end of file
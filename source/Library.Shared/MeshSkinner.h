@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class Mesh;
+	class ThreadPool;
+
+	enum class SkinningMethod
+	{
+		LinearBlend,
+		DualQuaternion
+	};
+
+	struct SkinnedVertices final
+	{
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT3> Normals;		// Empty when the mesh has no normals
+		DirectX::XMFLOAT3 Minimum{ 0.0f, 0.0f, 0.0f };	// Tight bounds of the skinned positions
+		DirectX::XMFLOAT3 Maximum{ 0.0f, 0.0f, 0.0f };
+	};
+
+	// Skins a mesh on the CPU, for bounds, hit tests and processing with no GPU. The mesh's bone weights are packed into
+	// fixed slots of four once, when the skinner is built; the mesh must outlive it.
+	class MeshSkinner final
+	{
+	public:
+		inline static const std::uint32_t VerticesPerJob = 4096;
+
+		explicit MeshSkinner(const Mesh& mesh);
+		MeshSkinner(const MeshSkinner&) = default;
+		MeshSkinner(MeshSkinner&&) = default;
+		MeshSkinner& operator=(const MeshSkinner&) = default;
+		MeshSkinner& operator=(MeshSkinner&&) = default;
+		~MeshSkinner() = default;
+
+		std::uint32_t VertexCount() const;
+
+		// boneTransforms is a skinning palette by bone index, such as AnimationPlayer::BoneTransforms. Dual quaternion
+		// skinning ignores any scale in the palette. The palette must cover every bone the mesh is weighted to. With a
+		// thread pool, the vertices are split into jobs of VerticesPerJob.
+		void Skin(gsl::span<const DirectX::XMFLOAT4X4> boneTransforms, SkinnedVertices& result, SkinningMethod method = SkinningMethod::LinearBlend, ThreadPool* threadPool = nullptr) const;
+
+	private:
+		inline static const std::uint32_t BoneInfluenceCount = 4;
+
+		// Weighted slots come first and unused slots have zero weight, so a vertex with no weight in its first slot isn't
+		// skinned and passes through in bind pose
+		struct Influences final
+		{
+			std::uint32_t BoneIndices[BoneInfluenceCount];
+			float Weights[BoneInfluenceCount];
+		};
+
+		void SkinLinearBlend(gsl::span<const DirectX::XMFLOAT4X4> boneTransforms, std::uint32_t first, std::uint32_t last, SkinnedVertices& result, DirectX::XMFLOAT3& minimum, DirectX::XMFLOAT3& maximum) const;
+		void SkinDualQuaternion(gsl::span<const DirectX::XMFLOAT4> rotations, gsl::span<const DirectX::XMFLOAT4> duals, std::uint32_t first, std::uint32_t last, SkinnedVertices& result, DirectX::XMFLOAT3& minimum, DirectX::XMFLOAT3& maximum) const;
+
+		void PassThrough(std::uint32_t index, SkinnedVertices& result, DirectX::XMVECTOR& minimum, DirectX::XMVECTOR& maximum) const;
+
+		gsl::span<const DirectX::XMFLOAT3> mVertices;
+		gsl::span<const DirectX::XMFLOAT3> mNormals;
+		std::vector<Influences> mInfluences;
+	};
+}
\ No newline at end of file
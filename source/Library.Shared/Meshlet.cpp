@@ -0,0 +1,46 @@
+#include "pch.h"
+#include "Meshlet.h"
+#include "Frustum.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	static_assert(sizeof(Meshlet) == 48, "Meshlet is stored in model files as is.");
+
+	bool IsMeshletVisible(const Meshlet& meshlet, const Frustum& frustum, FXMVECTOR cameraPosition)
+	{
+		const XMVECTOR center = XMLoadFloat3(&meshlet.Center);
+
+		// Frustum planes face outward, so the bounding sphere is outside once it's more than its radius in front of any of them
+		const XMVECTOR planes[] = { frustum.NearVector(), frustum.FarVector(), frustum.LeftVector(), frustum.RightVector(), frustum.TopVector(), frustum.BottomVector() };
+		for (const XMVECTOR& plane : planes)
+		{
+			if (XMVectorGetX(XMPlaneDotCoord(plane, center)) > meshlet.Radius)
+			{
+				return false;
+			}
+		}
+
+		// Every triangle faces away once the camera is inside the normal cone mirrored through the bounding sphere
+		const XMVECTOR offset = XMVectorSubtract(center, cameraPosition);
+		const float distance = XMVectorGetX(XMVector3Length(offset));
+		const float alignment = XMVectorGetX(XMVector3Dot(offset, XMLoadFloat3(&meshlet.ConeAxis)));
+
+		return alignment < meshlet.ConeCutoff * distance + meshlet.Radius;
+	}
+
+	void CullMeshlets(span<const Meshlet> meshlets, const Frustum& frustum, const XMFLOAT3& cameraPosition, vector<uint32_t>& visibleMeshlets)
+	{
+		const XMVECTOR camera = XMLoadFloat3(&cameraPosition);
+		for (size_t i = 0; i < static_cast<size_t>(meshlets.size()); ++i)
+		{
+			if (IsMeshletVisible(meshlets[i], frustum, camera))
+			{
+				visibleMeshlets.push_back(narrow_cast<uint32_t>(i));
+			}
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class Frustum;
+
+	// A contiguous run of triangles in a mesh's full-detail index buffer, touching at most MaxVertices unique vertices.
+	// Bounds are in the mesh's object space.
+	struct Meshlet final
+	{
+		inline static const std::uint32_t MaxVertices = 64;
+		inline static const std::uint32_t MaxTriangles = 124;
+
+		std::uint32_t StartIndex;
+		std::uint32_t TriangleCount;
+		std::uint32_t VertexCount;
+		std::uint32_t Reserved;
+		DirectX::XMFLOAT3 Center;
+		float Radius;
+		DirectX::XMFLOAT3 ConeAxis;	// Zero when the triangles face too many ways for the meshlet to ever be backfacing
+		float ConeCutoff;
+	};
+
+	// The frustum and camera position must be in the mesh's object space; build the frustum from world * view * projection.
+	bool IsMeshletVisible(const Meshlet& meshlet, const Frustum& frustum, DirectX::FXMVECTOR cameraPosition);
+
+	// Appends the index of every meshlet that intersects the frustum and isn't entirely backfacing
+	void CullMeshlets(gsl::span<const Meshlet> meshlets, const Frustum& frustum, const DirectX::XMFLOAT3& cameraPosition, std::vector<std::uint32_t>& visibleMeshlets);
+}
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "GameException.h"
 #include "ModelMaterial.h"
 #include "AnimationClip.h"
+#include "MemoryMappedFile.h"
 
 using namespace std;
 using namespace gsl;
@@ -24,8 +25,13 @@ namespace Library
 		Load(file);
 	}
 
+	Model::Model(span<const uint8_t> data, const shared_ptr<const void>& owner)
+	{
+		Load(data, owner);
+	}
+
 	Model::Model(ModelData&& modelData) :
-		mData(move(modelData))
+		mData(move(modelData)), mSkeleton(mData.RootNode)
 	{
 	}
 
@@ -79,12 +85,48 @@ namespace Library
 		return mData.RootNode;
 	}
 
+	const Skeleton& Model::GetSkeleton() const
+	{
+		return mSkeleton;
+	}
+
 	ModelData& Model::Data()
 	{
 		return mData;
 	}
 
-	void Model::Save(const string& filename) const
+	uint32_t Model::SelectLod(float pixelsPerUnit, float maxScreenError) const
+	{
+		// Meshes with fewer levels clamp to their coarsest one, so it has to meet the threshold as well
+		uint32_t levelCount = 0;
+		for (const auto& mesh : mData.Meshes)
+		{
+			levelCount = max(levelCount, narrow_cast<uint32_t>(mesh->Lods().size()));
+		}
+
+		for (uint32_t level = levelCount; level-- > 1;)
+		{
+			const bool withinError = all_of(mData.Meshes.begin(), mData.Meshes.end(), [level, pixelsPerUnit, maxScreenError](const shared_ptr<Mesh>& mesh)
+			{
+				const auto& lods = mesh->Lods();
+				return lods[min<size_t>(level, lods.size() - 1)].Error * pixelsPerUnit <= maxScreenError;
+			});
+
+			if (withinError)
+			{
+				return level;
+			}
+		}
+
+		return 0;
+	}
+
+	float Model::PixelsPerUnit(float distance, float verticalFieldOfView, float viewportHeight)
+	{
+		return viewportHeight / (2.0f * max(distance, numeric_limits<float>::epsilon()) * tanf(verticalFieldOfView * 0.5f));
+	}
+
+	void Model::Save(const string& filename, ModelFileVersion version, bool quantize) const
 	{
 		ofstream file(filename.c_str(), ios::binary);
 		if (!file.good())
@@ -92,10 +134,27 @@ namespace Library
 			throw exception("Could not open file.");
 		}
 
-		Save(file);
+		Save(file, version, quantize);
+	}
+
+	void Model::Save(ofstream& file, ModelFileVersion version, bool quantize) const
+	{
+		if (version == ModelFileVersion::Mapped || version == ModelFileVersion::Quantized)
+		{
+			SaveMapped(file, quantize || version == ModelFileVersion::Quantized);
+		}
+		else
+		{
+			if (quantize)
+			{
+				throw exception("Quantized vertex streams and keyframes need a version 2 model file.");
+			}
+
+			SaveStream(file);
+		}
 	}
 
-	void Model::Save(ofstream& file) const
+	void Model::SaveStream(ofstream& file) const
 	{
 		OutputStreamHelper streamHelper(file);
 
@@ -136,19 +195,136 @@ namespace Library
 		}
 	}
 
+	void Model::SaveMapped(ofstream& file, bool quantize) const
+	{
+		ModelFileWriter fileWriter;
+		if (quantize)
+		{
+			fileWriter.SetVersion(ModelFileVersion::Quantized);
+		}
+
+		OutputStreamHelper& metadata = fileWriter.Metadata();
+
+		// Serialize materials
+		metadata << narrow_cast<uint32_t>(mData.Materials.size());
+		for (const auto& material : mData.Materials)
+		{
+			material->Save(metadata);
+		}
+
+		// Serialize meshes
+		vector<ModelFileMesh> meshes;
+		vector<ModelFileMeshLod> lods;
+		vector<ModelFileMeshlets> meshlets;
+		vector<ModelFileQuantizedMesh> quantizedMeshes;
+		meshes.reserve(mData.Meshes.size());
+		for (auto& mesh : mData.Meshes)
+		{
+			const uint32_t meshIndex = narrow_cast<uint32_t>(meshes.size());
+			mesh->SaveLods(fileWriter, meshIndex, lods);
+			mesh->SaveMeshlets(fileWriter, meshIndex, meshlets);
+
+			ModelFileQuantizedMesh quantizedMesh{ };
+			meshes.push_back(mesh->Save(fileWriter, quantize ? &quantizedMesh : nullptr));
+			if (quantize && quantizedMesh.Streams != 0)
+			{
+				quantizedMesh.MeshIndex = meshIndex;
+				quantizedMeshes.push_back(quantizedMesh);
+			}
+		}
+		fileWriter.Append(ModelFileSection::Meshes, meshes);
+		fileWriter.Append(ModelFileSection::Lods, lods);
+		fileWriter.Append(ModelFileSection::MeshletTable, meshlets);
+		fileWriter.Append(ModelFileSection::Quantization, quantizedMeshes);
+
+		// Serialize bones
+		metadata << narrow_cast<uint32_t>(mData.Bones.size());
+		for (auto& bone : mData.Bones)
+		{
+			bone->Save(metadata);
+		}
+
+		// Serialize skeleton hierachy
+		bool hasSkeleton = mData.RootNode != nullptr;
+		metadata << hasSkeleton;
+		if (hasSkeleton)
+		{
+			SaveSkeleton(metadata, mData.RootNode);
+		}
+
+		// Serialize animations
+		vector<ModelFileCompressedTrack> compressedTracks;
+		metadata << narrow_cast<uint32_t>(mData.Animations.size());
+		for (size_t animationIndex = 0; animationIndex < mData.Animations.size(); animationIndex++)
+		{
+			const size_t firstTrack = compressedTracks.size();
+			mData.Animations[animationIndex]->Save(metadata, &fileWriter, quantize ? &compressedTracks : nullptr);
+			for (size_t i = firstTrack; i < compressedTracks.size(); i++)
+			{
+				compressedTracks[i].AnimationIndex = narrow_cast<uint32_t>(animationIndex);
+			}
+		}
+		fileWriter.Append(ModelFileSection::CompressedTracks, compressedTracks);
+
+		fileWriter.Write(file);
+	}
+
 	void Model::Load(const string& filename)
 	{
-		ifstream file(filename.c_str(), ios::binary);
-		if (!file.good())
 		{
-			throw GameException("Could not open file.");
+			ifstream file(filename.c_str(), ios::binary);
+			if (!file.good())
+			{
+				throw GameException("Could not open file.");
+			}
+
+			if (ModelFileReader::HasSignature(file) == false)
+			{
+				Load(file);
+				return;
+			}
 		}
 
-		Load(file);
+		// Meshes keep the mapping alive for as long as they reference it
+		auto mappedFile = make_shared<MemoryMappedFile>(filename);
+		Load(ModelFileReader(mappedFile->Data(), mappedFile));
 	}
 
-	void Model::Load(ifstream& file)
+	void Model::Load(span<const uint8_t> data, const shared_ptr<const void>& owner)
 	{
+		uint32_t magic = 0;
+		if (static_cast<size_t>(data.size()) >= sizeof(magic))
+		{
+			memcpy(&magic, data.data(), sizeof(magic));
+		}
+
+		if (magic != ModelFileMagic)
+		{
+			istringstream stream(string(reinterpret_cast<const char*>(data.data()), static_cast<size_t>(data.size())), ios::binary);
+			Load(stream);
+			return;
+		}
+
+		if (owner == nullptr)
+		{
+			// Meshes reference the data in place, so it needs an owner that outlives them
+			auto buffer = make_shared<vector<uint8_t>>(data.begin(), data.end());
+			Load(ModelFileReader(span<const uint8_t>(*buffer), buffer));
+			return;
+		}
+
+		Load(ModelFileReader(data, owner));
+	}
+
+	void Model::Load(istream& file)
+	{
+		if (ModelFileReader::HasSignature(file))
+		{
+			auto buffer = make_shared<vector<uint8_t>>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+			Load(ModelFileReader(span<const uint8_t>(*buffer), buffer));
+			return;
+		}
+
 		InputStreamHelper streamHelper(file);
 
 		// Desrialize materials
@@ -187,6 +363,8 @@ namespace Library
 			mData.RootNode = LoadSkeleton(streamHelper, nullptr);
 		}
 
+		mSkeleton = Skeleton(mData.RootNode);
+
 		// Deserialize animations
 		uint32_t animationCount;
 		streamHelper >> animationCount;
@@ -198,6 +376,88 @@ namespace Library
 		}
 	}
 
+	void Model::Load(const ModelFileReader& fileReader)
+	{
+		const span<const uint8_t> metadataSection = fileReader.Section(ModelFileSection::Metadata);
+		istringstream metadataStream(string(metadataSection.begin(), metadataSection.end()), ios::binary);
+		InputStreamHelper metadata(metadataStream);
+
+		// Desrialize materials
+		uint32_t materialCount;
+		metadata >> materialCount;
+		mData.Materials.reserve(materialCount);
+		for (uint32_t i = 0; i < materialCount; i++)
+		{
+			mData.Materials.emplace_back(make_shared<ModelMaterial>(*this, metadata));
+		}
+
+		// Desrialize meshes
+		const span<const uint8_t> meshSection = fileReader.Section(ModelFileSection::Meshes);
+		const auto meshes = fileReader.Get<ModelFileMesh>(ModelFileSection::Meshes, ModelFileRange{ 0, static_cast<uint64_t>(meshSection.size()) / sizeof(ModelFileMesh) });
+		const span<const uint8_t> lodSection = fileReader.Section(ModelFileSection::Lods);
+		const auto lods = fileReader.Get<ModelFileMeshLod>(ModelFileSection::Lods, ModelFileRange{ 0, static_cast<uint64_t>(lodSection.size()) / sizeof(ModelFileMeshLod) });
+		const span<const uint8_t> meshletTableSection = fileReader.Section(ModelFileSection::MeshletTable);
+		const auto meshletTable = fileReader.Get<ModelFileMeshlets>(ModelFileSection::MeshletTable, ModelFileRange{ 0, static_cast<uint64_t>(meshletTableSection.size()) / sizeof(ModelFileMeshlets) });
+		const span<const uint8_t> quantizationSection = fileReader.Section(ModelFileSection::Quantization);
+		const auto quantizedMeshes = fileReader.Get<ModelFileQuantizedMesh>(ModelFileSection::Quantization, ModelFileRange{ 0, static_cast<uint64_t>(quantizationSection.size()) / sizeof(ModelFileQuantizedMesh) });
+		mData.Meshes.reserve(static_cast<size_t>(meshes.size()));
+		for (const ModelFileMesh& mesh : meshes)
+		{
+			// LOD entries are written grouped by mesh, in level order
+			const uint32_t meshIndex = narrow_cast<uint32_t>(mData.Meshes.size());
+			const auto first = find_if(lods.begin(), lods.end(), [meshIndex](const ModelFileMeshLod& lod) { return lod.MeshIndex == meshIndex; });
+			const auto last = find_if(first, lods.end(), [meshIndex](const ModelFileMeshLod& lod) { return lod.MeshIndex != meshIndex; });
+			const span<const ModelFileMeshLod> meshLods(lods.data() + distance(lods.begin(), first), static_cast<size_t>(distance(first, last)));
+
+			span<const Meshlet> meshlets;
+			const auto meshletEntry = find_if(meshletTable.begin(), meshletTable.end(), [meshIndex](const ModelFileMeshlets& entry) { return entry.MeshIndex == meshIndex; });
+			if (meshletEntry != meshletTable.end())
+			{
+				meshlets = fileReader.Get<Meshlet>(ModelFileSection::Meshlets, meshletEntry->Meshlets);
+			}
+
+			const auto quantizedMesh = find_if(quantizedMeshes.begin(), quantizedMeshes.end(), [meshIndex](const ModelFileQuantizedMesh& entry) { return entry.MeshIndex == meshIndex; });
+
+			mData.Meshes.emplace_back(make_shared<Mesh>(*this, fileReader, mesh, meshLods, meshlets, quantizedMesh != quantizedMeshes.end() ? &*quantizedMesh : nullptr));
+		}
+
+		// Deserialize bones
+		uint32_t boneCount;
+		metadata >> boneCount;
+		mData.Bones.reserve(boneCount);
+		for (uint32_t index = 0; index < boneCount; index++)
+		{
+			auto bone = mData.Bones.emplace_back(make_shared<Bone>(metadata));
+			mData.BoneIndexMapping[bone->Name()] = index;
+		}
+
+		// Deserialize skeleton hierachy
+		bool hasSkeleton;
+		metadata >> hasSkeleton;
+		if (hasSkeleton)
+		{
+			mData.RootNode = LoadSkeleton(metadata, nullptr);
+		}
+
+		mSkeleton = Skeleton(mData.RootNode);
+
+		// Deserialize animations; compressed track entries are written grouped by animation
+		const span<const uint8_t> compressedTrackSection = fileReader.Section(ModelFileSection::CompressedTracks);
+		const auto compressedTracks = fileReader.Get<ModelFileCompressedTrack>(ModelFileSection::CompressedTracks, ModelFileRange{ 0, static_cast<uint64_t>(compressedTrackSection.size()) / sizeof(ModelFileCompressedTrack) });
+		uint32_t animationCount;
+		metadata >> animationCount;
+		mData.Animations.reserve(animationCount);
+		for (uint32_t i = 0; i < animationCount; i++)
+		{
+			const auto first = find_if(compressedTracks.begin(), compressedTracks.end(), [i](const ModelFileCompressedTrack& track) { return track.AnimationIndex == i; });
+			const auto last = find_if(first, compressedTracks.end(), [i](const ModelFileCompressedTrack& track) { return track.AnimationIndex != i; });
+			const span<const ModelFileCompressedTrack> animationTracks(compressedTracks.data() + distance(compressedTracks.begin(), first), static_cast<size_t>(distance(first, last)));
+
+			auto animation = mData.Animations.emplace_back(make_shared<AnimationClip>(*this, metadata, &fileReader, animationTracks));
+			mData.AnimationsByName[animation->Name()] = animation;
+		}
+	}
+
 	void Model::SaveSkeleton(OutputStreamHelper& streamHelper, const shared_ptr<SceneNode>& sceneNode) const
 	{
 		streamHelper << sceneNode->Name();
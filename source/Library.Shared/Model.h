@@ -5,6 +5,8 @@
 #include <string>
 #include <fstream>
 #include "RTTI.h"
+#include "ModelFile.h"
+#include "Skeleton.h"
 
 namespace Library
 {
@@ -36,6 +38,7 @@ namespace Library
 		Model() = default;
 		Model(const std::string& filename);
 		Model(std::ifstream& file);
+		Model(gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner);
 		Model(ModelData&& modelData);
 		Model(const Model&) = default;
 		Model(Model&&) = default;
@@ -55,18 +58,33 @@ namespace Library
 		const std::map<std::string, std::uint32_t> BoneIndexMapping() const;
 		std::shared_ptr<SceneNode> RootNode() const;
 
+		// Baked from RootNode when the model is loaded or constructed from ModelData
+		const Skeleton& GetSkeleton() const;
+
 		ModelData& Data();
 
-		void Save(const std::string& filename) const;
-		void Save(std::ofstream& file) const;
+		// Coarsest LOD level whose error, at pixelsPerUnit screen pixels per object-space unit, stays under maxScreenError pixels.
+		// Meshes with fewer levels draw their last one.
+		std::uint32_t SelectLod(float pixelsPerUnit, float maxScreenError = 1.0f) const;
+		static float PixelsPerUnit(float distance, float verticalFieldOfView, float viewportHeight);
+
+		// quantize stores vertex streams and keyframes in their compact encodings (see VertexQuantization and KeyframeCompression),
+		// which only the mapped layout supports. Such files are written as ModelFileVersion::Quantized so older readers reject them.
+		void Save(const std::string& filename, ModelFileVersion version = ModelFileVersion::Mapped, bool quantize = false) const;
+		void Save(std::ofstream& file, ModelFileVersion version = ModelFileVersion::Mapped, bool quantize = false) const;
 
     private:
 		void Load(const std::string& filename);
-		void Load(std::ifstream& file);
+		void Load(std::istream& file);
+		void Load(gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner);
+		void Load(const ModelFileReader& fileReader);
+		void SaveStream(std::ofstream& file) const;
+		void SaveMapped(std::ofstream& file, bool quantize) const;
 
 		void SaveSkeleton(OutputStreamHelper& streamHelper, const std::shared_ptr<SceneNode>& sceneNode) const;
 		std::shared_ptr<SceneNode> LoadSkeleton(InputStreamHelper& streamHelper, std::shared_ptr<SceneNode> parentSceneNode);
 
 		ModelData mData;
+		Skeleton mSkeleton;
     };
 }
\ No newline at end of file
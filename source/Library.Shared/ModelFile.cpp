@@ -0,0 +1,160 @@
+#include "pch.h"
+#include "ModelFile.h"
+#include "GameException.h"
+
+using namespace std;
+using namespace gsl;
+
+namespace Library
+{
+	namespace
+	{
+		uint64_t AlignOffset(uint64_t offset)
+		{
+			return (offset + ModelFileAlignment - 1) & ~static_cast<uint64_t>(ModelFileAlignment - 1);
+		}
+	}
+
+	static_assert(sizeof(ModelFileHeader) == 16, "ModelFileHeader layout changed.");
+	static_assert(sizeof(ModelFileSectionEntry) == 24, "ModelFileSectionEntry layout changed.");
+	static_assert(sizeof(ModelFileMesh) % 8 == 0, "ModelFileMesh must keep 8-byte alignment.");
+	static_assert(sizeof(ModelFileMeshLod) == 32, "ModelFileMeshLod layout changed.");
+	static_assert(sizeof(ModelFileMeshlets) == 24, "ModelFileMeshlets layout changed.");
+	static_assert(sizeof(ModelFileQuantizedMesh) == 224, "ModelFileQuantizedMesh layout changed.");
+	static_assert(sizeof(ModelFileCompressedTrack) == 120, "ModelFileCompressedTrack layout changed.");
+
+#pragma region ModelFileWriter
+
+	ModelFileWriter::ModelFileWriter() :
+		mMetadataStream(ios::binary), mMetadata(mMetadataStream)
+	{
+	}
+
+	ModelFileString ModelFileWriter::AddString(const string& value)
+	{
+		vector<uint8_t>& strings = mSections[static_cast<size_t>(ModelFileSection::Strings)];
+		ModelFileString entry{ narrow<uint32_t>(strings.size()), narrow<uint32_t>(value.size()) };
+		strings.insert(strings.end(), value.begin(), value.end());
+
+		return entry;
+	}
+
+	OutputStreamHelper& ModelFileWriter::Metadata()
+	{
+		return mMetadata;
+	}
+
+	void ModelFileWriter::SetVersion(ModelFileVersion version)
+	{
+		assert(version != ModelFileVersion::Stream);
+		mVersion = version;
+	}
+
+	void ModelFileWriter::Write(ostream& stream)
+	{
+		const string metadata = mMetadataStream.str();
+		mSections[static_cast<size_t>(ModelFileSection::Metadata)].assign(metadata.begin(), metadata.end());
+
+		const uint32_t sectionCount = static_cast<uint32_t>(ModelFileSection::End);
+		const ModelFileHeader header{ ModelFileMagic, static_cast<uint32_t>(mVersion), sectionCount, 0 };
+
+		vector<ModelFileSectionEntry> table;
+		table.reserve(sectionCount);
+		uint64_t offset = AlignOffset(sizeof(ModelFileHeader) + sizeof(ModelFileSectionEntry) * sectionCount);
+		for (uint32_t i = 0; i < sectionCount; ++i)
+		{
+			const uint64_t size = mSections[i].size();
+			table.push_back(ModelFileSectionEntry{ static_cast<ModelFileSection>(i), ModelFileAlignment, offset, size });
+			offset = AlignOffset(offset + size);
+		}
+
+		OutputStreamHelper streamHelper(stream);
+		streamHelper.WriteRaw(span<const ModelFileHeader>(&header, 1));
+		streamHelper.WriteRaw(span<const ModelFileSectionEntry>(table));
+
+		static const char padding[ModelFileAlignment]{ };
+		uint64_t position = sizeof(ModelFileHeader) + sizeof(ModelFileSectionEntry) * sectionCount;
+		for (uint32_t i = 0; i < sectionCount; ++i)
+		{
+			stream.write(padding, static_cast<streamsize>(table[i].Offset - position));
+			streamHelper.WriteRaw(span<const uint8_t>(mSections[i]));
+			position = table[i].Offset + table[i].Size;
+		}
+	}
+
+#pragma endregion ModelFileWriter
+
+#pragma region ModelFileReader
+
+	ModelFileReader::ModelFileReader(span<const uint8_t> data, shared_ptr<const void> owner) :
+		mOwner(move(owner))
+	{
+		const uint64_t fileSize = static_cast<uint64_t>(data.size());
+		if (fileSize < sizeof(ModelFileHeader))
+		{
+			throw GameException("Model file is truncated.");
+		}
+
+		const ModelFileHeader& header = *reinterpret_cast<const ModelFileHeader*>(data.data());
+		if (header.Magic != ModelFileMagic || (header.Version != static_cast<uint32_t>(ModelFileVersion::Mapped) && header.Version != static_cast<uint32_t>(ModelFileVersion::Quantized)))
+		{
+			throw GameException("Unsupported model file version.");
+		}
+
+		if (header.SectionCount > (fileSize - sizeof(ModelFileHeader)) / sizeof(ModelFileSectionEntry))
+		{
+			throw GameException("Model file section table is truncated.");
+		}
+
+		// Unknown section types are skipped so later versions can add sections without breaking older readers
+		const ModelFileSectionEntry* table = reinterpret_cast<const ModelFileSectionEntry*>(data.data() + sizeof(ModelFileHeader));
+		for (uint32_t i = 0; i < header.SectionCount; ++i)
+		{
+			const ModelFileSectionEntry& entry = table[i];
+			if (entry.Offset > fileSize || entry.Size > fileSize - entry.Offset || entry.Offset % ModelFileAlignment != 0)
+			{
+				throw GameException("Model file section is out of bounds.");
+			}
+
+			if (entry.Type < ModelFileSection::End)
+			{
+				mSections[static_cast<size_t>(entry.Type)] = span<const uint8_t>(data.data() + entry.Offset, static_cast<size_t>(entry.Size));
+			}
+		}
+	}
+
+	bool ModelFileReader::HasSignature(istream& stream)
+	{
+		const auto start = stream.tellg();
+		uint32_t magic = 0;
+		stream.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+		stream.clear();
+		stream.seekg(start);
+
+		return magic == ModelFileMagic;
+	}
+
+	const shared_ptr<const void>& ModelFileReader::Owner() const
+	{
+		return mOwner;
+	}
+
+	span<const uint8_t> ModelFileReader::Section(ModelFileSection section) const
+	{
+		return mSections[static_cast<size_t>(section)];
+	}
+
+	string ModelFileReader::GetString(const ModelFileString& value) const
+	{
+		const span<const uint8_t> strings = Section(ModelFileSection::Strings);
+		if (static_cast<uint64_t>(value.Offset) + value.Length > static_cast<uint64_t>(strings.size()))
+		{
+			throw GameException("Model file string is out of bounds.");
+		}
+
+		const char* begin = reinterpret_cast<const char*>(strings.data()) + value.Offset;
+		return string(begin, begin + value.Length);
+	}
+
+#pragma endregion ModelFileReader
+}
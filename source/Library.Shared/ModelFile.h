@@ -0,0 +1,216 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <cstdint>
+#include <gsl\gsl>
+#include "StreamHelper.h"
+
+namespace Library
+{
+	// Version 2 .bin layout: a ModelFileHeader, a ModelFileSectionEntry table, then the sections, each starting on a ModelFileAlignment
+	// boundary. Bulk data (vertex streams, indices, bone weights, keyframes) is stored in its in-memory layout and referenced by
+	// ModelFileRange, so a mapped file can be used in place. Version 1 files are the original length-prefixed stream with no header.
+	enum class ModelFileVersion : std::uint32_t
+	{
+		Stream = 1,
+		Mapped = 2,
+		Quantized = 3	// The version 2 layout, but some vertex streams or keyframes exist only in their compact encodings
+	};
+
+	enum class ModelFileSection : std::uint32_t
+	{
+		Strings,
+		Meshes,
+		VertexData,
+		Indices,
+		BoneWeights,
+		Keyframes,
+		Metadata,
+		Lods,
+		Meshlets,
+		MeshletTable,
+		Quantization,
+		CompressedKeyframes,
+		CompressedTracks,
+		End
+	};
+
+	const std::uint32_t ModelFileMagic = 0x324C444D; // "MDL2"
+	const std::uint32_t ModelFileAlignment = 16;
+	const std::uint32_t ModelFileMaxVertexSets = 8;
+
+	// ModelFileQuantizedMesh::Streams flags; texture coordinate set i uses ModelFileQuantizedTextureCoordinates << i
+	const std::uint32_t ModelFileQuantizedPositions = 0x1;
+	const std::uint32_t ModelFileQuantizedNormals = 0x2;
+	const std::uint32_t ModelFileQuantizedTangents = 0x4;
+	const std::uint32_t ModelFileQuantizedBiNormals = 0x8;
+	const std::uint32_t ModelFileQuantizedTextureCoordinates = 0x100;
+
+	struct ModelFileHeader final
+	{
+		std::uint32_t Magic;
+		std::uint32_t Version;
+		std::uint32_t SectionCount;
+		std::uint32_t Reserved;
+	};
+
+	struct ModelFileSectionEntry final
+	{
+		ModelFileSection Type;
+		std::uint32_t Alignment;
+		std::uint64_t Offset;
+		std::uint64_t Size;
+	};
+
+	// Byte offset into a section and element count
+	struct ModelFileRange final
+	{
+		std::uint64_t Offset;
+		std::uint64_t Count;
+	};
+
+	struct ModelFileString final
+	{
+		std::uint32_t Offset;
+		std::uint32_t Length;
+	};
+
+	struct ModelFileMesh final
+	{
+		ModelFileString Name;
+		std::int32_t MaterialIndex;
+		std::uint32_t FaceCount;
+		ModelFileRange Vertices;
+		ModelFileRange Normals;
+		ModelFileRange Tangents;
+		ModelFileRange BiNormals;
+		std::uint32_t TextureCoordinateSetCount;
+		std::uint32_t VertexColorSetCount;
+		ModelFileRange TextureCoordinates[ModelFileMaxVertexSets];
+		ModelFileRange VertexColors[ModelFileMaxVertexSets];
+		ModelFileRange Indices;
+		ModelFileRange BoneWeights;
+	};
+
+	// Simplified index lists for the mesh at MeshIndex, ordered by level. They index that mesh's vertex streams.
+	struct ModelFileMeshLod final
+	{
+		std::uint32_t MeshIndex;
+		std::uint32_t FaceCount;
+		float Error;
+		std::uint32_t Reserved;
+		ModelFileRange Indices;
+	};
+
+	// Meshlets (Library::Meshlet, stored as is) for the mesh at MeshIndex
+	struct ModelFileMeshlets final
+	{
+		std::uint32_t MeshIndex;
+		std::uint32_t Reserved;
+		ModelFileRange Meshlets;
+	};
+
+	// Quantized vertex streams (see VertexQuantization) for the mesh at MeshIndex. The matching ModelFileMesh ranges are empty.
+	// Positions are XMUSHORTN4 scaled by PositionScale from PositionOffset, directions octahedral XMSHORTN2, and texture
+	// coordinates XMHALF2.
+	struct ModelFileQuantizedMesh final
+	{
+		std::uint32_t MeshIndex;
+		std::uint32_t Streams;
+		float PositionOffset[3];
+		float PositionScale[3];
+		ModelFileRange Positions;
+		ModelFileRange Normals;
+		ModelFileRange Tangents;
+		ModelFileRange BiNormals;
+		ModelFileRange TextureCoordinates[ModelFileMaxVertexSets];
+	};
+
+	// Compressed keyframes (see KeyframeCompression) for bone animation BoneAnimationIndex of animation AnimationIndex; the track's
+	// Keyframes range is empty. Times are floats, translations and scales CompressedVector relative to their offset and scale, and
+	// rotations CompressedRotation. A stream holding a single element is constant across the track.
+	struct ModelFileCompressedTrack final
+	{
+		std::uint32_t AnimationIndex;
+		std::uint32_t BoneAnimationIndex;
+		float TranslationOffset[3];
+		float TranslationScale[3];
+		float ScaleOffset[3];
+		float ScaleScale[3];
+		ModelFileRange Times;
+		ModelFileRange Translations;
+		ModelFileRange Rotations;
+		ModelFileRange Scales;
+	};
+
+	struct ModelFileBoneWeights final
+	{
+		std::uint32_t Count;
+		float Weights[4];
+		std::uint32_t BoneIndices[4];
+	};
+
+	class ModelFileWriter final
+	{
+	public:
+		ModelFileWriter();
+		ModelFileWriter(const ModelFileWriter&) = delete;
+		ModelFileWriter(ModelFileWriter&&) = delete;
+		ModelFileWriter& operator=(const ModelFileWriter&) = delete;
+		ModelFileWriter& operator=(ModelFileWriter&&) = delete;
+		~ModelFileWriter() = default;
+
+		ModelFileString AddString(const std::string& value);
+
+		template <typename T>
+		ModelFileRange Append(ModelFileSection section, gsl::span<const T> values);
+		template <typename T>
+		ModelFileRange Append(ModelFileSection section, const std::vector<T>& values);
+
+		// Stream-serialized object graph (materials, bones, skeleton, animation headers)
+		OutputStreamHelper& Metadata();
+
+		// Mapped, or Quantized when any data was written only in a compact encoding, so older readers reject the file
+		// rather than load meshes and animations with empty ranges
+		void SetVersion(ModelFileVersion version);
+
+		void Write(std::ostream& stream);
+
+	private:
+		std::array<std::vector<std::uint8_t>, static_cast<std::size_t>(ModelFileSection::End)> mSections;
+		std::ostringstream mMetadataStream;
+		OutputStreamHelper mMetadata;
+		ModelFileVersion mVersion{ ModelFileVersion::Mapped };
+	};
+
+	class ModelFileReader final
+	{
+	public:
+		// owner keeps the bytes alive (a MemoryMappedFile or a buffer) for anything holding spans from this reader
+		ModelFileReader(gsl::span<const std::uint8_t> data, std::shared_ptr<const void> owner);
+		ModelFileReader(const ModelFileReader&) = default;
+		ModelFileReader(ModelFileReader&&) = default;
+		ModelFileReader& operator=(const ModelFileReader&) = default;
+		ModelFileReader& operator=(ModelFileReader&&) = default;
+		~ModelFileReader() = default;
+
+		static bool HasSignature(std::istream& stream);
+
+		const std::shared_ptr<const void>& Owner() const;
+		gsl::span<const std::uint8_t> Section(ModelFileSection section) const;
+		std::string GetString(const ModelFileString& value) const;
+
+		template <typename T>
+		gsl::span<const T> Get(ModelFileSection section, const ModelFileRange& range) const;
+
+	private:
+		std::array<gsl::span<const std::uint8_t>, static_cast<std::size_t>(ModelFileSection::End)> mSections;
+		std::shared_ptr<const void> mOwner;
+	};
+}
+
+#include "ModelFile.inl"
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <type_traits>
+#include "GameException.h"
+
+namespace Library
+{
+	template <typename T>
+	inline ModelFileRange ModelFileWriter::Append(ModelFileSection section, gsl::span<const T> values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Model file sections hold trivially copyable elements.");
+
+		std::vector<std::uint8_t>& buffer = mSections[static_cast<std::size_t>(section)];
+		buffer.resize((buffer.size() + ModelFileAlignment - 1) & ~static_cast<std::size_t>(ModelFileAlignment - 1));
+
+		const ModelFileRange range{ buffer.size(), static_cast<std::uint64_t>(values.size()) };
+		const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(values.data());
+		buffer.insert(buffer.end(), bytes, bytes + values.size_bytes());
+
+		return range;
+	}
+
+	template <typename T>
+	inline ModelFileRange ModelFileWriter::Append(ModelFileSection section, const std::vector<T>& values)
+	{
+		return Append(section, gsl::span<const T>(values));
+	}
+
+	template <typename T>
+	inline gsl::span<const T> ModelFileReader::Get(ModelFileSection section, const ModelFileRange& range) const
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "Model file sections hold trivially copyable elements.");
+
+		if (range.Count == 0)
+		{
+			return gsl::span<const T>();
+		}
+
+		const gsl::span<const std::uint8_t> bytes = mSections[static_cast<std::size_t>(section)];
+		const std::uint64_t sectionSize = static_cast<std::uint64_t>(bytes.size());
+		if (range.Offset % alignof(T) != 0 || range.Offset > sectionSize || range.Count > (sectionSize - range.Offset) / sizeof(T))
+		{
+			throw GameException("Model file range is out of bounds.");
+		}
+
+		return gsl::span<const T>(reinterpret_cast<const T*>(bytes.data() + range.Offset), static_cast<std::size_t>(range.Count));
+	}
+}
@@ -17,4 +17,9 @@ namespace Library
 	{
 		return make_shared<Model>(Utility::ToString(assetName));
 	}
+
+	shared_ptr<Model> ModelReader::_Read(const wstring&, gsl::span<const uint8_t> data, const shared_ptr<const void>& owner)
+	{
+		return make_shared<Model>(data, owner);
+	}
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 using namespace DirectX;
 using namespace winrt;
 
@@ -19,10 +20,16 @@ namespace Library
 
 	shared_ptr<PixelShader> PixelShaderReader::_Read(const wstring& assetName)
 	{
-		com_ptr<ID3D11PixelShader> pixelShader;
 		vector<char> compiledPixelShader;
 		Utility::LoadBinaryFile(assetName, compiledPixelShader);
-		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(&compiledPixelShader[0], compiledPixelShader.size(), nullptr, pixelShader.put()), "ID3D11Device::CreatedPixelShader() failed.");
+
+		return _Read(assetName, span<const uint8_t>(reinterpret_cast<const uint8_t*>(compiledPixelShader.data()), compiledPixelShader.size()), nullptr);
+	}
+
+	shared_ptr<PixelShader> PixelShaderReader::_Read(const wstring&, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11PixelShader> pixelShader;
+		ThrowIfFailed(mGame->Direct3DDevice()->CreatePixelShader(data.data(), data.size_bytes(), nullptr, pixelShader.put()), "ID3D11Device::CreatedPixelShader() failed.");
 		
 		return shared_ptr<PixelShader>(new PixelShader(move(pixelShader)));
 	}
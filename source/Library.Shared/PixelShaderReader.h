@@ -19,6 +19,7 @@ namespace Library
 
 	protected:
 		virtual std::shared_ptr<PixelShader> _Read(const std::wstring& assetName) override;
+		virtual std::shared_ptr<PixelShader> _Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner) override;
 	};
 
 	class PixelShaderWithClassLinkageReader
@@ -0,0 +1,80 @@
+#include "pch.h"
+#include "Skeleton.h"
+#include "Bone.h"
+#include "MatrixHelper.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+
+namespace Library
+{
+	Skeleton::Skeleton(const shared_ptr<SceneNode>& rootNode)
+	{
+		if (rootNode != nullptr)
+		{
+			AddNode(*rootNode, NoParent);
+		}
+	}
+
+	uint32_t Skeleton::NodeCount() const
+	{
+		return narrow_cast<uint32_t>(mParentIndices.size());
+	}
+
+	span<const uint32_t> Skeleton::ParentIndices() const
+	{
+		return mParentIndices;
+	}
+
+	span<const uint32_t> Skeleton::BoneIndices() const
+	{
+		return mBoneIndices;
+	}
+
+	span<const XMFLOAT4X4> Skeleton::LocalTransforms() const
+	{
+		return mLocalTransforms;
+	}
+
+	span<const XMFLOAT4X4> Skeleton::OffsetTransforms() const
+	{
+		return mOffsetTransforms;
+	}
+
+	void Skeleton::ComposePose(span<const XMFLOAT4X4> boneTransforms, FXMMATRIX inverseRootTransform, span<XMFLOAT4X4> toRootTransforms, span<XMFLOAT4X4> finalTransforms) const
+	{
+		assert(static_cast<size_t>(toRootTransforms.size()) >= mParentIndices.size());
+
+		// Parents precede their children, so one forward pass resolves every to-root transform
+		for (uint32_t node = 0; node < NodeCount(); ++node)
+		{
+			const uint32_t boneIndex = mBoneIndices[node];
+			const XMMATRIX toParentTransform = XMLoadFloat4x4(boneIndex != NoBone ? &boneTransforms[boneIndex] : &mLocalTransforms[node]);
+			const uint32_t parentIndex = mParentIndices[node];
+			const XMMATRIX toRootTransform = (parentIndex != NoParent ? toParentTransform * XMLoadFloat4x4(&toRootTransforms[parentIndex]) : toParentTransform);
+			XMStoreFloat4x4(&toRootTransforms[node], toRootTransform);
+
+			if (boneIndex != NoBone)
+			{
+				XMStoreFloat4x4(&finalTransforms[boneIndex], XMLoadFloat4x4(&mOffsetTransforms[node]) * toRootTransform * inverseRootTransform);
+			}
+		}
+	}
+
+	void Skeleton::AddNode(SceneNode& sceneNode, uint32_t parentIndex)
+	{
+		const uint32_t nodeIndex = NodeCount();
+		const Bone* bone = sceneNode.As<Bone>();
+
+		mParentIndices.push_back(parentIndex);
+		mBoneIndices.push_back(bone != nullptr ? bone->Index() : NoBone);
+		mLocalTransforms.push_back(sceneNode.Transform());
+		mOffsetTransforms.push_back(bone != nullptr ? bone->OffsetTransform() : MatrixHelper::Identity);
+
+		for (const auto& childNode : sceneNode.Children())
+		{
+			AddNode(*childNode, nodeIndex);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	class SceneNode;
+
+	// A model's scene node hierarchy flattened into parent-before-child order, so a pose is composed in one pass over
+	// contiguous arrays. Transforms are copied when the skeleton is built.
+	class Skeleton final
+	{
+	public:
+		inline static const std::uint32_t NoParent = std::numeric_limits<std::uint32_t>::max();
+		inline static const std::uint32_t NoBone = std::numeric_limits<std::uint32_t>::max();
+
+		Skeleton() = default;
+		explicit Skeleton(const std::shared_ptr<SceneNode>& rootNode);
+		Skeleton(const Skeleton&) = default;
+		Skeleton(Skeleton&&) = default;
+		Skeleton& operator=(const Skeleton&) = default;
+		Skeleton& operator=(Skeleton&&) = default;
+		~Skeleton() = default;
+
+		std::uint32_t NodeCount() const;
+
+		// Per node, in hierarchy order; the root is node 0
+		gsl::span<const std::uint32_t> ParentIndices() const;
+		gsl::span<const std::uint32_t> BoneIndices() const;
+		gsl::span<const DirectX::XMFLOAT4X4> LocalTransforms() const;
+		gsl::span<const DirectX::XMFLOAT4X4> OffsetTransforms() const;
+
+		// Resolves local bone transforms (by bone index; other nodes use their own transform) into skinning transforms,
+		// using toRootTransforms (one per node) as scratch
+		void ComposePose(gsl::span<const DirectX::XMFLOAT4X4> boneTransforms, DirectX::FXMMATRIX inverseRootTransform, gsl::span<DirectX::XMFLOAT4X4> toRootTransforms, gsl::span<DirectX::XMFLOAT4X4> finalTransforms) const;
+
+	private:
+		void AddNode(SceneNode& sceneNode, std::uint32_t parentIndex);
+
+		std::vector<std::uint32_t> mParentIndices;
+		std::vector<std::uint32_t> mBoneIndices;
+		std::vector<DirectX::XMFLOAT4X4> mLocalTransforms;
+		std::vector<DirectX::XMFLOAT4X4> mOffsetTransforms;
+	};
+}
\ No newline at end of file
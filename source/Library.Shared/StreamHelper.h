@@ -1,6 +1,10 @@
 #pragma once
 
 #include <iostream>
+#include <vector>
+#include <cstdint>
+#include <type_traits>
+#include <gsl\gsl>
 
 namespace DirectX
 {
@@ -26,6 +30,14 @@ namespace Library
 		OutputStreamHelper& operator<<(const std::string& value);
 		OutputStreamHelper& operator<<(const DirectX::XMFLOAT4X4& value);
 		OutputStreamHelper& operator<<(bool value);
+
+		// Bulk writes of trivially copyable elements; WriteArray prefixes a uint32_t element count.
+		template <typename T>
+		OutputStreamHelper& WriteRaw(gsl::span<const T> values);
+		template <typename T>
+		OutputStreamHelper& WriteArray(gsl::span<const T> values);
+		template <typename T>
+		OutputStreamHelper& WriteArray(const std::vector<T>& values);
 		
 	private:
 		template <typename T>
@@ -51,6 +63,12 @@ namespace Library
 		InputStreamHelper& operator>>(std::string& value);
 		InputStreamHelper& operator>>(DirectX::XMFLOAT4X4& value);
 		InputStreamHelper& operator>>(bool& value);
+
+		// Bulk reads matching WriteRaw/WriteArray; ReadArray resizes the vector to the stored count.
+		template <typename T>
+		InputStreamHelper& ReadRaw(gsl::span<T> values);
+		template <typename T>
+		InputStreamHelper& ReadArray(std::vector<T>& values);
 		
 	private:
 		template <typename T>
@@ -58,4 +76,6 @@ namespace Library
 
 		std::istream& mStream;
 	};
-}
\ No newline at end of file
+}
+
+#include "StreamHelper.inl"
\ No newline at end of file
@@ -0,0 +1,55 @@
+#pragma once
+
+namespace Library
+{
+	// Elements are copied as raw bytes. That matches the byte-wise little-endian integer operators on every platform we target.
+	template <typename T>
+	inline OutputStreamHelper& OutputStreamHelper::WriteRaw(gsl::span<const T> values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "WriteRaw requires trivially copyable elements.");
+
+		if (values.size() > 0)
+		{
+			mStream.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+		}
+
+		return *this;
+	}
+
+	template <typename T>
+	inline OutputStreamHelper& OutputStreamHelper::WriteArray(gsl::span<const T> values)
+	{
+		*this << gsl::narrow_cast<std::uint32_t>(values.size());
+
+		return WriteRaw(values);
+	}
+
+	template <typename T>
+	inline OutputStreamHelper& OutputStreamHelper::WriteArray(const std::vector<T>& values)
+	{
+		return WriteArray(gsl::span<const T>(values));
+	}
+
+	template <typename T>
+	inline InputStreamHelper& InputStreamHelper::ReadRaw(gsl::span<T> values)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "ReadRaw requires trivially copyable elements.");
+
+		if (values.size() > 0)
+		{
+			mStream.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size_bytes()));
+		}
+
+		return *this;
+	}
+
+	template <typename T>
+	inline InputStreamHelper& InputStreamHelper::ReadArray(std::vector<T>& values)
+	{
+		std::uint32_t count;
+		*this >> count;
+		values.resize(count);
+
+		return ReadRaw(gsl::span<T>(values));
+	}
+}
@@ -19,6 +19,17 @@ namespace Library
 	{
 	}
 
+	namespace
+	{
+		shared_ptr<Texture2D> CreateTexture2D(const com_ptr<ID3D11Resource>& resource, com_ptr<ID3D11ShaderResourceView>&& shaderResourceView)
+		{
+			com_ptr<ID3D11Texture2D> texture = resource.as<ID3D11Texture2D>();
+			Point textureSize = TextureHelper::GetTextureSize(not_null<ID3D11Texture2D*>(texture.get()));
+
+			return make_shared<Texture2D>(move(shaderResourceView), textureSize.X, textureSize.Y);
+		}
+	}
+
 	shared_ptr<Texture2D> Texture2DReader::_Read(const wstring& assetName)
 	{
 		com_ptr<ID3D11Resource> resource;
@@ -32,9 +43,34 @@ namespace Library
 			ThrowIfFailed(CreateWICTextureFromFile(mGame->Direct3DDevice(), assetName.c_str(), resource.put(), shaderResourceView.put()), "CreateWICTextureFromFile() failed.");
 		}
 
-		com_ptr<ID3D11Texture2D> texture = resource.as<ID3D11Texture2D>();
-		Point textureSize = TextureHelper::GetTextureSize(not_null<ID3D11Texture2D*>(texture.get()));
+		return CreateTexture2D(resource, move(shaderResourceView));
+	}
+
+	shared_ptr<Texture2D> Texture2DReader::_Read(const wstring& assetName, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11Resource> resource;
+		com_ptr<ID3D11ShaderResourceView> shaderResourceView;
+		if (StringHelper::EndsWith(assetName, L".dds"))
+		{
+			ThrowIfFailed(CreateDDSTextureFromMemory(mGame->Direct3DDevice(), data.data(), data.size_bytes(), resource.put(), shaderResourceView.put()), "CreateDDSTextureFromMemory() failed.");
+		}
+		else
+		{
+			ThrowIfFailed(CreateWICTextureFromMemory(mGame->Direct3DDevice(), data.data(), data.size_bytes(), resource.put(), shaderResourceView.put()), "CreateWICTextureFromMemory() failed.");
+		}
+
+		return CreateTexture2D(resource, move(shaderResourceView));
+	}
+
+	size_t Texture2DReader::AssetSize(const wstring& assetName, const RTTI& asset, size_t sourceSize) const
+	{
+		// DDS files are stored in their GPU format; everything else is decoded by WIC to 32 bits per pixel
+		if (StringHelper::EndsWith(assetName, L".dds"))
+		{
+			return sourceSize;
+		}
 
-		return make_shared<Texture2D>(move(shaderResourceView), textureSize.X, textureSize.Y);
+		const Texture2D& texture = static_cast<const Texture2D&>(asset);
+		return static_cast<size_t>(texture.Width()) * texture.Height() * 4;
 	}
 }
\ No newline at end of file
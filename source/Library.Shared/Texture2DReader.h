@@ -17,7 +17,10 @@ namespace Library
 		Texture2DReader& operator=(Texture2DReader&&) = default;
 		~Texture2DReader() = default;
 
+		virtual std::size_t AssetSize(const std::wstring& assetName, const RTTI& asset, std::size_t sourceSize) const override;
+
 	protected:
 		virtual std::shared_ptr<Texture2D> _Read(const std::wstring& assetName) override;
+		virtual std::shared_ptr<Texture2D> _Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner) override;
 	};
 }
\ No newline at end of file
@@ -23,4 +23,12 @@ namespace Library
 
 		return shared_ptr<TextureCube>(new TextureCube(move(shaderResourceView)));
 	}
+
+	shared_ptr<TextureCube> TextureCubeReader::_Read(const wstring&, gsl::span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		com_ptr<ID3D11ShaderResourceView> shaderResourceView;
+		ThrowIfFailed(CreateDDSTextureFromMemory(mGame->Direct3DDevice(), data.data(), data.size_bytes(), nullptr, shaderResourceView.put()), "CreateDDSTextureFromMemory() failed.");
+
+		return shared_ptr<TextureCube>(new TextureCube(move(shaderResourceView)));
+	}
 }
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "pch.h"
+#include "ThreadPool.h"
+#include "GameException.h"
+
+using namespace std;
+
+namespace Library
+{
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		mThreads.reserve(max(threadCount, 1U));
+		for (uint32_t i = 0; i < max(threadCount, 1U); ++i)
+		{
+			mThreads.emplace_back(&ThreadPool::WorkerLoop, this);
+		}
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			mStopping = true;
+		}
+
+		mTaskAvailable.notify_all();
+		for (auto& thread : mThreads)
+		{
+			thread.join();
+		}
+	}
+
+	uint32_t ThreadPool::ThreadCount() const
+	{
+		return static_cast<uint32_t>(mThreads.size());
+	}
+
+	void ThreadPool::Enqueue(function<void()> task)
+	{
+		{
+			lock_guard<mutex> lock(mMutex);
+			if (mStopping)
+			{
+				throw GameException("Cannot enqueue work on a stopping thread pool.");
+			}
+
+			mTasks.push_back(move(task));
+		}
+
+		mTaskAvailable.notify_one();
+	}
+
+	uint32_t ThreadPool::DefaultThreadCount()
+	{
+		// Leave one core for the thread that is queueing the work
+		const uint32_t hardwareThreads = thread::hardware_concurrency();
+		return (hardwareThreads > 1 ? hardwareThreads - 1 : 1);
+	}
+
+	void ThreadPool::WorkerLoop()
+	{
+		// Texture decoding goes through WIC, so each worker joins the multithreaded apartment
+		const HRESULT comResult = CoInitializeEx(nullptr, COINITBASE_MULTITHREADED);
+
+		for (;;)
+		{
+			function<void()> task;
+			{
+				unique_lock<mutex> lock(mMutex);
+				mTaskAvailable.wait(lock, [this] { return mStopping || mTasks.empty() == false; });
+
+				// Drain the queue before stopping so no caller is left waiting on a future that never completes
+				if (mTasks.empty())
+				{
+					break;
+				}
+
+				task = move(mTasks.front());
+				mTasks.pop_front();
+			}
+
+			task();
+		}
+
+		if (SUCCEEDED(comResult))
+		{
+			CoUninitialize();
+		}
+	}
+}
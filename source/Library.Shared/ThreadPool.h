@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace Library
+{
+	class ThreadPool final
+	{
+	public:
+		explicit ThreadPool(std::uint32_t threadCount = DefaultThreadCount());
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+		ThreadPool(ThreadPool&&) = delete;
+		ThreadPool& operator=(ThreadPool&&) = delete;
+		~ThreadPool();
+
+		std::uint32_t ThreadCount() const;
+		void Enqueue(std::function<void()> task);
+
+		static std::uint32_t DefaultThreadCount();
+
+	private:
+		void WorkerLoop();
+
+		std::vector<std::thread> mThreads;
+		std::deque<std::function<void()>> mTasks;
+		std::mutex mMutex;
+		std::condition_variable mTaskAvailable;
+		bool mStopping{ false };
+	};
+}
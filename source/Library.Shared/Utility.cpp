@@ -84,6 +84,14 @@ namespace Library
 		file.close();
 	}
 
+	size_t Utility::GetFileSize(const wstring& filename)
+	{
+		error_code error;
+		const auto size = filesystem::file_size(filename, error);
+
+		return (error ? 0 : static_cast<size_t>(size));
+	}
+
 #pragma warning(push)
 #pragma warning(disable: 4996)
 	void Utility::ToWideString(const string& source, wstring& dest)
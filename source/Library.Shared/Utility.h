@@ -15,6 +15,7 @@ namespace Library
 		static void GetDirectory(const std::string& inputPath, std::string& directory);
 		static std::tuple<std::string, std::string> GetFileNameAndDirectory(const std::string& inputPath);
 		static void LoadBinaryFile(const std::wstring& filename, std::vector<char>& data);
+		static std::size_t GetFileSize(const std::wstring& filename);
 		static void ToWideString(const std::string& source, std::wstring& dest);
 		static std::wstring ToWideString(const std::string& source);
 		static void Totring(const std::wstring& source, std::string& dest);
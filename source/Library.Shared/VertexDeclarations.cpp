@@ -11,14 +11,15 @@ namespace Library
 {
 	void VertexPosition::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 
 		vector<VertexPosition> vertices;
-		vertices.reserve(sourceVertices.size());
+		vertices.reserve(vertexCount);
 
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f));
 		}
 
@@ -27,19 +28,20 @@ namespace Library
 
 	void VertexPositionColor::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 
 		vector<VertexPositionColor> vertices;
-		vertices.reserve(sourceVertices.size());
+		vertices.reserve(vertexCount);
 
 		assert(mesh.VertexColors().size() > 0);
-		const vector<XMFLOAT4>& vertexColors = mesh.VertexColors().at(0);
+		const auto& vertexColors = mesh.VertexColors().at(0);
 		assert(vertexColors.size() == sourceVertices.size());
 
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT4& color = vertexColors.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT4& color = vertexColors[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), color);
 		}
 
@@ -48,16 +50,17 @@ namespace Library
 
 	void VertexPositionTexture::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
-		const vector<XMFLOAT3>& textureCoordinates = mesh.TextureCoordinates().at(0);
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
+		const auto& textureCoordinates = mesh.TextureCoordinates().at(0);
 		assert(textureCoordinates.size() == sourceVertices.size());
 
 		vector<VertexPositionTexture> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		vertices.reserve(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = textureCoordinates.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& uv = textureCoordinates[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y));
 		}
 
@@ -66,16 +69,17 @@ namespace Library
 
 	void VertexPositionNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
-		const vector<XMFLOAT3>& sourceNormals = mesh.Normals();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
+		const auto sourceNormals = mesh.Normals();
 		assert(sourceNormals.size() == sourceVertices.size());
 
 		vector<VertexPositionNormal> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		vertices.reserve(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& normal = sourceNormals[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), normal);
 		}
 
@@ -84,19 +88,20 @@ namespace Library
 
 	void VertexPositionTextureNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
 		assert(sourceUVs.size() == sourceVertices.size());
 		const auto& sourceNormals = mesh.Normals();
 		assert(sourceNormals.size() == sourceVertices.size());
 
 		vector<VertexPositionTextureNormal> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		vertices.reserve(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = sourceUVs.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& uv = sourceUVs[i];
+			const XMFLOAT3& normal = sourceNormals[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normal);
 		}
 
@@ -105,7 +110,8 @@ namespace Library
 
 	void VertexPositionTextureNormalTangent::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
 		assert(sourceUVs.size() == sourceVertices.size());
 		const auto& sourceNormals = mesh.Normals();
@@ -114,13 +120,13 @@ namespace Library
 		assert(sourceTangents.size() == sourceVertices.size());
 
 		vector<VertexPositionTextureNormalTangent> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		vertices.reserve(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = sourceUVs.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
-			const XMFLOAT3& tangent = sourceTangents.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& uv = sourceUVs[i];
+			const XMFLOAT3& normal = sourceNormals[i];
+			const XMFLOAT3& tangent = sourceTangents[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f), XMFLOAT2(uv.x, uv.y), normal, tangent);
 		}
 
@@ -129,21 +135,22 @@ namespace Library
 
 	void VertexSkinnedPositionTextureNormal::CreateVertexBuffer(not_null<ID3D11Device*> device, const Mesh& mesh, not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 		const auto& sourceUVs = mesh.TextureCoordinates().at(0);
 		assert(sourceUVs.size() == sourceVertices.size());
 		const auto& sourceNormals = mesh.Normals();
 		assert(sourceNormals.size() == sourceVertices.size());
 		const auto& boneWeights = mesh.BoneWeights();
-		assert(boneWeights.size() == sourceVertices.size());
+		assert(boneWeights.size() == vertexCount);
 
 		vector<VertexSkinnedPositionTextureNormal> vertices;
-		vertices.reserve(sourceVertices.size());
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		vertices.reserve(vertexCount);
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
-			const XMFLOAT3& uv = sourceUVs.at(i);
-			const XMFLOAT3& normal = sourceNormals.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
+			const XMFLOAT3& uv = sourceUVs[i];
+			const XMFLOAT3& normal = sourceNormals[i];
 			const BoneVertexWeights& vertexWeights = boneWeights.at(i);
 
 			float weights[BoneVertexWeights::MaxBoneWeightsPerVertex];
@@ -165,14 +172,15 @@ namespace Library
 
 	/*void VertexXYIndex::CreateVertexBuffer(gsl::not_null<ID3D11Device*> device, const Library::Mesh& mesh, gsl::not_null<ID3D11Buffer**> vertexBuffer)
 	{
-		const vector<XMFLOAT3>& sourceVertices = mesh.Vertices();
+		const auto sourceVertices = mesh.Vertices();
+		const size_t vertexCount = narrow_cast<size_t>(sourceVertices.size());
 
 		vector<VertexXYIndex> vertices;
-		vertices.reserve(sourceVertices.size());
+		vertices.reserve(vertexCount);
 
-		for (size_t i = 0; i < sourceVertices.size(); i++)
+		for (size_t i = 0; i < vertexCount; i++)
 		{
-			const XMFLOAT3& position = sourceVertices.at(i);
+			const XMFLOAT3& position = sourceVertices[i];
 			vertices.emplace_back(XMFLOAT4(position.x, position.y, position.z, 1.0f));
 		}
 
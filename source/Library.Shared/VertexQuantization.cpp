@@ -0,0 +1,150 @@
+#include "pch.h"
+#include "VertexQuantization.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace Library
+{
+	const float VertexQuantization::UnitLengthTolerance = 0.01f;
+
+	bool VertexQuantization::CanEncodeDirections(span<const XMFLOAT3> directions)
+	{
+		return all_of(directions.begin(), directions.end(), [](const XMFLOAT3& direction)
+		{
+			return fabsf(XMVectorGetX(XMVector3Length(XMLoadFloat3(&direction))) - 1.0f) <= UnitLengthTolerance;
+		});
+	}
+
+	bool VertexQuantization::CanEncodeTextureCoordinates(span<const XMFLOAT3> textureCoordinates)
+	{
+		const float maxHalf = 65504.0f;
+		return all_of(textureCoordinates.begin(), textureCoordinates.end(), [maxHalf](const XMFLOAT3& textureCoordinate)
+		{
+			return textureCoordinate.z == 0.0f && fabsf(textureCoordinate.x) <= maxHalf && fabsf(textureCoordinate.y) <= maxHalf;
+		});
+	}
+
+	void VertexQuantization::GetEncodingRange(span<const XMFLOAT3> values, XMFLOAT3& offset, XMFLOAT3& scale)
+	{
+		XMVECTOR minimum = XMVectorReplicate(numeric_limits<float>::max());
+		XMVECTOR maximum = XMVectorReplicate(-numeric_limits<float>::max());
+		for (const XMFLOAT3& value : values)
+		{
+			const XMVECTOR vector = XMLoadFloat3(&value);
+			minimum = XMVectorMin(minimum, vector);
+			maximum = XMVectorMax(maximum, vector);
+		}
+
+		if (values.empty())
+		{
+			minimum = maximum = XMVectorZero();
+		}
+
+		// Flat axes keep a unit scale so decoding never divides by zero
+		XMVECTOR extent = XMVectorSubtract(maximum, minimum);
+		extent = XMVectorSelect(extent, g_XMOne, XMVectorLessOrEqual(extent, XMVectorZero()));
+		XMStoreFloat3(&offset, minimum);
+		XMStoreFloat3(&scale, extent);
+	}
+
+	void VertexQuantization::EncodePositions(span<const XMFLOAT3> positions, vector<XMUSHORTN4>& encoded, XMFLOAT3& offset, XMFLOAT3& scale)
+	{
+		GetEncodingRange(positions, offset, scale);
+		const XMVECTOR minimum = XMLoadFloat3(&offset);
+		const XMVECTOR extent = XMLoadFloat3(&scale);
+
+		const XMVECTOR inverseExtent = XMVectorReciprocal(extent);
+		encoded.resize(static_cast<size_t>(positions.size()));
+		for (size_t i = 0; i < encoded.size(); ++i)
+		{
+			XMStoreUShortN4(&encoded[i], XMVectorMultiply(XMVectorSubtract(XMLoadFloat3(&positions[i]), minimum), inverseExtent));
+		}
+	}
+
+	void VertexQuantization::DecodePositions(span<const XMUSHORTN4> encoded, const XMFLOAT3& offset, const XMFLOAT3& scale, vector<XMFLOAT3>& positions)
+	{
+		const XMVECTOR offsetVector = XMLoadFloat3(&offset);
+		const XMVECTOR scaleVector = XMLoadFloat3(&scale);
+
+		positions.resize(static_cast<size_t>(encoded.size()));
+		for (size_t i = 0; i < positions.size(); ++i)
+		{
+			XMStoreFloat3(&positions[i], XMVectorMultiplyAdd(XMLoadUShortN4(&encoded[i]), scaleVector, offsetVector));
+		}
+	}
+
+	XMSHORTN2 VertexQuantization::EncodeOctahedral(FXMVECTOR direction)
+	{
+		// Project onto the octahedron |x| + |y| + |z| = 1, then fold the lower half over the diagonals
+		const XMVECTOR l1Norm = XMVector3Dot(XMVectorAbs(direction), g_XMOne);
+		const XMVECTOR projected = XMVectorDivide(direction, l1Norm);
+		const XMVECTOR signs = XMVectorSelect(g_XMNegativeOne, g_XMOne, XMVectorGreaterOrEqual(projected, XMVectorZero()));
+		const XMVECTOR folded = XMVectorMultiply(XMVectorSubtract(g_XMOne, XMVectorAbs(XMVectorSwizzle<1, 0, 2, 3>(projected))), signs);
+		const XMVECTOR encoded = (XMVectorGetZ(projected) < 0.0f ? folded : projected);
+
+		XMSHORTN2 result;
+		XMStoreShortN2(&result, encoded);
+
+		return result;
+	}
+
+	XMVECTOR VertexQuantization::DecodeOctahedral(const XMSHORTN2& encoded)
+	{
+		const XMVECTOR xy = XMLoadShortN2(&encoded);
+		const XMVECTOR absXY = XMVectorAbs(xy);
+		const XMVECTOR z = XMVectorSubtract(g_XMOne, XMVectorAdd(XMVectorSplatX(absXY), XMVectorSplatY(absXY)));
+
+		// Unfold the lower hemisphere
+		const XMVECTOR signs = XMVectorSelect(g_XMNegativeOne, g_XMOne, XMVectorGreaterOrEqual(xy, XMVectorZero()));
+		const XMVECTOR unfolded = XMVectorMultiply(XMVectorSubtract(g_XMOne, XMVectorSwizzle<1, 0, 2, 3>(absXY)), signs);
+		const XMVECTOR direction = XMVectorSelect(XMVectorSelect(xy, unfolded, XMVectorLess(z, XMVectorZero())), z, g_XMSelect0010);
+
+		return XMVector3Normalize(direction);
+	}
+
+	void VertexQuantization::EncodeDirections(span<const XMFLOAT3> directions, vector<XMSHORTN2>& encoded)
+	{
+		encoded.resize(static_cast<size_t>(directions.size()));
+		for (size_t i = 0; i < encoded.size(); ++i)
+		{
+			encoded[i] = EncodeOctahedral(XMLoadFloat3(&directions[i]));
+		}
+	}
+
+	void VertexQuantization::DecodeDirections(span<const XMSHORTN2> encoded, vector<XMFLOAT3>& directions)
+	{
+		directions.resize(static_cast<size_t>(encoded.size()));
+		for (size_t i = 0; i < directions.size(); ++i)
+		{
+			XMStoreFloat3(&directions[i], DecodeOctahedral(encoded[i]));
+		}
+	}
+
+	void VertexQuantization::EncodeTextureCoordinates(span<const XMFLOAT3> textureCoordinates, vector<XMHALF2>& encoded)
+	{
+		encoded.resize(static_cast<size_t>(textureCoordinates.size()));
+		if (encoded.empty())
+		{
+			return;
+		}
+
+		XMConvertFloatToHalfStream(&encoded[0].x, sizeof(XMHALF2), &textureCoordinates[0].x, sizeof(XMFLOAT3), encoded.size());
+		XMConvertFloatToHalfStream(&encoded[0].y, sizeof(XMHALF2), &textureCoordinates[0].y, sizeof(XMFLOAT3), encoded.size());
+	}
+
+	void VertexQuantization::DecodeTextureCoordinates(span<const XMHALF2> encoded, vector<XMFLOAT3>& textureCoordinates)
+	{
+		textureCoordinates.assign(static_cast<size_t>(encoded.size()), XMFLOAT3(0.0f, 0.0f, 0.0f));
+		if (textureCoordinates.empty())
+		{
+			return;
+		}
+
+		// The stream converters batch through F16C where it's available
+		XMConvertHalfToFloatStream(&textureCoordinates[0].x, sizeof(XMFLOAT3), &encoded[0].x, sizeof(XMHALF2), textureCoordinates.size());
+		XMConvertHalfToFloatStream(&textureCoordinates[0].y, sizeof(XMFLOAT3), &encoded[0].y, sizeof(XMHALF2), textureCoordinates.size());
+	}
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <gsl\gsl>
+#include <DirectXMath.h>
+#include <DirectXPackedVector.h>
+
+namespace Library
+{
+	// Compact encodings for model file vertex streams. Decoding goes through DirectXMath, so it runs on SIMD registers.
+	class VertexQuantization final
+	{
+	public:
+		VertexQuantization() = delete;
+		VertexQuantization(const VertexQuantization&) = delete;
+		VertexQuantization& operator=(const VertexQuantization&) = delete;
+		VertexQuantization(VertexQuantization&&) = delete;
+		VertexQuantization& operator=(VertexQuantization&&) = delete;
+		~VertexQuantization() = default;
+
+		static const float UnitLengthTolerance;
+
+		// Octahedral encoding only holds unit vectors, and half precision only u and v
+		static bool CanEncodeDirections(gsl::span<const DirectX::XMFLOAT3> directions);
+		static bool CanEncodeTextureCoordinates(gsl::span<const DirectX::XMFLOAT3> textureCoordinates);
+
+		// The bounding box's minimum and per-axis extent, which UNORM encodings are relative to; an axis with no extent gets 1
+		static void GetEncodingRange(gsl::span<const DirectX::XMFLOAT3> values, DirectX::XMFLOAT3& offset, DirectX::XMFLOAT3& scale);
+
+		// 16-bit UNORM per axis across the stream's bounding box; w is padding so the layout matches DXGI_FORMAT_R16G16B16A16_UNORM
+		static void EncodePositions(gsl::span<const DirectX::XMFLOAT3> positions, std::vector<DirectX::PackedVector::XMUSHORTN4>& encoded, DirectX::XMFLOAT3& offset, DirectX::XMFLOAT3& scale);
+		static void DecodePositions(gsl::span<const DirectX::PackedVector::XMUSHORTN4> encoded, const DirectX::XMFLOAT3& offset, const DirectX::XMFLOAT3& scale, std::vector<DirectX::XMFLOAT3>& positions);
+
+		// Octahedral mapping of a unit vector onto two 16-bit SNORM components
+		static DirectX::PackedVector::XMSHORTN2 EncodeOctahedral(DirectX::FXMVECTOR direction);
+		static DirectX::XMVECTOR DecodeOctahedral(const DirectX::PackedVector::XMSHORTN2& encoded);
+		static void EncodeDirections(gsl::span<const DirectX::XMFLOAT3> directions, std::vector<DirectX::PackedVector::XMSHORTN2>& encoded);
+		static void DecodeDirections(gsl::span<const DirectX::PackedVector::XMSHORTN2> encoded, std::vector<DirectX::XMFLOAT3>& directions);
+
+		// Half-precision u and v; the third component is always zero and isn't stored
+		static void EncodeTextureCoordinates(gsl::span<const DirectX::XMFLOAT3> textureCoordinates, std::vector<DirectX::PackedVector::XMHALF2>& encoded);
+		static void DecodeTextureCoordinates(gsl::span<const DirectX::PackedVector::XMHALF2> encoded, std::vector<DirectX::XMFLOAT3>& textureCoordinates);
+	};
+}
\ No newline at end of file
@@ -5,6 +5,7 @@
 #include "Utility.h"
 
 using namespace std;
+using namespace gsl;
 using namespace DirectX;
 using namespace winrt;
 
@@ -19,9 +20,20 @@ namespace Library
 
 	shared_ptr<VertexShader> VertexShaderReader::_Read(const wstring& assetName)
 	{
-		com_ptr<ID3D11VertexShader> vertexShader;
 		vector<char> compiledVertexShader;
 		Utility::LoadBinaryFile(assetName, compiledVertexShader);
+
+		return CreateVertexShader(move(compiledVertexShader));
+	}
+
+	shared_ptr<VertexShader> VertexShaderReader::_Read(const wstring&, span<const uint8_t> data, const shared_ptr<const void>&)
+	{
+		return CreateVertexShader(vector<char>(data.begin(), data.end()));
+	}
+
+	shared_ptr<VertexShader> VertexShaderReader::CreateVertexShader(vector<char>&& compiledVertexShader)
+	{
+		com_ptr<ID3D11VertexShader> vertexShader;
 		ThrowIfFailed(mGame->Direct3DDevice()->CreateVertexShader(&compiledVertexShader[0], compiledVertexShader.size(), nullptr, vertexShader.put()), "ID3D11Device::CreatedVertexShader() failed.");
 		
 		return shared_ptr<VertexShader>(new VertexShader(move(compiledVertexShader), move(vertexShader)));
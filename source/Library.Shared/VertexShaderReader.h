@@ -19,5 +19,9 @@ namespace Library
 
 	protected:
 		virtual std::shared_ptr<VertexShader> _Read(const std::wstring& assetName) override;
+		virtual std::shared_ptr<VertexShader> _Read(const std::wstring& assetName, gsl::span<const std::uint8_t> data, const std::shared_ptr<const void>& owner) override;
+
+	private:
+		std::shared_ptr<VertexShader> CreateVertexShader(std::vector<char>&& compiledVertexShader);
 	};
 }
\ No newline at end of file
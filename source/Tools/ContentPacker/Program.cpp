@@ -0,0 +1,99 @@
+#include "pch.h"
+#include "ContentArchive.h"
+#include "Utility.h"
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace gsl;
+using namespace Library;
+
+int main(int argc, char* argv[])
+{
+#if defined(DEBUG) | defined(_DEBUG)
+	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
+#endif
+
+	try
+	{
+		if (argc < 3)
+		{
+			throw exception("Usage: ContentPacker.exe contentdirectory archivefilename [/compress] [/alignment:bytes]");
+		}
+
+		const path contentDirectory = argv[1];
+		const path archiveFilename = absolute(argv[2]);
+		bool compress = false;
+		uint32_t alignment = ContentArchiveDefaultAlignment;
+		for (int i = 3; i < argc; ++i)
+		{
+			const string option = argv[i];
+			if (option == "/compress"s)
+			{
+				compress = true;
+			}
+			else if (option.compare(0, 11, "/alignment:"s) == 0)
+			{
+				alignment = static_cast<uint32_t>(stoul(option.substr(11)));
+			}
+			else
+			{
+				throw exception(("Unknown option: "s + option).c_str());
+			}
+		}
+
+		if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+		{
+			throw exception("Alignment must be a power of two.");
+		}
+
+		path temporaryFilename = archiveFilename;
+		temporaryFilename += ".tmp"s;
+
+		// Sort so the same content tree always produces the same archive
+		vector<path> files;
+		for (const auto& entry : recursive_directory_iterator(contentDirectory))
+		{
+			error_code error;
+			if (entry.is_regular_file() && equivalent(entry.path(), archiveFilename, error) == false && equivalent(entry.path(), temporaryFilename, error) == false)
+			{
+				files.push_back(entry.path());
+			}
+		}
+
+		sort(files.begin(), files.end());
+
+		ContentArchiveWriter writer(alignment);
+		uint64_t totalSize = 0;
+		for (const auto& file : files)
+		{
+			const wstring assetName = relative(file, contentDirectory).wstring();
+			cout << "Adding: "s << Utility::ToString(assetName) << endl;
+
+			vector<char> data;
+			Utility::LoadBinaryFile(file.wstring(), data);
+			writer.Add(assetName, span<const uint8_t>(reinterpret_cast<const uint8_t*>(data.data()), data.size()), compress);
+			totalSize += data.size();
+		}
+
+		// Write next to the destination and swap it in, so a failed run never leaves a truncated archive behind
+		{
+			ofstream archive(temporaryFilename, ios::binary | ios::trunc);
+			if (!archive.good())
+			{
+				throw exception("Could not open archive for writing.");
+			}
+
+			writer.Write(archive);
+		}
+
+		rename(temporaryFilename, archiveFilename);
+		cout << "Packed "s << files.size() << " files ("s << totalSize << " bytes) into "s << archiveFilename.string() << " ("s << file_size(archiveFilename) << " bytes)."s << endl;
+	}
+	catch (exception ex)
+	{
+		cout << ex.what() << endl;
+	}
+
+	return 0;
+}
\ No newline at end of file
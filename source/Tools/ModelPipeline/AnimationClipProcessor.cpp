@@ -12,7 +12,7 @@ using namespace Library;
 
 namespace ModelPipeline
 {
-	shared_ptr<AnimationClip> AnimationClipProcessor::LoadAnimationClip(Library::Model& model, aiAnimation& animation)
+	shared_ptr<AnimationClip> AnimationClipProcessor::LoadAnimationClip(Library::Model& model, aiAnimation& animation, bool reduceKeyframes)
 	{
 		AnimationClipData animationClipData(animation.mName.C_Str(), static_cast<float>(animation.mDuration), static_cast<float>(animation.mTicksPerSecond));
 
@@ -26,7 +26,7 @@ namespace ModelPipeline
 		animationClipData.BoneAnimations.reserve(animation.mNumChannels);
 		for (unsigned int i = 0; i < animation.mNumChannels; i++)
 		{
-			shared_ptr<BoneAnimation> boneAnimation = BoneAnimationProcessor::LoadBoneAnimation(model, *(animation.mChannels[i]));
+			shared_ptr<BoneAnimation> boneAnimation = BoneAnimationProcessor::LoadBoneAnimation(model, *(animation.mChannels[i]), reduceKeyframes);
 			animationClipData.BoneAnimations.push_back(boneAnimation);
 
 			assert(animationClipData.BoneAnimationsByBone.find(&(boneAnimation->GetBone())) == animationClipData.BoneAnimationsByBone.end());
@@ -35,9 +35,9 @@ namespace ModelPipeline
 
 		for (auto& boneAnimation : animationClipData.BoneAnimations)
 		{
-			if (boneAnimation->Keyframes().size() > animationClipData.KeyframeCount)
+			if (boneAnimation->Keyframes().Size() > animationClipData.KeyframeCount)
 			{
-				animationClipData.KeyframeCount = narrow_cast<uint32_t>(boneAnimation->Keyframes().size());
+				animationClipData.KeyframeCount = boneAnimation->Keyframes().Size();
 			}
 		}
 
@@ -17,6 +17,6 @@ namespace ModelPipeline
     public:
 		AnimationClipProcessor() = delete;
 
-		static std::shared_ptr<Library::AnimationClip> LoadAnimationClip(Library::Model& model, aiAnimation& animation);
+		static std::shared_ptr<Library::AnimationClip> LoadAnimationClip(Library::Model& model, aiAnimation& animation, bool reduceKeyframes = false);
     };
 }
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "pch.h"
+#include "BatchProcessor.h"
+#include "BuildCache.h"
+#include "ModelProcessor.h"
+#include "ThreadPool.h"
+#include <assimp/Importer.hpp>
+
+using namespace std;
+using namespace std::filesystem;
+using namespace std::string_literals;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	const uint32_t BatchProcessor::ProcessorVersion = 6;
+
+	namespace
+	{
+		mutex sConsoleMutex;
+
+		void WriteLine(const string& message)
+		{
+			lock_guard<mutex> lock(sConsoleMutex);
+			cout << message << endl;
+		}
+	}
+
+	uint32_t BatchProcessor::Run(const BatchOptions& options)
+	{
+		const vector<path> inputs = ExpandInputs(options.Inputs);
+		BuildCache buildCache(options.CacheFilename);
+
+		atomic<uint32_t> failureCount{ 0 };
+		atomic<uint32_t> skippedCount{ 0 };
+		{
+			ThreadPool threadPool(options.JobCount > 0 ? options.JobCount : max(thread::hardware_concurrency(), 1U));
+			for (const auto& input : inputs)
+			{
+				threadPool.Enqueue([&input, &options, &buildCache, &failureCount, &skippedCount]
+				{
+					try
+					{
+						if (ProcessFile(input, options, buildCache) == false)
+						{
+							++skippedCount;
+						}
+					}
+					catch (const exception& ex)
+					{
+						WriteLine("Failed: "s + input.string() + " ("s + ex.what() + ")"s);
+						++failureCount;
+					}
+				});
+			}
+
+			// The pool finishes every queued conversion before it is destroyed
+		}
+
+		buildCache.Save();
+		WriteLine("Finished: "s + to_string(inputs.size() - skippedCount - failureCount) + " converted, "s + to_string(skippedCount) + " up to date, "s + to_string(failureCount) + " failed."s);
+
+		return failureCount;
+	}
+
+	vector<path> BatchProcessor::ExpandInputs(const vector<string>& inputs)
+	{
+		Assimp::Importer importer;
+		vector<path> files;
+
+		for (const auto& input : inputs)
+		{
+			const path inputPath = u8path(input);
+			if (is_directory(inputPath))
+			{
+				// Directories contribute every file Assimp can import
+				for (const auto& entry : recursive_directory_iterator(inputPath))
+				{
+					if (entry.is_regular_file() && importer.IsExtensionSupported(entry.path().extension().string()))
+					{
+						files.push_back(absolute(entry.path()).lexically_normal());
+					}
+				}
+			}
+			else if (input.find_first_of("*?"s) != string::npos)
+			{
+				// Wildcards are matched against file names within a single directory
+				const path directory = (inputPath.has_parent_path() ? inputPath.parent_path() : current_path());
+				const wstring pattern = inputPath.filename().wstring();
+				for (const auto& entry : directory_iterator(directory))
+				{
+					if (entry.is_regular_file() && MatchesWildcard(pattern, entry.path().filename().wstring()))
+					{
+						files.push_back(absolute(entry.path()).lexically_normal());
+					}
+				}
+			}
+			else
+			{
+				files.push_back(absolute(inputPath).lexically_normal());
+			}
+		}
+
+		sort(files.begin(), files.end());
+		files.erase(unique(files.begin(), files.end()), files.end());
+
+		return files;
+	}
+
+	bool BatchProcessor::MatchesWildcard(const wstring& pattern, const wstring& name)
+	{
+		// Greedy matcher with single-star backtracking; case-insensitive like the file system
+		size_t patternIndex = 0;
+		size_t nameIndex = 0;
+		size_t starIndex = wstring::npos;
+		size_t starMatch = 0;
+
+		while (nameIndex < name.size())
+		{
+			if (patternIndex < pattern.size() && (pattern[patternIndex] == L'?' || towlower(pattern[patternIndex]) == towlower(name[nameIndex])))
+			{
+				++patternIndex;
+				++nameIndex;
+			}
+			else if (patternIndex < pattern.size() && pattern[patternIndex] == L'*')
+			{
+				starIndex = patternIndex++;
+				starMatch = nameIndex;
+			}
+			else if (starIndex != wstring::npos)
+			{
+				patternIndex = starIndex + 1;
+				nameIndex = ++starMatch;
+			}
+			else
+			{
+				return false;
+			}
+		}
+
+		while (patternIndex < pattern.size() && pattern[patternIndex] == L'*')
+		{
+			++patternIndex;
+		}
+
+		return patternIndex == pattern.size();
+	}
+
+	bool BatchProcessor::ProcessFile(const path& input, const BatchOptions& options, BuildCache& buildCache)
+	{
+		path output = input;
+		output += ".bin"s;
+
+		BuildCacheEntry cacheEntry;
+		cacheEntry.ContentHash = BuildCache::HashFile(input);
+		cacheEntry.ProcessorVersion = ProcessorVersion;
+		cacheEntry.Flags = (options.FlipUVs ? 1U : 0U) | (options.Quantize ? 2U : 0U);
+
+		if (options.Force == false && exists(output) && buildCache.IsUpToDate(input, cacheEntry))
+		{
+			return false;
+		}
+
+		WriteLine("Converting: "s + input.string());
+		Model model = ModelProcessor::LoadModel(input.string(), options.FlipUVs, options.Quantize);
+
+		// Readers never see a partially written model: write alongside and swap it in
+		path temporaryOutput = output;
+		temporaryOutput += ".tmp"s;
+		model.Save(temporaryOutput.string(), ModelFileVersion::Mapped, options.Quantize);
+		rename(temporaryOutput, output);
+
+		buildCache.Update(input, cacheEntry);
+
+		return true;
+	}
+}
\ No newline at end of file
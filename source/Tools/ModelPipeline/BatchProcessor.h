@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <filesystem>
+
+namespace ModelPipeline
+{
+	class BuildCache;
+
+	struct BatchOptions final
+	{
+		std::vector<std::string> Inputs;
+		std::filesystem::path CacheFilename{ "ModelPipeline.cache" };
+		std::uint32_t JobCount{ 0 };
+		bool FlipUVs{ true };
+		bool Force{ false };
+		// Quantized vertex streams and keyframes, with redundant keyframes dropped
+		bool Quantize{ false };
+	};
+
+	class BatchProcessor final
+	{
+	public:
+		BatchProcessor() = delete;
+
+		// Bump whenever a processor change alters the output, so every cached input is rebuilt
+		static const std::uint32_t ProcessorVersion;
+
+		// Returns the number of inputs that failed to convert
+		static std::uint32_t Run(const BatchOptions& options);
+
+	private:
+		static std::vector<std::filesystem::path> ExpandInputs(const std::vector<std::string>& inputs);
+		static bool MatchesWildcard(const std::wstring& pattern, const std::wstring& name);
+		static bool ProcessFile(const std::filesystem::path& input, const BatchOptions& options, BuildCache& buildCache);
+	};
+}
\ No newline at end of file
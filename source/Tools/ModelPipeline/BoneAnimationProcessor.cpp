@@ -11,7 +11,11 @@ using namespace Library;
 
 namespace ModelPipeline
 {
-	shared_ptr<BoneAnimation> BoneAnimationProcessor::LoadBoneAnimation(Model& model, aiNodeAnim& nodeAnim)
+	const float BoneAnimationProcessor::TranslationTolerance = 0.0005f;
+	const float BoneAnimationProcessor::RotationTolerance = 0.0005f;
+	const float BoneAnimationProcessor::ScaleTolerance = 0.0005f;
+
+	shared_ptr<BoneAnimation> BoneAnimationProcessor::LoadBoneAnimation(Model& model, aiNodeAnim& nodeAnim, bool reduceKeyframes)
 	{
 		assert(nodeAnim.mNumPositionKeys == nodeAnim.mNumRotationKeys);
 		assert(nodeAnim.mNumPositionKeys == nodeAnim.mNumScalingKeys);
@@ -19,6 +23,7 @@ namespace ModelPipeline
 		BoneAnimationData boneAnimationData;
 		boneAnimationData.BoneIndex = model.BoneIndexMapping().at(nodeAnim.mNodeName.C_Str());
 
+		boneAnimationData.Keyframes.Reserve(nodeAnim.mNumPositionKeys);
 		for (unsigned int i = 0; i < nodeAnim.mNumPositionKeys; i++)
 		{
 			aiVectorKey positionKey = nodeAnim.mPositionKeys[i];
@@ -28,9 +33,105 @@ namespace ModelPipeline
 			assert(positionKey.mTime == rotationKey.mTime);
 			assert(positionKey.mTime == scaleKey.mTime);
 
-			boneAnimationData.Keyframes.push_back(make_shared<Keyframe>(static_cast<float>(positionKey.mTime), XMFLOAT3(positionKey.mValue.x, positionKey.mValue.y, positionKey.mValue.z), XMFLOAT4(rotationKey.mValue.x, rotationKey.mValue.y, rotationKey.mValue.z, rotationKey.mValue.w), XMFLOAT3(scaleKey.mValue.x, scaleKey.mValue.y, scaleKey.mValue.z)));
+			boneAnimationData.Keyframes.PushBack(static_cast<float>(positionKey.mTime), XMFLOAT3(positionKey.mValue.x, positionKey.mValue.y, positionKey.mValue.z), XMFLOAT4(rotationKey.mValue.x, rotationKey.mValue.y, rotationKey.mValue.z, rotationKey.mValue.w), XMFLOAT3(scaleKey.mValue.x, scaleKey.mValue.y, scaleKey.mValue.z));
+		}
+
+		if (reduceKeyframes)
+		{
+			ReduceKeyframes(boneAnimationData.Keyframes);
 		}
 
 		return make_shared<BoneAnimation>(model, move(boneAnimationData));
 	}
+
+	void BoneAnimationProcessor::ReduceKeyframes(KeyframeTrack& keyframes)
+	{
+		const uint32_t keyframeCount = keyframes.Size();
+		if (keyframeCount < 2)
+		{
+			return;
+		}
+
+		// Sampling clamps to the only keyframe at any time, so a constant track needs no more
+		const XMVECTOR firstTranslation = XMLoadFloat3(&keyframes.Translations[0]);
+		const XMVECTOR firstRotationQuaternion = XMLoadFloat4(&keyframes.RotationQuaternions[0]);
+		const XMVECTOR firstScale = XMLoadFloat3(&keyframes.Scales[0]);
+		bool isConstant = true;
+		for (uint32_t i = 1; i < keyframeCount && isConstant; ++i)
+		{
+			isConstant = IsWithinTolerance(keyframes, i, firstTranslation, firstRotationQuaternion, firstScale);
+		}
+
+		KeyframeTrack reducedKeyframes;
+		const auto keep = [&keyframes, &reducedKeyframes](uint32_t index)
+		{
+			reducedKeyframes.PushBack(keyframes.Times[index], keyframes.Translations[index], keyframes.RotationQuaternions[index], keyframes.Scales[index]);
+		};
+
+		keep(0);
+		if (isConstant == false)
+		{
+			// Grow each span from the last kept keyframe until interpolating across it misses a skipped keyframe. Skipped keyframes
+			// are always compared with the source data, so the error doesn't accumulate from span to span.
+			uint32_t anchor = 0;
+			for (uint32_t candidate = 2; candidate < keyframeCount; ++candidate)
+			{
+				if (IsSpanRedundant(keyframes, anchor, candidate) == false)
+				{
+					anchor = candidate - 1;
+					keep(anchor);
+				}
+			}
+
+			keep(keyframeCount - 1);
+		}
+
+		keyframes = move(reducedKeyframes);
+	}
+
+	bool BoneAnimationProcessor::IsSpanRedundant(const KeyframeTrack& keyframes, uint32_t first, uint32_t last)
+	{
+		// Interpolates the way BoneAnimation::GetInteropolatedTransform does
+		const float timeOne = keyframes.Times[first];
+		const float duration = keyframes.Times[last] - timeOne;
+		const XMVECTOR translationOne = XMLoadFloat3(&keyframes.Translations[first]);
+		const XMVECTOR rotationQuaternionOne = XMLoadFloat4(&keyframes.RotationQuaternions[first]);
+		const XMVECTOR scaleOne = XMLoadFloat3(&keyframes.Scales[first]);
+		const XMVECTOR translationTwo = XMLoadFloat3(&keyframes.Translations[last]);
+		const XMVECTOR rotationQuaternionTwo = XMLoadFloat4(&keyframes.RotationQuaternions[last]);
+		const XMVECTOR scaleTwo = XMLoadFloat3(&keyframes.Scales[last]);
+
+		for (uint32_t i = first + 1; i < last; ++i)
+		{
+			const float lerpValue = (duration > 0.0f ? (keyframes.Times[i] - timeOne) / duration : 0.0f);
+			const XMVECTOR translation = XMVectorLerp(translationOne, translationTwo, lerpValue);
+			const XMVECTOR rotationQuaternion = XMQuaternionSlerp(rotationQuaternionOne, rotationQuaternionTwo, lerpValue);
+			const XMVECTOR scale = XMVectorLerp(scaleOne, scaleTwo, lerpValue);
+
+			if (IsWithinTolerance(keyframes, i, translation, rotationQuaternion, scale) == false)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool BoneAnimationProcessor::IsWithinTolerance(const KeyframeTrack& keyframes, uint32_t index, FXMVECTOR translation, FXMVECTOR rotationQuaternion, FXMVECTOR scale)
+	{
+		if (XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&keyframes.Translations[index]), translation))) > TranslationTolerance)
+		{
+			return false;
+		}
+
+		if (XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&keyframes.Scales[index]), scale))) > ScaleTolerance)
+		{
+			return false;
+		}
+
+		// Angle between the rotations; q and -q are the same rotation
+		const float cosHalfAngle = min(fabsf(XMVectorGetX(XMQuaternionDot(XMQuaternionNormalize(XMLoadFloat4(&keyframes.RotationQuaternions[index])), XMQuaternionNormalize(rotationQuaternion)))), 1.0f);
+
+		return 2.0f * acosf(cosHalfAngle) <= RotationTolerance;
+	}
 }
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
+#include <DirectXMath.h>
 
 struct aiNodeAnim;
 
@@ -8,6 +10,7 @@ namespace Library
 {
 	class BoneAnimation;
 	class Model;
+	struct KeyframeTrack;
 }
 
 namespace ModelPipeline
@@ -17,6 +20,17 @@ namespace ModelPipeline
     public:
 		BoneAnimationProcessor() = delete;
 
-		static std::shared_ptr<Library::BoneAnimation> LoadBoneAnimation(Library::Model& model, aiNodeAnim& nodeAnim);
+		static const float TranslationTolerance;
+		static const float RotationTolerance;
+		static const float ScaleTolerance;
+
+		static std::shared_ptr<Library::BoneAnimation> LoadBoneAnimation(Library::Model& model, aiNodeAnim& nodeAnim, bool reduceKeyframes = false);
+
+		// Drops keyframes that interpolating their kept neighbours reproduces within the tolerances; a constant track keeps one keyframe
+		static void ReduceKeyframes(Library::KeyframeTrack& keyframes);
+
+	private:
+		static bool IsSpanRedundant(const Library::KeyframeTrack& keyframes, std::uint32_t first, std::uint32_t last);
+		static bool IsWithinTolerance(const Library::KeyframeTrack& keyframes, std::uint32_t index, DirectX::FXMVECTOR translation, DirectX::FXMVECTOR rotationQuaternion, DirectX::FXMVECTOR scale);
     };
 }
\ No newline at end of file
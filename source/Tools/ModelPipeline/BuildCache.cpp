@@ -0,0 +1,97 @@
+#include "pch.h"
+#include "BuildCache.h"
+
+using namespace std;
+using namespace std::filesystem;
+
+namespace ModelPipeline
+{
+	bool BuildCacheEntry::operator==(const BuildCacheEntry& rhs) const
+	{
+		return ContentHash == rhs.ContentHash && ProcessorVersion == rhs.ProcessorVersion && Flags == rhs.Flags;
+	}
+
+	bool BuildCacheEntry::operator!=(const BuildCacheEntry& rhs) const
+	{
+		return !(*this == rhs);
+	}
+
+	BuildCache::BuildCache(const path& filename) :
+		mFilename(filename)
+	{
+		ifstream file(mFilename);
+		string line;
+		while (getline(file, line))
+		{
+			istringstream lineStream(line);
+			BuildCacheEntry entry;
+			string input;
+			lineStream >> hex >> entry.ContentHash >> entry.ProcessorVersion >> entry.Flags;
+			lineStream.ignore(1);
+			if (lineStream && getline(lineStream, input) && input.empty() == false)
+			{
+				mEntries[u8path(input).wstring()] = entry;
+			}
+		}
+	}
+
+	bool BuildCache::IsUpToDate(const path& input, const BuildCacheEntry& entry) const
+	{
+		lock_guard<mutex> lock(mMutex);
+		auto it = mEntries.find(input.wstring());
+
+		return (it != mEntries.end() && it->second == entry);
+	}
+
+	void BuildCache::Update(const path& input, const BuildCacheEntry& entry)
+	{
+		lock_guard<mutex> lock(mMutex);
+		mEntries[input.wstring()] = entry;
+	}
+
+	void BuildCache::Save() const
+	{
+		lock_guard<mutex> lock(mMutex);
+
+		path temporaryFilename = mFilename;
+		temporaryFilename += ".tmp";
+		{
+			ofstream file(temporaryFilename, ios::trunc);
+			if (!file.good())
+			{
+				throw exception("Could not write build cache.");
+			}
+
+			for (const auto& [input, entry] : mEntries)
+			{
+				file << hex << entry.ContentHash << ' ' << entry.ProcessorVersion << ' ' << entry.Flags << ' ' << path(input).u8string() << '\n';
+			}
+		}
+
+		rename(temporaryFilename, mFilename);
+	}
+
+	uint64_t BuildCache::HashFile(const path& filename)
+	{
+		ifstream file(filename, ios::binary);
+		if (!file.good())
+		{
+			throw exception("Could not open file.");
+		}
+
+		// FNV-1a
+		uint64_t hash = 14695981039346656037ULL;
+		vector<char> buffer(1 << 16);
+		while (file)
+		{
+			file.read(buffer.data(), static_cast<streamsize>(buffer.size()));
+			const auto count = static_cast<size_t>(file.gcount());
+			for (size_t i = 0; i < count; ++i)
+			{
+				hash = (hash ^ static_cast<uint8_t>(buffer[i])) * 1099511628211ULL;
+			}
+		}
+
+		return hash;
+	}
+}
\ No newline at end of file
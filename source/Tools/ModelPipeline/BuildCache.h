@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace ModelPipeline
+{
+	struct BuildCacheEntry final
+	{
+		std::uint64_t ContentHash;
+		std::uint32_t ProcessorVersion;
+		std::uint32_t Flags;
+
+		bool operator==(const BuildCacheEntry& rhs) const;
+		bool operator!=(const BuildCacheEntry& rhs) const;
+	};
+
+	// Records what each input was last converted from, so unchanged inputs can be skipped. Stored as one text line per input:
+	// content hash, processor version and flags (hexadecimal), then the UTF-8 input path. Safe to query and update from multiple threads.
+	class BuildCache final
+	{
+	public:
+		explicit BuildCache(const std::filesystem::path& filename);
+		BuildCache(const BuildCache&) = delete;
+		BuildCache& operator=(const BuildCache&) = delete;
+		BuildCache(BuildCache&&) = delete;
+		BuildCache& operator=(BuildCache&&) = delete;
+		~BuildCache() = default;
+
+		bool IsUpToDate(const std::filesystem::path& input, const BuildCacheEntry& entry) const;
+		void Update(const std::filesystem::path& input, const BuildCacheEntry& entry);
+		void Save() const;
+
+		static std::uint64_t HashFile(const std::filesystem::path& filename);
+
+	private:
+		std::filesystem::path mFilename;
+		std::map<std::wstring, BuildCacheEntry> mEntries;
+		mutable std::mutex mMutex;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,387 @@
+#include "pch.h"
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	const uint32_t MeshOptimizer::VertexCacheSize = 32;
+	const uint32_t MeshOptimizer::SimulatedCacheSize = 16;
+
+	namespace
+	{
+		const float CacheDecayPower = 1.5f;
+		const float LastTriangleScore = 0.75f;
+		const float ValenceBoostScale = 2.0f;
+		const float ValenceBoostPower = 0.5f;
+
+		float VertexScore(int32_t cachePosition, uint32_t remainingTriangles)
+		{
+			if (remainingTriangles == 0)
+			{
+				return -1.0f;
+			}
+
+			float score = 0.0f;
+			if (cachePosition >= 0)
+			{
+				if (cachePosition < 3)
+				{
+					// The most recent triangle's vertices are scored flat so its neighbors aren't favored by position alone
+					score = LastTriangleScore;
+				}
+				else
+				{
+					const float scaler = 1.0f / static_cast<float>(MeshOptimizer::VertexCacheSize - 3);
+					score = powf(1.0f - static_cast<float>(cachePosition - 3) * scaler, CacheDecayPower);
+				}
+			}
+
+			// Favor vertices with few triangles left so they get finished off rather than stranded
+			return score + ValenceBoostScale * powf(static_cast<float>(remainingTriangles), -ValenceBoostPower);
+		}
+
+		template <typename T>
+		void RemapStream(vector<T>& stream, const vector<uint32_t>& remap, uint32_t newVertexCount)
+		{
+			if (stream.empty())
+			{
+				return;
+			}
+
+			vector<T> remapped(newVertexCount, stream.front());
+			for (size_t oldIndex = 0; oldIndex < remap.size(); ++oldIndex)
+			{
+				if (remap[oldIndex] != UINT32_MAX)
+				{
+					remapped[remap[oldIndex]] = move(stream[oldIndex]);
+				}
+			}
+
+			stream = move(remapped);
+		}
+	}
+
+	void MeshOptimizer::Optimize(MeshData& meshData)
+	{
+		const uint32_t vertexCount = narrow_cast<uint32_t>(meshData.Vertices.size());
+		OptimizeVertexCache(meshData.Indices, vertexCount);
+		OptimizeOverdraw(meshData.Indices, meshData.Vertices, meshData.Normals);
+		OptimizeVertexFetch(meshData);
+	}
+
+	void MeshOptimizer::OptimizeVertexCache(vector<uint32_t>& indices, uint32_t vertexCount)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return;
+		}
+
+		// Vertex -> triangle adjacency; each vertex's active triangles are kept at the front of its range
+		vector<uint32_t> remainingTriangles(vertexCount, 0);
+		for (uint32_t index : indices)
+		{
+			++remainingTriangles[index];
+		}
+
+		vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			adjacencyOffsets[vertex + 1] = adjacencyOffsets[vertex] + remainingTriangles[vertex];
+		}
+
+		vector<uint32_t> adjacency(indices.size());
+		{
+			vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					adjacency[fill[indices[triangle * 3 + corner]]++] = narrow_cast<uint32_t>(triangle);
+				}
+			}
+		}
+
+		vector<int32_t> cachePositions(vertexCount, -1);
+		vector<float> vertexScores(vertexCount);
+		for (uint32_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			vertexScores[vertex] = VertexScore(-1, remainingTriangles[vertex]);
+		}
+
+		auto triangleScore = [&indices, &vertexScores](size_t triangle)
+		{
+			return vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+		};
+
+		size_t bestTriangle = 0;
+		for (size_t triangle = 1; triangle < triangleCount; ++triangle)
+		{
+			if (triangleScore(triangle) > triangleScore(bestTriangle))
+			{
+				bestTriangle = triangle;
+			}
+		}
+
+		vector<bool> emitted(triangleCount, false);
+		vector<uint32_t> optimizedIndices;
+		optimizedIndices.reserve(indices.size());
+		vector<uint32_t> cache;
+		vector<uint32_t> newCache;
+		cache.reserve(VertexCacheSize + 3);
+		newCache.reserve(VertexCacheSize + 3);
+
+		size_t scanCursor = 0;
+		for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+		{
+			if (bestTriangle == SIZE_MAX)
+			{
+				// Nothing in the cache has triangles left; continue from the next unemitted triangle in input order
+				while (emitted[scanCursor])
+				{
+					++scanCursor;
+				}
+
+				bestTriangle = scanCursor;
+			}
+
+			emitted[bestTriangle] = true;
+			const uint32_t* triangleIndices = &indices[bestTriangle * 3];
+			optimizedIndices.insert(optimizedIndices.end(), triangleIndices, triangleIndices + 3);
+
+			// Retire the triangle from its vertices' active lists
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t vertex = triangleIndices[corner];
+				uint32_t* first = &adjacency[adjacencyOffsets[vertex]];
+				uint32_t* last = first + remainingTriangles[vertex];
+				auto it = find(first, last, static_cast<uint32_t>(bestTriangle));
+				assert(it != last);
+				swap(*it, *(last - 1));
+				--remainingTriangles[vertex];
+			}
+
+			// The emitted vertices move to the front of the LRU cache
+			newCache.assign(triangleIndices, triangleIndices + 3);
+			for (uint32_t vertex : cache)
+			{
+				if (vertex != triangleIndices[0] && vertex != triangleIndices[1] && vertex != triangleIndices[2])
+				{
+					newCache.push_back(vertex);
+				}
+			}
+
+			for (size_t position = 0; position < newCache.size(); ++position)
+			{
+				const uint32_t vertex = newCache[position];
+				cachePositions[vertex] = (position < VertexCacheSize ? static_cast<int32_t>(position) : -1);
+				vertexScores[vertex] = VertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+			}
+
+			// Rescore the affected triangles and pick the best one still touching the cache
+			bestTriangle = SIZE_MAX;
+			float bestScore = -1.0f;
+			for (uint32_t vertex : newCache)
+			{
+				const uint32_t* first = &adjacency[adjacencyOffsets[vertex]];
+				for (uint32_t i = 0; i < remainingTriangles[vertex]; ++i)
+				{
+					const uint32_t triangle = first[i];
+					const float score = triangleScore(triangle);
+					if (score > bestScore)
+					{
+						bestScore = score;
+						bestTriangle = triangle;
+					}
+				}
+			}
+
+			if (newCache.size() > VertexCacheSize)
+			{
+				newCache.resize(VertexCacheSize);
+			}
+
+			swap(cache, newCache);
+		}
+
+		indices = move(optimizedIndices);
+	}
+
+	void MeshOptimizer::OptimizeOverdraw(vector<uint32_t>& indices, const vector<XMFLOAT3>& positions, const vector<XMFLOAT3>& normals)
+	{
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount < 2)
+		{
+			return;
+		}
+
+		// Split the cache-ordered list into clusters wherever the simulated cache restarts (a triangle with three misses).
+		// Reordering whole clusters then leaves the cache behavior within each cluster untouched.
+		vector<size_t> clusterStarts;
+		{
+			vector<uint32_t> fifo(SimulatedCacheSize, UINT32_MAX);
+			size_t fifoHead = 0;
+			for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+			{
+				uint32_t misses = 0;
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t vertex = indices[triangle * 3 + corner];
+					if (find(fifo.begin(), fifo.end(), vertex) == fifo.end())
+					{
+						fifo[fifoHead] = vertex;
+						fifoHead = (fifoHead + 1) % fifo.size();
+						++misses;
+					}
+				}
+
+				if (triangle == 0 || misses == 3)
+				{
+					clusterStarts.push_back(triangle);
+				}
+			}
+		}
+
+		if (clusterStarts.size() < 2)
+		{
+			return;
+		}
+
+		clusterStarts.push_back(triangleCount);
+
+		XMVECTOR meshCentroid = XMVectorZero();
+		for (const auto& position : positions)
+		{
+			meshCentroid = XMVectorAdd(meshCentroid, XMLoadFloat3(&position));
+		}
+		meshCentroid = XMVectorScale(meshCentroid, 1.0f / static_cast<float>(max<size_t>(positions.size(), 1)));
+
+		// Clusters facing away from the mesh center are drawn first, so they tend to occlude the rest
+		struct Cluster
+		{
+			size_t Start;
+			size_t End;
+			float SortKey;
+		};
+
+		vector<Cluster> clusters;
+		clusters.reserve(clusterStarts.size() - 1);
+		for (size_t i = 0; i + 1 < clusterStarts.size(); ++i)
+		{
+			XMVECTOR centroid = XMVectorZero();
+			XMVECTOR normal = XMVectorZero();
+			float totalArea = 0.0f;
+			for (size_t triangle = clusterStarts[i]; triangle < clusterStarts[i + 1]; ++triangle)
+			{
+				const uint32_t* triangleIndices = &indices[triangle * 3];
+				const XMVECTOR a = XMLoadFloat3(&positions[triangleIndices[0]]);
+				const XMVECTOR b = XMLoadFloat3(&positions[triangleIndices[1]]);
+				const XMVECTOR c = XMLoadFloat3(&positions[triangleIndices[2]]);
+				const XMVECTOR cross = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+				const float area = XMVectorGetX(XMVector3Length(cross)) * 0.5f;
+
+				centroid = XMVectorAdd(centroid, XMVectorScale(XMVectorAdd(XMVectorAdd(a, b), c), area / 3.0f));
+				totalArea += area;
+
+				// Prefer authored normals, which don't depend on the winding order the pipeline emits
+				if (normals.empty() == false)
+				{
+					const XMVECTOR vertexNormals = XMVectorAdd(XMVectorAdd(XMLoadFloat3(&normals[triangleIndices[0]]), XMLoadFloat3(&normals[triangleIndices[1]])), XMLoadFloat3(&normals[triangleIndices[2]]));
+					normal = XMVectorAdd(normal, XMVectorScale(XMVector3Normalize(vertexNormals), area));
+				}
+				else
+				{
+					normal = XMVectorAdd(normal, cross);
+				}
+			}
+
+			centroid = (totalArea > 0.0f ? XMVectorScale(centroid, 1.0f / totalArea) : meshCentroid);
+			const float sortKey = XMVectorGetX(XMVector3Dot(XMVectorSubtract(centroid, meshCentroid), XMVector3Normalize(normal)));
+			clusters.push_back({ clusterStarts[i], clusterStarts[i + 1], sortKey });
+		}
+
+		stable_sort(clusters.begin(), clusters.end(), [](const Cluster& lhs, const Cluster& rhs) { return lhs.SortKey > rhs.SortKey; });
+
+		vector<uint32_t> sortedIndices;
+		sortedIndices.reserve(indices.size());
+		for (const Cluster& cluster : clusters)
+		{
+			sortedIndices.insert(sortedIndices.end(), indices.begin() + cluster.Start * 3, indices.begin() + cluster.End * 3);
+		}
+
+		indices = move(sortedIndices);
+	}
+
+	void MeshOptimizer::OptimizeVertexFetch(MeshData& meshData)
+	{
+		// Number vertices in the order the index buffer first references them; unreferenced vertices are dropped
+		vector<uint32_t> remap(meshData.Vertices.size(), UINT32_MAX);
+		uint32_t newVertexCount = 0;
+		for (uint32_t& index : meshData.Indices)
+		{
+			if (remap[index] == UINT32_MAX)
+			{
+				remap[index] = newVertexCount++;
+			}
+
+			index = remap[index];
+		}
+
+		RemapStream(meshData.Vertices, remap, newVertexCount);
+		RemapStream(meshData.Normals, remap, newVertexCount);
+		RemapStream(meshData.Tangents, remap, newVertexCount);
+		RemapStream(meshData.BiNormals, remap, newVertexCount);
+		for (auto& textureCoordinates : meshData.TextureCoordinates)
+		{
+			RemapStream(textureCoordinates, remap, newVertexCount);
+		}
+
+		for (auto& vertexColors : meshData.VertexColors)
+		{
+			RemapStream(vertexColors, remap, newVertexCount);
+		}
+
+		RemapStream(meshData.BoneWeights, remap, newVertexCount);
+	}
+
+	VertexCacheStatistics MeshOptimizer::AnalyzeVertexCache(const vector<uint32_t>& indices, uint32_t vertexCount, uint32_t cacheSize)
+	{
+		VertexCacheStatistics statistics;
+		const size_t triangleCount = indices.size() / 3;
+		if (triangleCount == 0)
+		{
+			return statistics;
+		}
+
+		// FIFO cache, as on most GPUs
+		vector<uint32_t> timestamps(vertexCount, 0);
+		vector<bool> referenced(vertexCount, false);
+		uint32_t time = cacheSize + 1;
+		uint32_t misses = 0;
+		uint32_t referencedCount = 0;
+		for (uint32_t index : indices)
+		{
+			if (time - timestamps[index] > cacheSize)
+			{
+				timestamps[index] = time++;
+				++misses;
+			}
+
+			if (referenced[index] == false)
+			{
+				referenced[index] = true;
+				++referencedCount;
+			}
+		}
+
+		statistics.ACMR = static_cast<float>(misses) / static_cast<float>(triangleCount);
+		statistics.ATVR = static_cast<float>(misses) / static_cast<float>(referencedCount);
+
+		return statistics;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	struct MeshData;
+}
+
+namespace ModelPipeline
+{
+	struct VertexCacheStatistics final
+	{
+		float ACMR{ 0.0f };	// Post-transform cache misses per triangle (0.5 is ideal, 3.0 is no reuse)
+		float ATVR{ 0.0f };	// Cache misses per referenced vertex (1.0 is ideal)
+	};
+
+	// Triangle-list reordering for the GPU: post-transform cache reuse (Forsyth), overdraw-aware cluster ordering, then vertex
+	// reordering so vertex fetch walks memory in draw order.
+	class MeshOptimizer final
+	{
+	public:
+		MeshOptimizer() = delete;
+
+		static const std::uint32_t VertexCacheSize;
+		static const std::uint32_t SimulatedCacheSize;
+
+		static void Optimize(Library::MeshData& meshData);
+
+		static void OptimizeVertexCache(std::vector<std::uint32_t>& indices, std::uint32_t vertexCount);
+		static void OptimizeOverdraw(std::vector<std::uint32_t>& indices, const std::vector<DirectX::XMFLOAT3>& positions, const std::vector<DirectX::XMFLOAT3>& normals);
+		static void OptimizeVertexFetch(Library::MeshData& meshData);
+		static VertexCacheStatistics AnalyzeVertexCache(const std::vector<std::uint32_t>& indices, std::uint32_t vertexCount, std::uint32_t cacheSize = SimulatedCacheSize);
+	};
+}
\ No newline at end of file
@@ -2,10 +2,14 @@
 #include "MeshProcessor.h"
 #include "Model.h"
 #include "Mesh.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "MeshletBuilder.h"
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 
 using namespace std;
+using namespace std::string_literals;
 using namespace gsl;
 using namespace DirectX;
 using namespace Library;
@@ -135,6 +139,26 @@ namespace ModelPipeline
 			}
 		}
 
+		// Reorder triangle lists for the post-transform cache, overdraw and vertex fetch, then split it into meshlets and build LODs over the final vertex order
+		if (mesh.mPrimitiveTypes == aiPrimitiveType_TRIANGLE && meshData.Indices.empty() == false)
+		{
+			const VertexCacheStatistics before = MeshOptimizer::AnalyzeVertexCache(meshData.Indices, narrow_cast<uint32_t>(meshData.Vertices.size()));
+			MeshOptimizer::Optimize(meshData);
+			const VertexCacheStatistics after = MeshOptimizer::AnalyzeVertexCache(meshData.Indices, narrow_cast<uint32_t>(meshData.Vertices.size()));
+			MeshletBuilder::Build(meshData);
+			MeshSimplifier::GenerateLods(meshData);
+
+			// One insertion so batch conversions running in parallel don't interleave lines
+			ostringstream report;
+			report << fixed << setprecision(3) << "  Mesh '"s << mesh.mName.C_Str() << "': ACMR "s << before.ACMR << " -> "s << after.ACMR << ", ATVR "s << before.ATVR << " -> "s << after.ATVR << ", "s << meshData.Meshlets.size() << " meshlets"s << '\n';
+			for (size_t level = 0; level < meshData.Lods.size(); ++level)
+			{
+				const MeshLodData& lod = meshData.Lods[level];
+				report << "    LOD "s << level + 1 << ": "s << lod.FaceCount << " faces, error "s << setprecision(6) << lod.Error << '\n';
+			}
+			cout << report.str();
+		}
+
 		return make_shared<Library::Mesh>(model, move(meshData));
 	}
 }
\ No newline at end of file
@@ -0,0 +1,432 @@
+#include "pch.h"
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+#include <array>
+#include <numeric>
+#include <unordered_set>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	const uint32_t MeshSimplifier::DefaultLodCount = 3;
+	const float MeshSimplifier::LodReduction = 0.5f;
+	const uint32_t MeshSimplifier::MinimumLodFaceCount = 64;
+
+	namespace
+	{
+		const float BorderWeight = 10.0f;
+		const float MinimumFlipCosine = 0.25f;
+		const float MinimumLodReduction = 0.9f;
+
+		enum class VertexKind : uint8_t
+		{
+			Manifold,
+			Border,
+			Locked
+		};
+
+		struct Collapse final
+		{
+			uint32_t From;
+			uint32_t To;
+			double Error;
+		};
+
+		// Sum of squared distances to a set of weighted planes, normalized by the total weight so it reads as a squared distance
+		struct Quadric final
+		{
+			double A00{ 0.0 }, A01{ 0.0 }, A02{ 0.0 }, A11{ 0.0 }, A12{ 0.0 }, A22{ 0.0 };
+			double B0{ 0.0 }, B1{ 0.0 }, B2{ 0.0 };
+			double C{ 0.0 };
+			double Weight{ 0.0 };
+
+			void AddPlane(const XMFLOAT3& normal, float distance, float weight)
+			{
+				const double x = normal.x, y = normal.y, z = normal.z, d = distance, w = weight;
+				A00 += w * x * x; A01 += w * x * y; A02 += w * x * z;
+				A11 += w * y * y; A12 += w * y * z; A22 += w * z * z;
+				B0 += w * x * d; B1 += w * y * d; B2 += w * z * d;
+				C += w * d * d;
+				Weight += w;
+			}
+
+			void Add(const Quadric& other)
+			{
+				A00 += other.A00; A01 += other.A01; A02 += other.A02;
+				A11 += other.A11; A12 += other.A12; A22 += other.A22;
+				B0 += other.B0; B1 += other.B1; B2 += other.B2;
+				C += other.C;
+				Weight += other.Weight;
+			}
+
+			double Error(const XMFLOAT3& position) const
+			{
+				if (Weight <= 0.0)
+				{
+					return 0.0;
+				}
+
+				const double x = position.x, y = position.y, z = position.z;
+				const double error = A00 * x * x + A11 * y * y + A22 * z * z + 2.0 * (A01 * x * y + A02 * x * z + A12 * y * z) + 2.0 * (B0 * x + B1 * y + B2 * z) + C;
+				return fabs(error) / Weight;
+			}
+		};
+
+		uint64_t EdgeKey(uint32_t from, uint32_t to)
+		{
+			return (static_cast<uint64_t>(from) << 32) | to;
+		}
+
+		// Maps every vertex to the first vertex sharing its exact position; several referenced vertices per position form a seam
+		vector<uint32_t> BuildPositionRemap(const vector<XMFLOAT3>& positions)
+		{
+			const auto less = [&positions](uint32_t lhs, uint32_t rhs)
+			{
+				const XMFLOAT3& a = positions[lhs];
+				const XMFLOAT3& b = positions[rhs];
+				return tie(a.x, a.y, a.z) < tie(b.x, b.y, b.z);
+			};
+
+			vector<uint32_t> order(positions.size());
+			iota(order.begin(), order.end(), 0U);
+			sort(order.begin(), order.end(), less);
+
+			vector<uint32_t> remap(positions.size());
+			for (size_t i = 0; i < order.size(); ++i)
+			{
+				remap[order[i]] = (i > 0 && less(order[i - 1], order[i]) == false ? remap[order[i - 1]] : order[i]);
+			}
+
+			return remap;
+		}
+
+		XMVECTOR TriangleNormal(const XMFLOAT3& a, const XMFLOAT3& b, const XMFLOAT3& c)
+		{
+			const XMVECTOR origin = XMLoadFloat3(&a);
+			return XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&b), origin), XMVectorSubtract(XMLoadFloat3(&c), origin));
+		}
+	}
+
+	void MeshSimplifier::GenerateLods(MeshData& meshData, uint32_t lodCount)
+	{
+		meshData.Lods.clear();
+
+		const uint32_t vertexCount = narrow_cast<uint32_t>(meshData.Vertices.size());
+		size_t previousIndexCount = meshData.Indices.size();
+		float previousError = 0.0f;
+		for (uint32_t level = 0; level < lodCount; ++level)
+		{
+			const size_t targetIndexCount = static_cast<size_t>(static_cast<float>(previousIndexCount / 3) * LodReduction) * 3;
+			if (targetIndexCount / 3 < MinimumLodFaceCount)
+			{
+				break;
+			}
+
+			// Each level is simplified from the full-detail mesh so its error is measured against the original surface
+			float error;
+			vector<uint32_t> indices = Simplify(meshData.Indices, meshData.Vertices, targetIndexCount, error);
+			if (static_cast<float>(indices.size()) > static_cast<float>(previousIndexCount) * MinimumLodReduction)
+			{
+				break;
+			}
+
+			MeshOptimizer::OptimizeVertexCache(indices, vertexCount);
+
+			MeshLodData lod;
+			lod.Error = max(error, previousError);
+			lod.FaceCount = narrow_cast<uint32_t>(indices.size() / 3);
+			lod.Indices = move(indices);
+
+			previousIndexCount = lod.Indices.size();
+			previousError = lod.Error;
+			meshData.Lods.push_back(move(lod));
+		}
+	}
+
+	vector<uint32_t> MeshSimplifier::Simplify(const vector<uint32_t>& indices, const vector<XMFLOAT3>& positions, size_t targetIndexCount, float& error)
+	{
+		error = 0.0f;
+
+		const size_t vertexCount = positions.size();
+		const vector<uint32_t> positionRemap = BuildPositionRemap(positions);
+
+		// Directed edges between positions; an edge without its reverse is on an open border
+		unordered_set<uint64_t> edges;
+		edges.reserve(indices.size());
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				edges.insert(EdgeKey(positionRemap[indices[i + corner]], positionRemap[indices[i + (corner + 1) % 3]]));
+			}
+		}
+
+		const auto isOpenEdge = [&edges](uint32_t from, uint32_t to)
+		{
+			return edges.count(EdgeKey(to, from)) == 0;
+		};
+
+		// Classify vertices, accumulating per-position counts of distinct vertices (wedges) and open edges
+		vector<uint32_t> wedgeCount(vertexCount, 0);
+		vector<uint32_t> openOutCount(vertexCount, 0);
+		vector<uint32_t> openInCount(vertexCount, 0);
+		vector<uint8_t> referenced(vertexCount, 0);
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t vertex = indices[i + corner];
+				if (referenced[vertex] == 0)
+				{
+					referenced[vertex] = 1;
+					++wedgeCount[positionRemap[vertex]];
+				}
+
+				const uint32_t from = positionRemap[vertex];
+				const uint32_t to = positionRemap[indices[i + (corner + 1) % 3]];
+				if (isOpenEdge(from, to))
+				{
+					++openOutCount[from];
+					++openInCount[to];
+				}
+			}
+		}
+
+		vector<VertexKind> kinds(vertexCount, VertexKind::Locked);
+		for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+		{
+			const uint32_t position = positionRemap[vertex];
+			if (wedgeCount[position] > 1)
+			{
+				continue;
+			}
+
+			if (openOutCount[position] == 0 && openInCount[position] == 0)
+			{
+				kinds[vertex] = VertexKind::Manifold;
+			}
+			else if (openOutCount[position] == 1 && openInCount[position] == 1)
+			{
+				kinds[vertex] = VertexKind::Border;
+			}
+		}
+
+		// Area-weighted face planes, plus planes perpendicular to open edges so borders keep their outline
+		vector<Quadric> quadrics(vertexCount);
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			const XMFLOAT3& a = positions[indices[i]];
+			const XMFLOAT3& b = positions[indices[i + 1]];
+			const XMFLOAT3& c = positions[indices[i + 2]];
+			const XMVECTOR cross = TriangleNormal(a, b, c);
+			const float length = XMVectorGetX(XMVector3Length(cross));
+			if (length <= 0.0f)
+			{
+				continue;
+			}
+
+			const XMVECTOR normal = XMVectorScale(cross, 1.0f / length);
+			XMFLOAT3 faceNormal;
+			XMStoreFloat3(&faceNormal, normal);
+			const float distance = -XMVectorGetX(XMVector3Dot(normal, XMLoadFloat3(&a)));
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				quadrics[positionRemap[indices[i + corner]]].AddPlane(faceNormal, distance, length * 0.5f);
+			}
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				const uint32_t from = positionRemap[indices[i + corner]];
+				const uint32_t to = positionRemap[indices[i + (corner + 1) % 3]];
+				if (isOpenEdge(from, to) == false)
+				{
+					continue;
+				}
+
+				const XMVECTOR start = XMLoadFloat3(&positions[from]);
+				const XMVECTOR edge = XMVectorSubtract(XMLoadFloat3(&positions[to]), start);
+				const float edgeLengthSquared = XMVectorGetX(XMVector3Dot(edge, edge));
+				if (edgeLengthSquared <= 0.0f)
+				{
+					continue;
+				}
+
+				const XMVECTOR edgeNormal = XMVector3Normalize(XMVector3Cross(edge, normal));
+
+				XMFLOAT3 borderNormal;
+				XMStoreFloat3(&borderNormal, edgeNormal);
+				const float borderDistance = -XMVectorGetX(XMVector3Dot(edgeNormal, start));
+				quadrics[from].AddPlane(borderNormal, borderDistance, edgeLengthSquared * BorderWeight);
+				quadrics[to].AddPlane(borderNormal, borderDistance, edgeLengthSquared * BorderWeight);
+			}
+		}
+
+		const auto canCollapse = [&](uint32_t from, uint32_t to)
+		{
+			switch (kinds[from])
+			{
+			case VertexKind::Manifold:
+				return true;
+
+			case VertexKind::Border:
+				return isOpenEdge(positionRemap[from], positionRemap[to]) || isOpenEdge(positionRemap[to], positionRemap[from]);
+
+			default:
+				return false;
+			}
+		};
+
+		vector<uint32_t> result(indices.begin(), indices.end() - static_cast<ptrdiff_t>(indices.size() % 3));
+		vector<uint32_t> triangleOffsets(vertexCount + 1);
+		vector<uint32_t> vertexTriangles;
+		vector<Collapse> collapses;
+		vector<uint8_t> locked(vertexCount);
+		double maxError = 0.0;
+
+		while (result.size() > targetIndexCount)
+		{
+			const size_t triangleCount = result.size() / 3;
+
+			// Vertex to triangle adjacency for the current triangle list
+			fill(triangleOffsets.begin(), triangleOffsets.end(), 0U);
+			for (uint32_t vertex : result)
+			{
+				++triangleOffsets[vertex + 1];
+			}
+
+			partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+			vertexTriangles.resize(result.size());
+			{
+				vector<uint32_t> cursors(triangleOffsets.begin(), triangleOffsets.end() - 1);
+				for (size_t i = 0; i < result.size(); ++i)
+				{
+					vertexTriangles[cursors[result[i]]++] = narrow_cast<uint32_t>(i / 3);
+				}
+			}
+
+			// Each edge is a candidate in both directions; a collapse moves From onto To's existing position
+			collapses.clear();
+			for (size_t i = 0; i < result.size(); i += 3)
+			{
+				for (size_t corner = 0; corner < 3; ++corner)
+				{
+					const uint32_t a = result[i + corner];
+					const uint32_t b = result[i + (corner + 1) % 3];
+					for (const auto& [from, to] : { make_pair(a, b), make_pair(b, a) })
+					{
+						if (canCollapse(from, to))
+						{
+							Quadric quadric = quadrics[positionRemap[from]];
+							quadric.Add(quadrics[positionRemap[to]]);
+							collapses.push_back({ from, to, quadric.Error(positions[to]) });
+						}
+					}
+				}
+			}
+
+			sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs)
+			{
+				return tie(lhs.Error, lhs.From, lhs.To) < tie(rhs.Error, rhs.From, rhs.To);
+			});
+
+			// Collapses in one pass can't share neighborhoods, so the flip test below always sees current geometry
+			fill(locked.begin(), locked.end(), uint8_t(0));
+			const size_t removableTriangles = (result.size() - targetIndexCount + 2) / 3;
+			size_t removedTriangles = 0;
+			for (const Collapse& collapse : collapses)
+			{
+				if (removedTriangles >= removableTriangles)
+				{
+					break;
+				}
+
+				if (locked[collapse.From] || locked[collapse.To])
+				{
+					continue;
+				}
+
+				const uint32_t* begin = vertexTriangles.data() + triangleOffsets[collapse.From];
+				const uint32_t* end = vertexTriangles.data() + triangleOffsets[collapse.From + 1];
+
+				bool flips = false;
+				for (const uint32_t* triangle = begin; triangle != end && flips == false; ++triangle)
+				{
+					const uint32_t* corners = result.data() + *triangle * 3;
+					if (corners[0] == collapse.To || corners[1] == collapse.To || corners[2] == collapse.To)
+					{
+						continue;
+					}
+
+					array<XMFLOAT3, 3> moved{ positions[corners[0]], positions[corners[1]], positions[corners[2]] };
+					for (size_t corner = 0; corner < 3; ++corner)
+					{
+						if (corners[corner] == collapse.From)
+						{
+							moved[corner] = positions[collapse.To];
+						}
+					}
+
+					const XMVECTOR before = TriangleNormal(positions[corners[0]], positions[corners[1]], positions[corners[2]]);
+					const XMVECTOR after = TriangleNormal(moved[0], moved[1], moved[2]);
+					const float lengths = XMVectorGetX(XMVector3Length(before)) * XMVectorGetX(XMVector3Length(after));
+					flips = (XMVectorGetX(XMVector3Dot(before, after)) <= MinimumFlipCosine * lengths);
+				}
+
+				if (flips)
+				{
+					continue;
+				}
+
+				for (const uint32_t* triangle = begin; triangle != end; ++triangle)
+				{
+					uint32_t* corners = result.data() + *triangle * 3;
+					for (size_t corner = 0; corner < 3; ++corner)
+					{
+						locked[corners[corner]] = 1;
+						if (corners[corner] == collapse.From)
+						{
+							corners[corner] = collapse.To;
+						}
+					}
+
+					if (corners[0] == corners[1] || corners[1] == corners[2] || corners[2] == corners[0])
+					{
+						++removedTriangles;
+					}
+				}
+
+				locked[collapse.To] = 1;
+				quadrics[positionRemap[collapse.To]].Add(quadrics[positionRemap[collapse.From]]);
+				maxError = max(maxError, collapse.Error);
+			}
+
+			if (removedTriangles == 0)
+			{
+				break;
+			}
+
+			size_t write = 0;
+			for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+			{
+				const uint32_t* corners = result.data() + triangle * 3;
+				if (corners[0] != corners[1] && corners[1] != corners[2] && corners[2] != corners[0])
+				{
+					result[write++] = corners[0];
+					result[write++] = corners[1];
+					result[write++] = corners[2];
+				}
+			}
+
+			result.resize(write);
+		}
+
+		error = static_cast<float>(sqrt(maxError));
+
+		return result;
+	}
+}
\ No newline at end of file
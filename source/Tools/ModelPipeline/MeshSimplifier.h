@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	struct MeshData;
+}
+
+namespace ModelPipeline
+{
+	// Quadric error metric simplification by edge collapse onto existing vertices, so every LOD indexes the full-detail vertex
+	// streams. Vertices on UV/normal seams (one position, several vertices) never move, and open borders only slide along themselves.
+	class MeshSimplifier final
+	{
+	public:
+		MeshSimplifier() = delete;
+
+		static const std::uint32_t DefaultLodCount;
+		static const float LodReduction;
+		static const std::uint32_t MinimumLodFaceCount;
+
+		// Appends up to lodCount levels to meshData.Lods, each with LodReduction of the previous level's triangles. Stops early once
+		// a level would fall under MinimumLodFaceCount or the seams and borders leave nothing more to collapse.
+		static void GenerateLods(Library::MeshData& meshData, std::uint32_t lodCount = DefaultLodCount);
+
+		// Returns the simplified triangle list; error receives the object-space deviation from the source surface
+		static std::vector<std::uint32_t> Simplify(const std::vector<std::uint32_t>& indices, const std::vector<DirectX::XMFLOAT3>& positions, std::size_t targetIndexCount, float& error);
+	};
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "pch.h"
+#include "MeshletBuilder.h"
+#include "Mesh.h"
+#include <array>
+
+using namespace std;
+using namespace gsl;
+using namespace DirectX;
+using namespace Library;
+
+namespace ModelPipeline
+{
+	namespace
+	{
+		// Cones wider than this (about 84 degrees from the axis) can't be backfacing from anywhere worth testing
+		const float MinimumConeSpread = 0.1f;
+	}
+
+	void MeshletBuilder::Build(MeshData& meshData)
+	{
+		meshData.Meshlets.clear();
+
+		const vector<uint32_t>& indices = meshData.Indices;
+		const vector<XMFLOAT3>& positions = meshData.Vertices;
+		if (indices.size() < 3)
+		{
+			return;
+		}
+
+		// The pipeline flips the winding order, so front faces are clockwise in the right-handed object space and the geometric
+		// normal points inward. Authored normals, when there are any, settle the sign instead.
+		float windingSign = -1.0f;
+		if (meshData.Normals.size() == positions.size())
+		{
+			float agreement = 0.0f;
+			for (size_t i = 0; i + 2 < indices.size(); i += 3)
+			{
+				const XMVECTOR a = XMLoadFloat3(&positions[indices[i]]);
+				const XMVECTOR faceNormal = XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&positions[indices[i + 1]]), a), XMVectorSubtract(XMLoadFloat3(&positions[indices[i + 2]]), a));
+				const XMVECTOR vertexNormals = XMVectorAdd(XMLoadFloat3(&meshData.Normals[indices[i]]), XMVectorAdd(XMLoadFloat3(&meshData.Normals[indices[i + 1]]), XMLoadFloat3(&meshData.Normals[indices[i + 2]])));
+				agreement += XMVectorGetX(XMVector3Dot(faceNormal, vertexNormals));
+			}
+
+			windingSign = (agreement >= 0.0f ? 1.0f : -1.0f);
+		}
+
+		// Stamp vertices with the meshlet that last used them so unique vertices are counted without a set
+		vector<uint32_t> vertexMeshlets(positions.size(), UINT32_MAX);
+		uint32_t meshletIndex = 0;
+		Meshlet meshlet{ };
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			uint32_t newVertexCount = 0;
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				newVertexCount += (vertexMeshlets[indices[i + corner]] != meshletIndex ? 1 : 0);
+			}
+
+			if (meshlet.TriangleCount == Meshlet::MaxTriangles || meshlet.VertexCount + newVertexCount > Meshlet::MaxVertices)
+			{
+				ComputeBounds(meshlet, indices, positions, windingSign);
+				meshData.Meshlets.push_back(meshlet);
+
+				++meshletIndex;
+				meshlet = Meshlet{ };
+				meshlet.StartIndex = narrow_cast<uint32_t>(i);
+			}
+
+			for (size_t corner = 0; corner < 3; ++corner)
+			{
+				uint32_t& vertexMeshlet = vertexMeshlets[indices[i + corner]];
+				if (vertexMeshlet != meshletIndex)
+				{
+					vertexMeshlet = meshletIndex;
+					++meshlet.VertexCount;
+				}
+			}
+
+			++meshlet.TriangleCount;
+		}
+
+		ComputeBounds(meshlet, indices, positions, windingSign);
+		meshData.Meshlets.push_back(meshlet);
+	}
+
+	void MeshletBuilder::ComputeBounds(Meshlet& meshlet, const vector<uint32_t>& indices, const vector<XMFLOAT3>& positions, float windingSign)
+	{
+		const uint32_t* triangles = indices.data() + meshlet.StartIndex;
+		const size_t indexCount = static_cast<size_t>(meshlet.TriangleCount) * 3;
+
+		// Sphere centered on the bounding box, which is cheap and close enough for clusters this small
+		XMVECTOR minimum = XMVectorReplicate(numeric_limits<float>::max());
+		XMVECTOR maximum = XMVectorReplicate(-numeric_limits<float>::max());
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			const XMVECTOR position = XMLoadFloat3(&positions[triangles[i]]);
+			minimum = XMVectorMin(minimum, position);
+			maximum = XMVectorMax(maximum, position);
+		}
+
+		const XMVECTOR center = XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f);
+		float radius = 0.0f;
+		for (size_t i = 0; i < indexCount; ++i)
+		{
+			radius = max(radius, XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&positions[triangles[i]]), center))));
+		}
+
+		XMStoreFloat3(&meshlet.Center, center);
+		meshlet.Radius = radius;
+
+		// Normal cone: the average face normal, widened to the face normal furthest from it
+		array<XMFLOAT3, Meshlet::MaxTriangles> faceNormals;
+		size_t faceNormalCount = 0;
+		XMVECTOR axis = XMVectorZero();
+		for (size_t i = 0; i < indexCount; i += 3)
+		{
+			const XMVECTOR a = XMLoadFloat3(&positions[triangles[i]]);
+			const XMVECTOR normal = XMVectorScale(XMVector3Cross(XMVectorSubtract(XMLoadFloat3(&positions[triangles[i + 1]]), a), XMVectorSubtract(XMLoadFloat3(&positions[triangles[i + 2]]), a)), windingSign);
+			const float length = XMVectorGetX(XMVector3Length(normal));
+			if (length > 0.0f)
+			{
+				const XMVECTOR unitNormal = XMVectorScale(normal, 1.0f / length);
+				XMStoreFloat3(&faceNormals[faceNormalCount++], unitNormal);
+				axis = XMVectorAdd(axis, unitNormal);
+			}
+		}
+
+		meshlet.ConeAxis = XMFLOAT3(0.0f, 0.0f, 0.0f);
+		meshlet.ConeCutoff = 1.0f;
+
+		const float axisLength = XMVectorGetX(XMVector3Length(axis));
+		if (axisLength <= 0.0f)
+		{
+			return;
+		}
+
+		axis = XMVectorScale(axis, 1.0f / axisLength);
+		float minimumDot = 1.0f;
+		for (size_t i = 0; i < faceNormalCount; ++i)
+		{
+			minimumDot = min(minimumDot, XMVectorGetX(XMVector3Dot(axis, XMLoadFloat3(&faceNormals[i]))));
+		}
+
+		if (minimumDot > MinimumConeSpread)
+		{
+			// The backfacing region is the normal cone rotated by 90 degrees and inverted, so the test compares against sin rather than cos
+			XMStoreFloat3(&meshlet.ConeAxis, axis);
+			meshlet.ConeCutoff = sqrtf(1.0f - minimumDot * minimumDot);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <DirectXMath.h>
+
+namespace Library
+{
+	struct MeshData;
+	struct Meshlet;
+}
+
+namespace ModelPipeline
+{
+	// Splits the full-detail triangle list into Library::Meshlet runs without reordering it, so the vertex cache and overdraw
+	// ordering from MeshOptimizer carries over. Each run gets a bounding sphere and a normal cone for culling.
+	class MeshletBuilder final
+	{
+	public:
+		MeshletBuilder() = delete;
+
+		static void Build(Library::MeshData& meshData);
+
+	private:
+		static void ComputeBounds(Library::Meshlet& meshlet, const std::vector<std::uint32_t>& indices, const std::vector<DirectX::XMFLOAT3>& positions, float windingSign);
+	};
+}
\ No newline at end of file
@@ -15,7 +15,7 @@ using namespace DirectX;
 
 namespace ModelPipeline
 {
-	Library::Model ModelProcessor::LoadModel(const std::string& filename, bool flipUVs)
+	Library::Model ModelProcessor::LoadModel(const std::string& filename, bool flipUVs, bool reduceKeyframes)
 	{
 		Library::Model model;
 		ModelData& modelData = model.Data();
@@ -59,7 +59,7 @@ namespace ModelPipeline
 			modelData.Animations.reserve(scene->mNumAnimations);
 			for (unsigned int i = 0; i < scene->mNumAnimations; i++)
 			{
-				shared_ptr<AnimationClip> animation = AnimationClipProcessor::LoadAnimationClip(model, *(scene->mAnimations[i]));
+				shared_ptr<AnimationClip> animation = AnimationClipProcessor::LoadAnimationClip(model, *(scene->mAnimations[i]), reduceKeyframes);
 				modelData.Animations.push_back(animation);
 				modelData.AnimationsByName.insert(std::pair<std::string, shared_ptr<AnimationClip>>(animation->Name(), animation));
 			}
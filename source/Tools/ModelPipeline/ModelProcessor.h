@@ -18,7 +18,8 @@ namespace ModelPipeline
     public:
 		ModelProcessor() = delete;
 
-		static Library::Model LoadModel(const std::string& filename, bool flipUVs = false);
+		// reduceKeyframes drops redundant keyframes (see BoneAnimationProcessor::ReduceKeyframes)
+		static Library::Model LoadModel(const std::string& filename, bool flipUVs = false, bool reduceKeyframes = false);
 
 	private:
 		static std::shared_ptr<Library::SceneNode> BuildSkeleton(Library::ModelData& modelData, aiNode& node, const std::shared_ptr<Library::SceneNode>& parentSceneNode);
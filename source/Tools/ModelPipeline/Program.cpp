@@ -1,5 +1,6 @@
 #include "pch.h"
 #include "ModelProcessor.h"
+#include "BatchProcessor.h"
 #include "Utility.h"
 #include "UtilityWin32.h"
 
@@ -19,10 +20,42 @@ int main(int argc, char* argv[])
 	{
 		if (argc < 2)
 		{
-			throw exception("Usage: ModelPipeline.exe inputfilename");
+			throw exception("Usage: ModelPipeline.exe inputfilename [/quantize]\n       ModelPipeline.exe /batch [/jobs:count] [/cache:filename] [/force] [/quantize] directory|wildcard|filename...");
+		}
+
+		if (argv[1] == "/batch"s)
+		{
+			BatchOptions options;
+			for (int i = 2; i < argc; ++i)
+			{
+				const string argument = argv[i];
+				if (argument == "/force"s)
+				{
+					options.Force = true;
+				}
+				else if (argument == "/quantize"s)
+				{
+					options.Quantize = true;
+				}
+				else if (argument.compare(0, 6, "/jobs:"s) == 0)
+				{
+					options.JobCount = static_cast<uint32_t>(stoul(argument.substr(6)));
+				}
+				else if (argument.compare(0, 7, "/cache:"s) == 0)
+				{
+					options.CacheFilename = u8path(argument.substr(7));
+				}
+				else
+				{
+					options.Inputs.push_back(argument);
+				}
+			}
+
+			return (BatchProcessor::Run(options) == 0 ? 0 : 1);
 		}
 
 		string inputFile = argv[1];
+		const bool quantize = (argc > 2 && argv[2] == "/quantize"s);
 		auto [inputFilename, inputDirectory] = Library::Utility::GetFileNameAndDirectory(inputFile);
 		if (inputDirectory.empty())
 		{
@@ -32,11 +65,11 @@ int main(int argc, char* argv[])
 		current_path(inputDirectory);
 
 		cout << "Reading: "s << inputFilename << endl;
-		Model model = ModelProcessor::LoadModel(inputFilename, true);
+		Model model = ModelProcessor::LoadModel(inputFilename, true, quantize);
 		
 		string outputFilename = inputFilename + ".bin"s;
 		cout << "Writing: "s << outputFilename << endl;
-		model.Save(outputFilename);
+		model.Save(outputFilename, ModelFileVersion::Mapped, quantize);
 		cout << "Finished."s << endl;
 
 	}